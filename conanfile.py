@@ -52,6 +52,7 @@ class HomeObjectConan(ConanFile):
         self.requires("sisl/[^13.2.3]@oss/master", transitive_headers=True)
         self.requires("homestore/[^7.5.2]@oss/master")
         self.requires("iomgr/[^12.0]@oss/master")
+        self.requires("xxhash/0.8.2")
 
     def validate(self):
         if self.info.settings.compiler.cppstd:
@@ -121,7 +122,8 @@ class HomeObjectConan(ConanFile):
              keep_path=True)
 
     def package_info(self):
-        self.cpp_info.components["homestore"].requires = ["homestore::homestore", "iomgr::iomgr", "sisl::sisl"]
+        self.cpp_info.components["homestore"].requires = ["homestore::homestore", "iomgr::iomgr", "sisl::sisl",
+                                                          "xxhash::xxhash"]
         self.cpp_info.components["memory"].requires = ["sisl::sisl"]
         self.cpp_info.components["homeobject"].requires = ["homestore"]
 
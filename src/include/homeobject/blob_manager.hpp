@@ -2,6 +2,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include <sisl/fds/buffer.hpp>
 
@@ -33,17 +34,33 @@ struct Blob {
 
     Blob clone() const;
 
+    // Size of the payload, taken from body_sgs when the payload is given as fragments.
+    uint64_t payload_size() const { return body_sgs.iovs.empty() ? body.size() : body_sgs.size; }
+    // Copies the fragments of body_sgs into body, for the paths which need the payload in one buffer.
+    void gather_body();
+
     sisl::io_blob_safe body;
     std::string user_key{};
     uint64_t object_off{};
     std::optional< peer_id_t > current_leader{std::nullopt};
+    // Payload of a put given as fragments instead of body. The fragments are not owned by the blob and must stay valid
+    // until the put completes. Fragments need no alignment, only their unaligned parts are copied before the write.
+    sisl::sg_list body_sgs{};
 };
 
 class BlobManager : public Manager< BlobError > {
 public:
     virtual AsyncResult< blob_id_t > put(shard_id_t shard, Blob&&, trace_id_t tid = 0) = 0;
+    // Puts all the blobs into the shard as one replicated write. Either all of them are put or none, the returned blob
+    // ids are in the order of the given blobs. A backend may reject a batch larger than it can write at once.
+    virtual AsyncResult< std::vector< blob_id_t > > put_batch(shard_id_t shard, std::vector< Blob >&& blobs,
+                                                              trace_id_t tid = 0) = 0;
     virtual AsyncResult< Blob > get(shard_id_t shard, blob_id_t const& blob, uint64_t off = 0, uint64_t len = 0,
                                     bool allow_skip_verify = false, trace_id_t tid = 0) const = 0;
+    // Gets the whole blobs from the shard, the results are in the order of the given blob ids. A blob which can not be
+    // read fails on its own without failing the others.
+    virtual AsyncResult< std::vector< Result< Blob > > >
+    get_batch(shard_id_t shard, std::vector< blob_id_t > const& blobs, trace_id_t tid = 0) const = 0;
     virtual NullAsyncResult del(shard_id_t shard, blob_id_t const& blob, trace_id_t tid = 0) = 0;
 };
 
@@ -13,17 +13,45 @@ BlobManager::AsyncResult< Blob > HomeObjectImpl::get(shard_id_t shard, blob_id_t
         });
 }
 
+BlobManager::AsyncResult< std::vector< BlobManager::Result< Blob > > >
+HomeObjectImpl::get_batch(shard_id_t shard, std::vector< blob_id_t > const& blobs, trace_id_t tid) const {
+    return _get_shard(shard, tid)
+        .thenValue([this, blobs,
+                    tid](auto const e) -> BlobManager::AsyncResult< std::vector< BlobManager::Result< Blob > > > {
+            if (!e) return folly::makeUnexpected(BlobError(BlobErrorCode::UNKNOWN_SHARD));
+            if (blobs.empty()) return folly::makeUnexpected(BlobError(BlobErrorCode::INVALID_ARG));
+            return _get_blob_batch(e.value(), blobs, tid);
+        });
+}
+
 BlobManager::AsyncResult< blob_id_t > HomeObjectImpl::put(shard_id_t shard, Blob&& blob, trace_id_t tid) {
     return _get_shard(shard, tid)
         .thenValue([this, blob = std::move(blob), tid](auto const e) mutable -> BlobManager::AsyncResult< blob_id_t > {
             if (!e) return folly::makeUnexpected(BlobError(BlobErrorCode::UNKNOWN_SHARD));
             if (ShardInfo::State::SEALED == e.value().state)
                 return folly::makeUnexpected(BlobError(BlobErrorCode::SEALED_SHARD));
-            if (blob.body.size() == 0) return folly::makeUnexpected(BlobError(BlobErrorCode::INVALID_ARG));
+            if (blob.payload_size() == 0) return folly::makeUnexpected(BlobError(BlobErrorCode::INVALID_ARG));
             return _put_blob(e.value(), std::move(blob), tid);
         });
 }
 
+BlobManager::AsyncResult< std::vector< blob_id_t > > HomeObjectImpl::put_batch(shard_id_t shard,
+                                                                               std::vector< Blob >&& blobs,
+                                                                               trace_id_t tid) {
+    return _get_shard(shard, tid)
+        .thenValue([this, blobs = std::move(blobs),
+                    tid](auto const e) mutable -> BlobManager::AsyncResult< std::vector< blob_id_t > > {
+            if (!e) return folly::makeUnexpected(BlobError(BlobErrorCode::UNKNOWN_SHARD));
+            if (ShardInfo::State::SEALED == e.value().state)
+                return folly::makeUnexpected(BlobError(BlobErrorCode::SEALED_SHARD));
+            if (blobs.empty()) return folly::makeUnexpected(BlobError(BlobErrorCode::INVALID_ARG));
+            for (auto const& blob : blobs) {
+                if (blob.payload_size() == 0) return folly::makeUnexpected(BlobError(BlobErrorCode::INVALID_ARG));
+            }
+            return _put_blob_batch(e.value(), std::move(blobs), tid);
+        });
+}
+
 BlobManager::NullAsyncResult HomeObjectImpl::del(shard_id_t shard, blob_id_t const& blob, trace_id_t tid) {
     return _get_shard(shard, tid).thenValue([this, blob, tid](auto const e) mutable -> BlobManager::NullAsyncResult {
         if (!e) return folly::makeUnexpected(BlobError(BlobErrorCode::UNKNOWN_SHARD));
@@ -31,10 +59,27 @@ BlobManager::NullAsyncResult HomeObjectImpl::del(shard_id_t shard, blob_id_t con
     });
 }
 
-Blob Blob::clone() const {
-    auto new_body = sisl::io_blob_safe(body.size());
-    std::memcpy(new_body.bytes(), body.cbytes(), body.size());
-    return Blob(std::move(new_body), user_key, object_off);
+// Copies the payload of the blob, in body or in body_sgs, into a new buffer
+static sisl::io_blob_safe copy_payload(Blob const& blob) {
+    auto new_body = sisl::io_blob_safe(static_cast< uint32_t >(blob.payload_size()));
+    if (blob.body_sgs.iovs.empty()) {
+        std::memcpy(new_body.bytes(), blob.body.cbytes(), blob.body.size());
+        return new_body;
+    }
+    auto dst = new_body.bytes();
+    for (auto const& iov : blob.body_sgs.iovs) {
+        std::memcpy(dst, iov.iov_base, iov.iov_len);
+        dst += iov.iov_len;
+    }
+    return new_body;
+}
+
+Blob Blob::clone() const { return Blob(copy_payload(*this), user_key, object_off); }
+
+void Blob::gather_body() {
+    if (body_sgs.iovs.empty()) return;
+    body = copy_payload(*this);
+    body_sgs = sisl::sg_list{};
 }
 
 } // namespace homeobject
@@ -5,6 +5,7 @@
 #include "homeobject/pg_manager.hpp"
 #include "homeobject/shard_manager.hpp"
 #include <boost/intrusive_ptr.hpp>
+#include <folly/concurrency/ConcurrentHashMap.h>
 #include <sisl/logging/logging.h>
 
 #define LOGT(...) LOGTRACEMOD(homeobject, ##__VA_ARGS__)
@@ -38,23 +39,26 @@ inline shard_id_t make_new_shard_id(pg_id_t pg, shard_id_t next_shard) {
     return ((uint64_t)pg << shard_width) | next_shard;
 }
 
+struct PG;
+
 struct Shard {
     explicit Shard(ShardInfo info) : info(std::move(info)) {}
     virtual ~Shard() = default;
     ShardInfo info;
+    PG* pg{nullptr}; // set when the shard is added to the shards_ of its pg
     bool is_open() { return ShardInfo::State::OPEN == info.state; }
 };
 
-using ShardPtr = unique< Shard >;
+using ShardPtr = shared< Shard >;
 using ShardPtrList = std::list< ShardPtr >;
 using ShardIterator = ShardPtrList::iterator;
 
 struct PG {
     explicit PG(PGInfo info) : pg_info_(std::move(info)) {}
     PG(PG const& pg) = delete;
-    PG(PG&& pg) = default;
+    PG(PG&& pg) = delete;
     PG& operator=(PG const& pg) = delete;
-    PG& operator=(PG&& pg) = default;
+    PG& operator=(PG&& pg) = delete;
     virtual ~PG() = default;
 
     struct DurableEntities {
@@ -70,6 +74,14 @@ struct PG {
     std::atomic< bool > is_dirty_{false};
     ShardPtrList shards_;
 
+    // Guards shards_, shard_sequence_num_ and the backend superblk of this pg, so that creating shards, flushing or
+    // collecting the stats of one pg does not wait for the others. Taken after _pg_lock and before _shard_lock.
+    mutable std::shared_mutex mtx_;
+
+    // Counts of shards_, kept by HomeObjectImpl::_publish_shard and _unpublish_shard so the stats need no lock.
+    std::atomic< uint32_t > num_shards_{0};
+    std::atomic< uint32_t > num_open_shards_{0};
+
     void durable_entities_update(auto&& cb, bool dirty = true) {
         cb(durable_entities_);
         if (dirty) { is_dirty_.store(true, std::memory_order_relaxed); }
@@ -92,8 +104,13 @@ class HomeObjectImpl : public HomeObject,
     virtual ShardManager::AsyncResult< ShardInfo > _seal_shard(ShardInfo const&, trace_id_t tid) = 0;
 
     virtual BlobManager::AsyncResult< blob_id_t > _put_blob(ShardInfo const&, Blob&&, trace_id_t tid) = 0;
+    virtual BlobManager::AsyncResult< std::vector< blob_id_t > > _put_blob_batch(ShardInfo const&,
+                                                                                 std::vector< Blob >&&,
+                                                                                 trace_id_t tid) = 0;
     virtual BlobManager::AsyncResult< Blob > _get_blob(ShardInfo const&, blob_id_t, uint64_t off, uint64_t len,
                                                        bool allow_skip_verify, trace_id_t tid) const = 0;
+    virtual BlobManager::AsyncResult< std::vector< BlobManager::Result< Blob > > >
+    _get_blob_batch(ShardInfo const&, std::vector< blob_id_t > const&, trace_id_t tid) const = 0;
     virtual BlobManager::NullAsyncResult _del_blob(ShardInfo const&, blob_id_t, trace_id_t tid) = 0;
     ///
 
@@ -136,15 +153,53 @@ protected:
 
     folly::Executor::KeepAlive<> executor_;
 
-    ///
+    /// Lock order: _pg_lock, then PG::mtx_, then _shard_lock. _pg_lock is held exclusively only to add or remove a
+    /// pg of _pg_map (and to change pg_info_), anything within a pg takes it shared plus the lock of that pg.
     mutable std::shared_mutex _pg_lock;
     std::map< pg_id_t, unique< PG > > _pg_map;
 
     mutable std::shared_mutex _shard_lock;
     std::map< shard_id_t, ShardIterator > _shard_map;
+
+    // Copies of the shards of _shard_map for the lookups of the blob and shard APIs, which take no lock. They are
+    // published with _shard_lock held whenever a shard is added, changed or removed, which also keeps the shard counts
+    // of the pgs and of the node. A snapshot shares the ownership of its shard, so that a reader which found it keeps
+    // the shard alive while the shard or its pg is destroyed.
+    struct ShardSnapshot {
+        ShardInfo info;
+        ShardPtr shard;
+    };
+    folly::ConcurrentHashMap< shard_id_t, ShardSnapshot > _shard_snapshots;
+    std::atomic< uint32_t > _num_open_shards{0};
+    void _publish_shard(ShardPtr const& shard) {
+        bool added{true};
+        bool was_open{false};
+        if (auto it = _shard_snapshots.find(shard->info.id); it != _shard_snapshots.cend()) {
+            added = false;
+            was_open = it->second.info.is_open();
+        }
+        _shard_snapshots.insert_or_assign(shard->info.id, ShardSnapshot{shard->info, shard});
+        if (added) { shard->pg->num_shards_.fetch_add(1, std::memory_order_relaxed); }
+        _count_open_shard(*shard->pg, int(shard->info.is_open()) - int(was_open));
+    }
+    void _unpublish_shard(Shard& shard) {
+        auto it = _shard_snapshots.find(shard.info.id);
+        if (it == _shard_snapshots.cend()) { return; }
+        auto const was_open = it->second.info.is_open();
+        _shard_snapshots.erase(shard.info.id);
+        shard.pg->num_shards_.fetch_sub(1, std::memory_order_relaxed);
+        _count_open_shard(*shard.pg, -int(was_open));
+    }
+    void _count_open_shard(PG& pg, int delta) {
+        if (delta == 0) { return; }
+        // a negative delta wraps around to a decrement
+        pg.num_open_shards_.fetch_add(static_cast< uint32_t >(delta), std::memory_order_relaxed);
+        _num_open_shards.fetch_add(static_cast< uint32_t >(delta), std::memory_order_relaxed);
+    }
     ///
 
     auto _defer() const { return folly::makeSemiFuture().via(executor_); }
+    // Looks the shard up on the calling thread, the continuations run there as well.
     folly::Future< ShardManager::Result< ShardInfo > > _get_shard(shard_id_t id, trace_id_t tid) const;
 
 public:
@@ -196,8 +251,12 @@ public:
 
     /// BlobManager
     BlobManager::AsyncResult< blob_id_t > put(shard_id_t shard, Blob&&, trace_id_t tid) final;
+    BlobManager::AsyncResult< std::vector< blob_id_t > > put_batch(shard_id_t shard, std::vector< Blob >&& blobs,
+                                                                   trace_id_t tid) final;
     BlobManager::AsyncResult< Blob > get(shard_id_t shard, blob_id_t const& blob, uint64_t off, uint64_t len,
                                          bool allow_skip_verify, trace_id_t tid) const final;
+    BlobManager::AsyncResult< std::vector< BlobManager::Result< Blob > > >
+    get_batch(shard_id_t shard, std::vector< blob_id_t > const& blobs, trace_id_t tid) const final;
     BlobManager::NullAsyncResult del(shard_id_t shard, blob_id_t const& blob, trace_id_t tid) final;
 };
 
@@ -0,0 +1,97 @@
+#include "blob_id_filter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace homeobject {
+
+namespace {
+
+// splitmix64 finalizer, blob ids are sequential and need spreading over the blocks.
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+} // namespace
+
+BlobIdFilter::Layer::Layer(uint64_t bytes, uint32_t bits_per_blob) :
+        words{std::make_unique< std::atomic< uint64_t >[] >(bytes / sizeof(uint64_t))},
+        num_blocks{bytes / block_bytes},
+        capacity{std::max< uint64_t >(bytes * 8 / bits_per_blob, 1)} {}
+
+BlobIdFilter::BlobIdFilter(uint64_t max_bytes, uint32_t bits_per_blob, bool ready) :
+        max_bytes_{max_bytes / block_bytes * block_bytes},
+        bits_per_blob_{std::max(bits_per_blob, 1u)},
+        // the number of hashes which gives the lowest false positive rate, ln(2) * bits per blob
+        num_hashes_{std::clamp< uint32_t >(uint32_t(std::lround(bits_per_blob_ * 0.693)), 1, 16)},
+        ready_{ready} {
+    if (max_bytes_ == 0) { return; }
+    std::scoped_lock lg(grow_mtx_);
+    total_bytes_ = std::min(first_layer_bytes, max_bytes_);
+    layers_[0] = std::make_unique< Layer >(total_bytes_, bits_per_blob_);
+    num_layers_.store(1, std::memory_order_release);
+}
+
+void BlobIdFilter::add(blob_id_t blob_id) {
+    auto const num_layers = num_layers_.load(std::memory_order_acquire);
+    if (num_layers == 0) { return; }
+    auto& layer = *layers_[num_layers - 1];
+
+    auto const hash = mix(blob_id);
+    auto* block = &layer.words[((hash >> 32) * layer.num_blocks >> 32) * words_per_block];
+    auto const h1 = uint32_t(hash);
+    auto const h2 = uint32_t(mix(hash) >> 32) | 1;
+    for (uint32_t i = 0; i < num_hashes_; ++i) {
+        auto const bit = (h1 + i * h2) % (block_bytes * 8);
+        block[bit / 64].fetch_or(1ull << (bit % 64), std::memory_order_relaxed);
+    }
+
+    if (layer.count.fetch_add(1, std::memory_order_relaxed) + 1 == layer.capacity) { grow(num_layers); }
+}
+
+bool BlobIdFilter::maybe_contains(blob_id_t blob_id) const {
+    if (!is_ready()) { return true; }
+    auto const num_layers = num_layers_.load(std::memory_order_acquire);
+    if (num_layers == 0) { return true; }
+
+    auto const hash = mix(blob_id);
+    for (size_t i = num_layers; i > 0; --i) {
+        if (layer_contains(*layers_[i - 1], hash)) { return true; }
+    }
+    return false;
+}
+
+bool BlobIdFilter::layer_contains(Layer const& layer, uint64_t hash) const {
+    auto const* block = &layer.words[((hash >> 32) * layer.num_blocks >> 32) * words_per_block];
+    auto const h1 = uint32_t(hash);
+    auto const h2 = uint32_t(mix(hash) >> 32) | 1;
+    for (uint32_t i = 0; i < num_hashes_; ++i) {
+        auto const bit = (h1 + i * h2) % (block_bytes * 8);
+        if (!(block[bit / 64].load(std::memory_order_relaxed) & (1ull << (bit % 64)))) { return false; }
+    }
+    return true;
+}
+
+void BlobIdFilter::grow(size_t num_layers) {
+    std::scoped_lock lg(grow_mtx_);
+    if (num_layers_.load(std::memory_order_relaxed) != num_layers || num_layers == max_layers) { return; }
+    auto const bytes = std::min(layers_[num_layers - 1]->num_blocks * block_bytes * 2, max_bytes_ - total_bytes_) /
+        block_bytes * block_bytes;
+    // out of budget, the last layer keeps taking the new blobs
+    if (bytes == 0) { return; }
+    layers_[num_layers] = std::make_unique< Layer >(bytes, bits_per_blob_);
+    total_bytes_ += bytes;
+    num_layers_.store(num_layers + 1, std::memory_order_release);
+}
+
+uint64_t BlobIdFilter::size_bytes() const {
+    std::scoped_lock lg(grow_mtx_);
+    return total_bytes_;
+}
+
+} // namespace homeobject
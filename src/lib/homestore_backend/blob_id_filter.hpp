@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "homeobject/common.hpp"
+
+namespace homeobject {
+
+// In-memory Bloom filter of the blob ids put into a shard, which lets a get of a blob that was never put answer
+// without a lookup in the pg index. It has no false negatives, but it does not forget deleted blobs either.
+//
+// The number of blobs of a shard is not known upfront, so the filter is a chain of layers, each twice as large as the
+// one before it, and a new blob goes into the newest layer. Once max_bytes is used up the blobs keep going into the
+// last layer, which only raises the false positive rate. Each layer is a blocked Bloom filter: all bits of a blob are
+// in one 64 byte block, so a lookup touches one cache line per layer.
+//
+// Blobs can be added concurrently with lookups. A filter starts out not ready and answers "maybe" to every lookup
+// until set_ready, e.g. after it has been rebuilt from the index at start.
+class BlobIdFilter {
+public:
+    // max_bytes 0 disables the filter.
+    BlobIdFilter(uint64_t max_bytes, uint32_t bits_per_blob, bool ready);
+    ~BlobIdFilter() = default;
+    BlobIdFilter(BlobIdFilter const&) = delete;
+    BlobIdFilter& operator=(BlobIdFilter const&) = delete;
+
+    void add(blob_id_t blob_id);
+    // False only if blob_id was never added.
+    bool maybe_contains(blob_id_t blob_id) const;
+
+    void set_ready() { ready_.store(true, std::memory_order_release); }
+    bool is_ready() const { return ready_.load(std::memory_order_acquire); }
+    uint64_t size_bytes() const;
+
+    static constexpr uint64_t block_bytes = 64;
+    static constexpr uint64_t first_layer_bytes = 1024;
+
+private:
+    struct Layer {
+        Layer(uint64_t bytes, uint32_t bits_per_blob);
+        std::unique_ptr< std::atomic< uint64_t >[] > words;
+        uint64_t const num_blocks;
+        uint64_t const capacity; // blobs the layer takes before the next one is added
+        std::atomic< uint64_t > count{0};
+    };
+    static constexpr size_t max_layers = 32;
+    static constexpr size_t words_per_block = block_bytes / sizeof(uint64_t);
+
+    void grow(size_t num_layers);
+    bool layer_contains(Layer const& layer, uint64_t hash) const;
+
+    uint64_t const max_bytes_;
+    uint32_t const bits_per_blob_;
+    uint32_t const num_hashes_;
+    std::atomic< bool > ready_;
+    std::array< std::unique_ptr< Layer >, max_layers > layers_;
+    std::atomic< size_t > num_layers_{0};
+    uint64_t total_bytes_{0}; // protected by grow_mtx_
+    mutable std::mutex grow_mtx_;
+};
+
+} // namespace homeobject
@@ -0,0 +1,151 @@
+#include "blob_read_cache.hpp"
+
+namespace homeobject {
+
+BlobReadCache::Metrics::Metrics(BlobReadCache const& cache) :
+        sisl::MetricsGroup{"BlobReadCache", "HomeObject"}, cache_{cache} {
+    REGISTER_COUNTER(blob_cache_hit_count, "Number of gets served from the blob read cache");
+    REGISTER_COUNTER(blob_cache_miss_count, "Number of gets not found in the blob read cache");
+    REGISTER_COUNTER(blob_cache_insert_count, "Number of blobs added to the blob read cache");
+    REGISTER_COUNTER(blob_cache_eviction_count, "Number of blobs evicted from the blob read cache");
+    REGISTER_COUNTER(blob_cache_invalidation_count, "Number of blobs dropped by delete, gc or pg destroy");
+    REGISTER_GAUGE(blob_cache_size_bytes, "Bytes held by the blob read cache");
+    REGISTER_GAUGE(blob_cache_budget_bytes, "Byte budget of the blob read cache");
+
+    register_me_to_farm();
+    attach_gather_cb([this]() {
+        GAUGE_UPDATE(*this, blob_cache_size_bytes, cache_.size_bytes());
+        GAUGE_UPDATE(*this, blob_cache_budget_bytes, cache_.budget_bytes());
+    });
+}
+
+BlobReadCache::BlobReadCache(uint64_t budget_bytes) :
+        budget_bytes_{budget_bytes},
+        partition_budget_{budget_bytes / num_partitions},
+        partitions_{std::make_unique< Partition[] >(num_partitions)},
+        metrics_{*this} {}
+
+BlobReadCache::Partition& BlobReadCache::partition(BlobRoute const& route) const {
+    return partitions_[std::hash< BlobRoute >{}(route) % num_partitions];
+}
+
+BlobReadCache::EntryPtr BlobReadCache::get(BlobRoute const& route) {
+    auto& p = partition(route);
+    std::unique_lock lg(p.mtx);
+    auto it = p.index.find(route);
+    if (it == p.index.end()) {
+        lg.unlock();
+        COUNTER_INCREMENT(metrics_, blob_cache_miss_count, 1);
+        return nullptr;
+    }
+
+    auto node = it->second;
+    if (node->is_protected) {
+        p.protected_.splice(p.protected_.begin(), p.protected_, node);
+    } else {
+        // second hit, promote to the protected segment and demote its least recently used blobs if it is full
+        node->is_protected = true;
+        p.probation_bytes -= node->bytes;
+        p.protected_bytes += node->bytes;
+        p.protected_.splice(p.protected_.begin(), p.probation, node);
+        while (p.protected_bytes > partition_budget_ * protected_percent / 100 && p.protected_.size() > 1) {
+            auto demoted = std::prev(p.protected_.end());
+            demoted->is_protected = false;
+            p.protected_bytes -= demoted->bytes;
+            p.probation_bytes += demoted->bytes;
+            p.probation.splice(p.probation.begin(), p.protected_, demoted);
+        }
+    }
+    auto entry = node->entry;
+    lg.unlock();
+    COUNTER_INCREMENT(metrics_, blob_cache_hit_count, 1);
+    return entry;
+}
+
+BlobReadCache::ticket_t BlobReadCache::ticket(BlobRoute const& route) const {
+    auto& p = partition(route);
+    std::scoped_lock lg(p.mtx);
+    return p.generation;
+}
+
+void BlobReadCache::insert(BlobRoute const& route, ticket_t ticket, Entry&& entry) {
+    uint64_t const bytes = entry.body.size() + entry.user_key.size() + entry_overhead;
+    if (bytes > partition_budget_ / 2) { return; }
+    auto cached = std::make_shared< const Entry >(std::move(entry));
+
+    auto& p = partition(route);
+    uint64_t evicted{0};
+    {
+        std::scoped_lock lg(p.mtx);
+        if (p.generation != ticket || p.index.contains(route)) { return; }
+        p.probation.push_front(Node{route, std::move(cached), bytes, false /* is_protected */});
+        p.index.emplace(route, p.probation.begin());
+        p.probation_bytes += bytes;
+        while (p.probation_bytes + p.protected_bytes > partition_budget_) {
+            evict(p);
+            ++evicted;
+        }
+    }
+    COUNTER_INCREMENT(metrics_, blob_cache_insert_count, 1);
+    if (evicted) { COUNTER_INCREMENT(metrics_, blob_cache_eviction_count, evicted); }
+}
+
+void BlobReadCache::invalidate(BlobRoute const& route) {
+    auto& p = partition(route);
+    bool erased{false};
+    {
+        std::scoped_lock lg(p.mtx);
+        ++p.generation;
+        if (auto it = p.index.find(route); it != p.index.end()) {
+            erase(p, it->second);
+            erased = true;
+        }
+    }
+    if (erased) { COUNTER_INCREMENT(metrics_, blob_cache_invalidation_count, 1); }
+}
+
+void BlobReadCache::invalidate_pg(pg_id_t pg_id) {
+    uint64_t erased{0};
+    for (size_t i = 0; i < num_partitions; ++i) {
+        auto& p = partitions_[i];
+        std::scoped_lock lg(p.mtx);
+        ++p.generation;
+        for (auto it = p.index.begin(); it != p.index.end();) {
+            auto node = (it++)->second;
+            if ((node->route.shard >> shard_width) == pg_id) {
+                erase(p, node);
+                ++erased;
+            }
+        }
+    }
+    if (erased) { COUNTER_INCREMENT(metrics_, blob_cache_invalidation_count, erased); }
+}
+
+uint64_t BlobReadCache::size_bytes() const {
+    uint64_t bytes{0};
+    for (size_t i = 0; i < num_partitions; ++i) {
+        auto& p = partitions_[i];
+        std::scoped_lock lg(p.mtx);
+        bytes += p.probation_bytes + p.protected_bytes;
+    }
+    return bytes;
+}
+
+void BlobReadCache::erase(Partition& p, NodeList::iterator it) {
+    p.index.erase(it->route);
+    if (it->is_protected) {
+        p.protected_bytes -= it->bytes;
+        p.protected_.erase(it);
+    } else {
+        p.probation_bytes -= it->bytes;
+        p.probation.erase(it);
+    }
+}
+
+void BlobReadCache::evict(Partition& p) {
+    // blobs which never had a second hit go first
+    auto& victims = p.probation.empty() ? p.protected_ : p.probation;
+    erase(p, std::prev(victims.end()));
+}
+
+} // namespace homeobject
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sisl/fds/buffer.hpp>
+#include <sisl/metrics/metrics.hpp>
+
+#include "lib/blob_route.hpp"
+
+namespace homeobject {
+
+// Byte budgeted cache of verified blobs, keyed by BlobRoute, which lets a get of a hot blob skip the index lookup, the
+// device read and the verification. Eviction is a segmented LRU: a blob enters the probation segment and is promoted
+// to the protected segment on its next hit, so blobs read only once (e.g. a scan) cycle through probation and never
+// push the hot blobs out. The entries are spread over independently locked partitions, each owning a share of the
+// budget.
+//
+// A blob may be deleted or moved while it is read from the device. A reader therefore takes a ticket before it looks
+// the blob up in the index, and insert drops the blob if its partition was invalidated after the ticket was taken.
+class BlobReadCache {
+public:
+    struct Entry {
+        sisl::io_blob_safe body;
+        std::string user_key;
+        uint64_t object_off;
+    };
+    using EntryPtr = std::shared_ptr< const Entry >;
+    using ticket_t = uint64_t;
+
+    explicit BlobReadCache(uint64_t budget_bytes);
+    ~BlobReadCache() = default;
+    BlobReadCache(BlobReadCache const&) = delete;
+    BlobReadCache& operator=(BlobReadCache const&) = delete;
+
+    EntryPtr get(BlobRoute const& route);
+    ticket_t ticket(BlobRoute const& route) const;
+    void insert(BlobRoute const& route, ticket_t ticket, Entry&& entry);
+    void invalidate(BlobRoute const& route);
+    // Drops every blob of the shards of pg_id, e.g. when the pg is destroyed and its shard ids may come back.
+    void invalidate_pg(pg_id_t pg_id);
+
+    uint64_t budget_bytes() const { return budget_bytes_; }
+    uint64_t size_bytes() const;
+
+private:
+    struct Node {
+        BlobRoute route;
+        EntryPtr entry;
+        uint64_t bytes;
+        bool is_protected;
+    };
+    using NodeList = std::list< Node >;
+
+    struct Partition {
+        mutable std::mutex mtx;
+        NodeList probation; // most recently used first
+        NodeList protected_;
+        std::unordered_map< BlobRoute, NodeList::iterator > index;
+        uint64_t probation_bytes{0};
+        uint64_t protected_bytes{0};
+        uint64_t generation{0}; // bumped by every invalidation, see ticket
+    };
+
+    struct Metrics : public sisl::MetricsGroup {
+        explicit Metrics(BlobReadCache const& cache);
+        ~Metrics() { deregister_me_from_farm(); }
+        Metrics(Metrics const&) = delete;
+        Metrics& operator=(Metrics const&) = delete;
+
+    private:
+        BlobReadCache const& cache_;
+    };
+
+    static constexpr size_t num_partitions = 16;
+    // Share of the budget of a partition the protected segment may take.
+    static constexpr uint64_t protected_percent = 80;
+    // Approximate memory taken by an entry besides its body and user key.
+    static constexpr uint64_t entry_overhead = 128;
+
+    Partition& partition(BlobRoute const& route) const;
+    void erase(Partition& p, NodeList::iterator it);
+    void evict(Partition& p);
+
+    uint64_t const budget_bytes_;
+    uint64_t const partition_budget_;
+    std::unique_ptr< Partition[] > partitions_;
+    Metrics metrics_;
+};
+
+} // namespace homeobject
@@ -0,0 +1,165 @@
+#include "crc32c.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+namespace homeobject {
+
+namespace {
+
+// Castagnoli polynomial in reflected bit order, x^0 is the most significant bit.
+constexpr uint32_t crc32c_poly = 0x82f63b78;
+
+// tables[k][b] is the crc of the byte b followed by k zero bytes, which lets slice-by-8 fold 8 bytes at a time.
+using crc32c_tables_t = std::array< std::array< uint32_t, 256 >, 8 >;
+
+constexpr crc32c_tables_t make_crc32c_tables() {
+    crc32c_tables_t tables{};
+    for (uint32_t b = 0; b < 256; ++b) {
+        uint32_t crc = b;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ crc32c_poly : crc >> 1;
+        }
+        tables[0][b] = crc;
+    }
+    for (size_t k = 1; k < tables.size(); ++k) {
+        for (uint32_t b = 0; b < 256; ++b) {
+            tables[k][b] = (tables[k - 1][b] >> 8) ^ tables[0][tables[k - 1][b] & 0xff];
+        }
+    }
+    return tables;
+}
+
+constexpr crc32c_tables_t crc32c_tables = make_crc32c_tables();
+
+// The crc register functions below take and return the register without the initial and final inversion.
+uint32_t crc32c_sw_reg(uint32_t crc, uint8_t const* buf, size_t len) {
+    auto const& t = crc32c_tables;
+    while (len > 0 && (reinterpret_cast< uintptr_t >(buf) & 7) != 0) {
+        crc = t[0][(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+        --len;
+    }
+    // little endian: the first byte of the word is the lowest one and has the most bytes following it
+    for (; len >= 8; buf += 8, len -= 8) {
+        uint64_t word;
+        std::memcpy(&word, buf, sizeof(word));
+        word ^= crc;
+        crc = t[7][word & 0xff] ^ t[6][(word >> 8) & 0xff] ^ t[5][(word >> 16) & 0xff] ^ t[4][(word >> 24) & 0xff] ^
+            t[3][(word >> 32) & 0xff] ^ t[2][(word >> 40) & 0xff] ^ t[1][(word >> 48) & 0xff] ^ t[0][word >> 56];
+    }
+    while (len-- > 0) {
+        crc = t[0][(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+// a * b modulo the polynomial, both in reflected bit order.
+uint32_t multmodp(uint32_t a, uint32_t b) {
+    uint32_t m = 1u << 31;
+    uint32_t p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) { break; }
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ crc32c_poly : b >> 1;
+    }
+    return p;
+}
+
+// x^n modulo the polynomial.
+uint32_t xpow(uint64_t n) {
+    uint32_t x2n = 1u << 30; // x^1, squared for each bit of n
+    uint32_t p = 1u << 31;   // x^0
+    for (; n != 0; n >>= 1) {
+        if (n & 1) { p = multmodp(x2n, p); }
+        x2n = multmodp(x2n, x2n);
+    }
+    return p;
+}
+
+// Constant for shift_crc which feeds a crc register len zero bytes, x^(8 * len) in the end. The carry-less product of
+// two reflected values is one x short and the crc32 instruction multiplies by another x^32, which makes up for the 33.
+uint32_t shift_constant(size_t len) { return xpow(8 * len - 33); }
+
+__attribute__((target("sse4.2,pclmul"))) uint32_t shift_crc(uint32_t crc, uint32_t constant) {
+    auto const product = _mm_clmulepi64_si128(_mm_cvtsi32_si128(int(crc)), _mm_cvtsi32_si128(int(constant)), 0);
+    return uint32_t(_mm_crc32_u64(0, uint64_t(_mm_cvtsi128_si64(product))));
+}
+
+// The crc32 instruction has a latency of 3 cycles but a throughput of 1 per cycle, so buffers are split into three
+// stripes which are computed in an interleaved way and then combined with two carry-less multiplications. Large
+// stripes keep the combine cost low, the small ones keep 4K payloads interleaved as well.
+constexpr size_t crc32c_large_stripe = 4096;
+constexpr size_t crc32c_small_stripe = 256;
+
+template < size_t stripe >
+__attribute__((target("sse4.2,pclmul"))) uint64_t crc32c_hw_stripes(uint64_t crc, uint8_t const*& buf, size_t& len) {
+    if (len < 3 * stripe) { return crc; }
+    static uint32_t const stripe_op = shift_constant(stripe);
+    for (; len >= 3 * stripe; buf += 3 * stripe, len -= 3 * stripe) {
+        uint64_t crc1{0};
+        uint64_t crc2{0};
+        for (size_t i = 0; i < stripe; i += 8) {
+            uint64_t w0, w1, w2;
+            std::memcpy(&w0, buf + i, sizeof(w0));
+            std::memcpy(&w1, buf + stripe + i, sizeof(w1));
+            std::memcpy(&w2, buf + 2 * stripe + i, sizeof(w2));
+            crc = _mm_crc32_u64(crc, w0);
+            crc1 = _mm_crc32_u64(crc1, w1);
+            crc2 = _mm_crc32_u64(crc2, w2);
+        }
+        // crc(a|b) = crc(a) shifted over the zeros of b, xor crc of b from a zero register
+        crc = shift_crc(shift_crc(uint32_t(crc), stripe_op) ^ uint32_t(crc1), stripe_op) ^ uint32_t(crc2);
+    }
+    return crc;
+}
+
+__attribute__((target("sse4.2,pclmul"))) uint32_t crc32c_hw_reg(uint32_t crc32, uint8_t const* buf, size_t len) {
+    uint64_t crc = crc32;
+    while (len > 0 && (reinterpret_cast< uintptr_t >(buf) & 7) != 0) {
+        crc = _mm_crc32_u8(uint32_t(crc), *buf++);
+        --len;
+    }
+    crc = crc32c_hw_stripes< crc32c_large_stripe >(crc, buf, len);
+    crc = crc32c_hw_stripes< crc32c_small_stripe >(crc, buf, len);
+    for (; len >= 8; buf += 8, len -= 8) {
+        uint64_t word;
+        std::memcpy(&word, buf, sizeof(word));
+        crc = _mm_crc32_u64(crc, word);
+    }
+    while (len-- > 0) {
+        crc = _mm_crc32_u8(uint32_t(crc), *buf++);
+    }
+    return uint32_t(crc);
+}
+#endif
+
+} // namespace
+
+bool crc32c_hw_available() {
+#if defined(__x86_64__)
+    static bool const available = __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul");
+    return available;
+#else
+    return false;
+#endif
+}
+
+uint32_t crc32c_sw(uint32_t crc, uint8_t const* buf, size_t len) { return ~crc32c_sw_reg(~crc, buf, len); }
+
+uint32_t crc32c(uint32_t crc, uint8_t const* buf, size_t len) {
+#if defined(__x86_64__)
+    if (crc32c_hw_available()) { return ~crc32c_hw_reg(~crc, buf, len); }
+#endif
+    return crc32c_sw(crc, buf, len);
+}
+
+} // namespace homeobject
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace homeobject {
+
+// CRC32C (Castagnoli), the checksum of iSCSI and ext4. It is computed with the SSE4.2 crc32 and PCLMUL instructions
+// where the CPU has them and with a slice-by-8 table otherwise, both give the same result. Like crc32_ieee it can be
+// chained: crc32c(crc32c(0, a, a_len), b, b_len) == crc32c(0, ab, a_len + b_len).
+uint32_t crc32c(uint32_t crc, uint8_t const* buf, size_t len);
+
+// The portable implementation, regardless of the CPU. Exposed for tests and benchmarks.
+uint32_t crc32c_sw(uint32_t crc, uint8_t const* buf, size_t len);
+
+// Whether crc32c runs on the crc32 and carry-less multiplication instructions.
+bool crc32c_hw_available();
+
+} // namespace homeobject
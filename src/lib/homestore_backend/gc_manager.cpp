@@ -1,5 +1,11 @@
+#include <bit>
+#include <cmath>
+#include <limits>
+
 #include <homestore/btree/btree_req.hpp>
 #include <homestore/btree/btree_kv.hpp>
+#include <folly/executors/GlobalExecutor.h>
+#include <folly/executors/InlineExecutor.h>
 
 #include "hs_homeobject.hpp"
 namespace homeobject {
@@ -118,6 +124,12 @@ void GCManager::on_reserved_chunk_meta_blk_found(sisl::byte_view const& buf, voi
 GCManager::~GCManager() { stop(); }
 
 void GCManager::start() {
+    // seed the garbage index of every pdev with what homestore knows, the deletes committed since then are counted
+    // as they come
+    for (const auto& [pdev_id, chunks] : m_chunk_selector->get_pdev_chunks()) {
+        reconcile_chunk_garbage(pdev_id, chunks);
+    }
+
     for (const auto& [pdev_id, gc_actor] : m_pdev_gc_actors) {
         gc_actor->start();
         LOGINFOMOD(gcmgr, "start gc actor for pdev={}", pdev_id);
@@ -220,9 +232,79 @@ std::shared_ptr< GCManager::pdev_gc_actor > GCManager::get_pdev_gc_actor(uint32_
     return it->second;
 }
 
+void GCManager::record_client_io_latency(chunk_id_t chunk_id, uint64_t latency_us) {
+    auto vchunk = m_chunk_selector->get_extend_vchunk(chunk_id);
+    if (!vchunk) { return; }
+    auto it = m_pdev_gc_actors.find(vchunk->get_pdev_id());
+    if (it != m_pdev_gc_actors.end()) { it->second->record_client_io_latency(latency_us); }
+}
+
+std::shared_ptr< GCManager::pdev_gc_actor > GCManager::get_chunk_gc_actor(chunk_id_t chunk_id) const {
+    auto vchunk = m_chunk_selector->get_extend_vchunk(chunk_id);
+    if (!vchunk) { return nullptr; }
+    auto it = m_pdev_gc_actors.find(vchunk->get_pdev_id());
+    return it == m_pdev_gc_actors.end() ? nullptr : it->second;
+}
+
+void GCManager::add_chunk_garbage(chunk_id_t chunk_id, uint64_t blks) {
+    auto actor = get_chunk_gc_actor(chunk_id);
+    if (!actor) { return; }
+    const auto total_blks = m_chunk_selector->get_extend_vchunk(chunk_id)->get_total_blks();
+    if (actor->chunk_garbage().add(chunk_id, blks, total_blks, HS_BACKEND_DYNAMIC_CONFIG(gc_garbage_rate_threshold))) {
+        LOGDEBUGMOD(gcmgr, "chunk_id={} is over the gc threshold with {} garbage blks", chunk_id,
+                    actor->chunk_garbage().garbage_blks(chunk_id));
+        trigger_gc_task(std::move(actor), chunk_id);
+    }
+}
+
+void GCManager::reconcile_chunk_garbage(uint32_t pdev_id, std::vector< chunk_id_t > const& chunks) {
+    auto actor = get_pdev_gc_actor(pdev_id);
+    if (!actor) { return; }
+    for (const auto& chunk_id : chunks) {
+        auto chunk = m_chunk_selector->get_extend_vchunk(chunk_id);
+        if (chunk) { actor->chunk_garbage().raise(chunk_id, chunk->get_defrag_nblks(), chunk->get_total_blks()); }
+    }
+}
+
+void GCManager::on_chunk_released(chunk_id_t chunk_id) {
+    auto actor = get_chunk_gc_actor(chunk_id);
+    if (actor) { trigger_gc_task(std::move(actor), chunk_id); }
+}
+
+void GCManager::reset_chunk_garbage(chunk_id_t chunk_id, uint64_t blks) {
+    auto actor = get_chunk_gc_actor(chunk_id);
+    if (!actor) { return; }
+    actor->chunk_garbage().set(chunk_id, blks, m_chunk_selector->get_extend_vchunk(chunk_id)->get_total_blks());
+}
+
+uint64_t GCManager::get_chunk_garbage_blks(chunk_id_t chunk_id) const {
+    auto vchunk = m_chunk_selector->get_extend_vchunk(chunk_id);
+    if (!vchunk) { return 0; }
+    // the blks of a delete are counted at its commit, homestore only counts them once they are freed. the count of
+    // homestore covers the blks freed without being counted here, e.g. by a baseline resync, until the next scan
+    // reconciles the index with it.
+    const uint64_t defrag_blks = vchunk->get_defrag_nblks();
+    auto actor = get_chunk_gc_actor(chunk_id);
+    return actor ? std::max(defrag_blks, actor->chunk_garbage().garbage_blks(chunk_id)) : defrag_blks;
+}
+
+void GCManager::trigger_gc_task(std::shared_ptr< pdev_gc_actor > actor, chunk_id_t chunk_id) {
+    if (!HS_BACKEND_DYNAMIC_CONFIG(gc_trigger_on_garbage)) { return; }
+    // marking the chunk for gc takes the chunk selector lock, which the raft commit threads calling this must not wait
+    // for
+    folly::getGlobalCPUExecutor()->add([this, actor = std::move(actor), chunk_id]() {
+        if (!is_eligible_for_gc(chunk_id)) { return; }
+        const auto reserved_chunk_num_per_pdev = HS_BACKEND_DYNAMIC_CONFIG(reserved_chunk_num_per_pdev);
+        const auto reserved_chunk_num_per_pdev_for_egc =
+            HS_BACKEND_DYNAMIC_CONFIG(reserved_chunk_num_per_pdev_for_egc);
+        actor->add_triggered_gc_task(chunk_id,
+                                     2 * (reserved_chunk_num_per_pdev - reserved_chunk_num_per_pdev_for_egc));
+    });
+}
+
 bool GCManager::is_eligible_for_gc(chunk_id_t chunk_id) {
     auto chunk = m_chunk_selector->get_extend_vchunk(chunk_id);
-    const auto defrag_blk_num = chunk->get_defrag_nblks();
+    const auto defrag_blk_num = get_chunk_garbage_blks(chunk_id);
     if (!defrag_blk_num) { return false; }
 
     // 1 if the chunk state is inuse, it is occupied by a open shard, so it can not be selected and we don't need gc it.
@@ -243,39 +325,80 @@ bool GCManager::is_eligible_for_gc(chunk_id_t chunk_id) {
     return should_gc;
 }
 
+double GCManager::cost_benefit_score(uint64_t garbage_blks, uint64_t live_blks, uint64_t age_sec) {
+    if (!live_blks) { return std::numeric_limits< double >::infinity(); }
+    return static_cast< double >(garbage_blks) * static_cast< double >(age_sec) / (2.0 * live_blks);
+}
+
+uint64_t GCManager::chunk_age_sec(chunk_id_t chunk_id, uint64_t now_ms) const {
+    uint64_t last_modified_ms{0};
+    for (const auto shard_id : m_hs_home_object->get_shards_in_chunk(chunk_id)) {
+        // the live shard info is only stable under _shard_lock, read the published copy
+        const auto info = m_hs_home_object->get_shard_info(shard_id);
+        if (info) { last_modified_ms = std::max(last_modified_ms, info->last_modified_time); }
+    }
+    return now_ms > last_modified_ms ? (now_ms - last_modified_ms) / 1000 : 0;
+}
+
 void GCManager::scan_chunks_for_gc() {
     const auto reserved_chunk_num_per_pdev = HS_BACKEND_DYNAMIC_CONFIG(reserved_chunk_num_per_pdev);
     const auto reserved_chunk_num_per_pdev_for_egc = HS_BACKEND_DYNAMIC_CONFIG(reserved_chunk_num_per_pdev_for_egc);
-
+    const auto policy = static_cast< gc_victim_policy >(HS_BACKEND_DYNAMIC_CONFIG(gc_victim_policy));
+    const auto gc_garbage_rate_threshold = HS_BACKEND_DYNAMIC_CONFIG(gc_garbage_rate_threshold);
+    const auto now_ms = m_hs_home_object->get_current_timestamp();
+    // a few counter reads per chunk, which pick up the garbage freed without going through add_chunk_garbage
     for (const auto& [pdev_id, chunks] : m_chunk_selector->get_pdev_chunks()) {
+        reconcile_chunk_garbage(pdev_id, chunks);
+    }
+
+    for (const auto& [pdev_id, actor] : m_pdev_gc_actors) {
         auto max_task_num = 2 * (reserved_chunk_num_per_pdev - reserved_chunk_num_per_pdev_for_egc);
-        auto it = m_pdev_gc_actors.find(pdev_id);
-        RELEASE_ASSERT(it != m_pdev_gc_actors.end(), "can not find gc actor for pdev_id {} when scanning chunks for gc",
-                       pdev_id);
-        auto& actor = it->second;
-
-        for (const auto& chunk_id : chunks) {
-            if (is_eligible_for_gc(chunk_id)) {
-                auto future = actor->add_gc_task(static_cast< uint8_t >(task_priority::normal), chunk_id);
-                if (future.isReady()) {
-                    if (future.value()) {
-                        LOGINFOMOD(
-                            gcmgr,
-                            "gc task for chunk_id={} on pdev_id={} has been submitted and successfully completed "
-                            "shortly",
-                            chunk_id, pdev_id);
-                    } else {
-                        LOGWARNMOD(gcmgr,
-                                   "got false after add_gc_task for chunk_id={} on pdev_id={}, it means we cannot mark "
-                                   "this chunk to gc state(there is an open shard on this chunk ATM) or this task is "
-                                   "executed shortly but fails(fail to copy data or update gc index table) ",
-                                   chunk_id, pdev_id);
-                    }
-                } else if (0 == --max_task_num) {
-                    LOGINFOMOD(gcmgr, "reached max gc task limit for pdev_id={}, stopping further gc task submissions",
-                               pdev_id);
-                    break;
+
+        // only the chunks of this pdev over the threshold are taken from its garbage index, the others are not
+        // visited. they are ranked so that the best ones are taken first when there are more of them than gc tasks.
+        // ties, e.g. chunks without age, are broken by the garbage.
+        struct candidate {
+            double score;
+            uint64_t garbage_blks;
+            chunk_id_t chunk_id;
+        };
+        std::vector< candidate > candidates;
+        for (const auto& chunk_id : actor->chunk_garbage().over_threshold(gc_garbage_rate_threshold)) {
+            if (!is_eligible_for_gc(chunk_id)) { continue; }
+            const auto chunk = m_chunk_selector->get_extend_vchunk(chunk_id);
+            const uint64_t garbage_blks = get_chunk_garbage_blks(chunk_id);
+            const uint64_t used_blks = chunk->get_used_blks();
+            const uint64_t live_blks = used_blks > garbage_blks ? used_blks - garbage_blks : 0;
+            const double score = policy == gc_victim_policy::cost_benefit
+                ? cost_benefit_score(garbage_blks, live_blks, chunk_age_sec(chunk_id, now_ms))
+                : static_cast< double >(garbage_blks);
+            LOGDEBUGMOD(gcmgr, "gc candidate chunk_id={} on pdev_id={}, garbage_blks={}, live_blks={}, score={}",
+                        chunk_id, pdev_id, garbage_blks, live_blks, score);
+            candidates.push_back({score, garbage_blks, chunk_id});
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const candidate& a, const candidate& b) {
+            return a.score != b.score ? a.score > b.score : a.garbage_blks > b.garbage_blks;
+        });
+
+        for (const auto& [score, garbage_blks, chunk_id] : candidates) {
+            auto future = actor->add_gc_task(static_cast< uint8_t >(task_priority::normal), chunk_id);
+            if (future.isReady()) {
+                if (future.value()) {
+                    LOGINFOMOD(gcmgr,
+                               "gc task for chunk_id={} on pdev_id={} has been submitted and successfully completed "
+                               "shortly",
+                               chunk_id, pdev_id);
+                } else {
+                    LOGWARNMOD(gcmgr,
+                               "got false after add_gc_task for chunk_id={} on pdev_id={}, it means we cannot mark "
+                               "this chunk to gc state(there is an open shard on this chunk ATM) or this task is "
+                               "executed shortly but fails(fail to copy data or update gc index table) ",
+                               chunk_id, pdev_id);
                 }
+            } else if (0 == --max_task_num) {
+                LOGINFOMOD(gcmgr, "reached max gc task limit for pdev_id={}, stopping further gc task submissions",
+                           pdev_id);
+                break;
             }
         }
     }
@@ -283,6 +406,12 @@ void GCManager::scan_chunks_for_gc() {
 
 /* pdev_gc_actor */
 
+// the adaptive gc rate starts from the static one, or from its lower bound if gc is not throttled statically
+static uint64_t initial_gc_io_rate() {
+    const uint64_t rate = HS_BACKEND_DYNAMIC_CONFIG(max_read_write_block_count_per_second);
+    return rate ? rate : HS_BACKEND_DYNAMIC_CONFIG(gc_adaptive_min_block_count_per_second);
+}
+
 GCManager::pdev_gc_actor::pdev_gc_actor(const homestore::superblk< GCManager::gc_actor_superblk >& gc_actor_sb,
                                         std::shared_ptr< HeapChunkSelector > chunk_selector, HSHomeObject* homeobject) :
         m_pdev_id{gc_actor_sb->pdev_id},
@@ -291,6 +420,9 @@ GCManager::pdev_gc_actor::pdev_gc_actor(const homestore::superblk< GCManager::gc
         m_index_table{homeobject->get_gc_index_table(boost::uuids::to_string(gc_actor_sb->index_table_uuid))},
         m_hs_home_object{homeobject},
         m_enable_read_verify{HS_BACKEND_DYNAMIC_CONFIG(gc_enable_read_verify)},
+        m_gc_rate_controller{initial_gc_io_rate()},
+        m_gc_io_rate{initial_gc_io_rate()},
+        m_copy_buffers{homestore::data_service().get_blk_size()},
         metrics_{*this} {
 
     RELEASE_ASSERT(m_index_table, "index_table for a gc_actor should not be nullptr!!!");
@@ -398,6 +530,24 @@ folly::SemiFuture< bool > GCManager::pdev_gc_actor::add_gc_task(uint8_t priority
     return folly::makeSemiFuture< bool >(false);
 }
 
+void GCManager::pdev_gc_actor::add_triggered_gc_task(chunk_id_t chunk_id, uint32_t max_task_num) {
+    if (m_triggered_gc_task_num.fetch_add(1) >= max_task_num) {
+        m_triggered_gc_task_num.fetch_sub(1);
+        LOGDEBUGMOD(gcmgr, "{} triggered gc tasks are pending on pdev_id={}, leave chunk_id={} to the next scan",
+                    max_task_num, m_pdev_id, chunk_id);
+        return;
+    }
+
+    LOGDEBUGMOD(gcmgr, "trigger gc task for chunk_id={} on pdev_id={}", chunk_id, m_pdev_id);
+    add_gc_task(static_cast< uint8_t >(task_priority::normal), chunk_id)
+        .via(&folly::InlineExecutor::instance())
+        .thenValue([this, chunk_id](bool res) {
+            m_triggered_gc_task_num.fetch_sub(1);
+            LOGDEBUGMOD(gcmgr, "triggered gc task for chunk_id={} on pdev_id={} is done, result={}", chunk_id,
+                        m_pdev_id, res);
+        });
+}
+
 void GCManager::drain_pg_pending_gc_task(const pg_id_t pg_id) {
     while (true) {
         uint64_t pending_gc_task_num{0};
@@ -552,15 +702,21 @@ bool GCManager::pdev_gc_actor::replace_blob_index(
     // we do this sequentially ATM.
 
     // TODO:: optimization, concurrently update pg index table.
-    for (const auto& [k, v] : valid_blob_indexes) {
+
+    // packed small blobs share the new pba and have adjacent entries, the pba is only freed when all of them have
+    // been deleted meanwhile.
+    uint32_t blobs_in_extent{0};
+    uint32_t removed_in_extent{0};
+    for (size_t i = 0; i < valid_blob_indexes.size(); ++i) {
+        const auto& [k, v] = valid_blob_indexes[i];
         const auto& shard = k.key().shard;
         const auto& blob = k.key().blob;
         BlobRouteKey index_key{BlobRoute{shard, blob}};
 
         homestore::BtreeSinglePutRequest update_req{
             &index_key, &v, homestore::btree_put_type::UPDATE, nullptr,
-            [&pg_id, &shard, &blob, &move_from_chunk, &move_to_chunk,
-             &task_id](homestore::BtreeKey const& key, homestore::BtreeValue const& value_in_btree,
+            [&pg_id, &shard, &blob, &move_from_chunk, &move_to_chunk, &task_id,
+             &removed_in_extent](homestore::BtreeKey const& key, homestore::BtreeValue const& value_in_btree,
                        homestore::BtreeValue const& new_value) -> homestore::put_filter_decision {
                 BlobRouteValue existing_value{value_in_btree};
                 BlobRouteValue new_pba_value{new_value};
@@ -572,7 +728,7 @@ bool GCManager::pdev_gc_actor::replace_blob_index(
                            "remove tombstone when updating pg index after data copy blob_id={}, move_from_chunk={}, "
                            "move_to_chunk={}",
                            blob, move_from_chunk, move_to_chunk);
-                    homestore::data_service().async_free_blk(new_pba_value.pbas());
+                    ++removed_in_extent;
                     return homestore::put_filter_decision::remove;
                 }
 
@@ -618,6 +774,14 @@ bool GCManager::pdev_gc_actor::replace_blob_index(
         GCLOGD(task_id, pg_id, shard,
                "successfully update index table, ret={}, move_from_chunk={}, move_to_chunk={}, blob_id={}", ret,
                move_from_chunk, move_to_chunk, blob);
+        m_hs_home_object->invalidate_cached_blob(shard, blob);
+
+        ++blobs_in_extent;
+        if (i + 1 == valid_blob_indexes.size() || valid_blob_indexes[i + 1].second.pbas() != v.pbas()) {
+            if (removed_in_extent == blobs_in_extent) { homestore::data_service().async_free_blk(v.pbas()); }
+            blobs_in_extent = 0;
+            removed_in_extent = 0;
+        }
     }
 
     // TODO:: revisit the following part with the consideration of persisting order for recovery.
@@ -631,13 +795,82 @@ bool GCManager::pdev_gc_actor::replace_blob_index(
     return true;
 }
 
+folly::Future< folly::Unit > GCManager::pdev_gc_actor::throttle_io(uint64_t blk_count, uint8_t priority) {
+    const bool is_emergent = priority == static_cast< uint8_t >(task_priority::emergent);
+    // the rates are read for every io, so a new budget applies at once
+    const auto wait = is_emergent
+        ? m_egc_rate_limiter.acquire(blk_count, HS_BACKEND_DYNAMIC_CONFIG(egc_max_read_write_block_count_per_second))
+        : m_gc_rate_limiter.acquire(blk_count, control_gc_io_rate());
+    if (wait.count() == 0) { return folly::makeFuture(); }
+
+    const auto wait_us = std::chrono::duration_cast< std::chrono::microseconds >(wait).count();
+    if (is_emergent) {
+        COUNTER_INCREMENT(metrics_, egc_throttled_time_us, wait_us);
+    } else {
+        COUNTER_INCREMENT(metrics_, gc_throttled_time_us, wait_us);
+    }
+    // the gc threads are blocked waiting for the copy of a shard, so the delayed io is issued from the global executor
+    return folly::futures::sleep(wait).via(folly::getGlobalCPUExecutor());
+}
+
+uint64_t GCManager::pdev_gc_actor::gc_io_rate() const {
+    if (HS_BACKEND_DYNAMIC_CONFIG(gc_adaptive_rate)) { return m_gc_io_rate.load(std::memory_order_relaxed); }
+    return HS_BACKEND_DYNAMIC_CONFIG(max_read_write_block_count_per_second);
+}
+
+uint64_t GCManager::pdev_gc_actor::control_gc_io_rate() {
+    if (!HS_BACKEND_DYNAMIC_CONFIG(gc_adaptive_rate)) {
+        return HS_BACKEND_DYNAMIC_CONFIG(max_read_write_block_count_per_second);
+    }
+
+    const auto now_ns =
+        std::chrono::duration_cast< std::chrono::nanoseconds >(Clock::now().time_since_epoch()).count();
+    const int64_t interval_ns = HS_BACKEND_DYNAMIC_CONFIG(gc_adaptive_interval_ms) * 1000000ll;
+    auto last_ns = m_last_rate_control_ns.load(std::memory_order_relaxed);
+    if (now_ns - last_ns < interval_ns ||
+        !m_last_rate_control_ns.compare_exchange_strong(last_ns, now_ns, std::memory_order_relaxed)) {
+        return m_gc_io_rate.load(std::memory_order_relaxed);
+    }
+
+    std::unique_lock lg(m_rate_control_mtx, std::try_to_lock);
+    if (!lg.owns_lock()) { return m_gc_io_rate.load(std::memory_order_relaxed); }
+
+    const auto min_rate = HS_BACKEND_DYNAMIC_CONFIG(gc_adaptive_min_block_count_per_second);
+    const RateController::Settings settings{
+        .min_rate = min_rate,
+        .max_rate = std::max< uint64_t >(min_rate, HS_BACKEND_DYNAMIC_CONFIG(gc_adaptive_max_block_count_per_second)),
+        .target_latency_us = HS_BACKEND_DYNAMIC_CONFIG(gc_adaptive_target_latency_us),
+        .step = HS_BACKEND_DYNAMIC_CONFIG(gc_adaptive_step_block_count),
+        .decrease = 0.5,
+        .low_free_ratio = HS_BACKEND_DYNAMIC_CONFIG(gc_adaptive_low_free_pct) / 100.0};
+    const auto client_latency_us = m_client_latency.take_percentile(99.0);
+    const auto free_ratio = pdev_free_ratio();
+    const auto rate = m_gc_rate_controller.update(settings, client_latency_us, free_ratio);
+    if (rate != m_gc_io_rate.exchange(rate, std::memory_order_relaxed)) {
+        LOGDEBUGMOD(gcmgr, "gc io rate of pdev_id={} is set to {}, client p99 latency={}us, free_ratio={:.3f}",
+                    m_pdev_id, rate, client_latency_us, free_ratio);
+    }
+    return rate;
+}
+
+double GCManager::pdev_gc_actor::pdev_free_ratio() {
+    if (m_pdev_chunks.empty()) { m_pdev_chunks = m_chunk_selector->get_pdev_chunks()[m_pdev_id]; }
+    uint64_t total_blks{0};
+    uint64_t available_blks{0};
+    for (const auto chunk_id : m_pdev_chunks) {
+        const auto vchunk = m_chunk_selector->get_extend_vchunk(chunk_id);
+        total_blks += vchunk->get_total_blks();
+        available_blks += vchunk->available_blks();
+    }
+    return total_blks ? static_cast< double >(available_blks) / total_blks : 1.0;
+}
+
 sisl::sg_list GCManager::pdev_gc_actor::generate_shard_super_blk_sg_list(shard_id_t shard_id) {
     // TODO: do the buffer check before using it.
     auto raw_shard_sb = m_hs_home_object->_get_hs_shard(shard_id);
     RELEASE_ASSERT(raw_shard_sb, "can not find shard super blk for shard_id=0x{:x} !!!", shard_id);
 
-    const auto shard_sb =
-        const_cast< HSHomeObject::HS_Shard* >(d_cast< const HSHomeObject::HS_Shard* >(raw_shard_sb))->sb_.get();
+    const auto shard_sb = const_cast< HSHomeObject::HS_Shard* >(raw_shard_sb.get())->sb_.get();
 
     auto blk_size = homestore::data_service().get_blk_size();
     auto shard_sb_size = sizeof(HSHomeObject::shard_info_superblk);
@@ -686,7 +919,9 @@ bool GCManager::pdev_gc_actor::copy_valid_data(
 
     auto& data_service = homestore::data_service();
     const auto last_shard_id = *(shards.rbegin());
-    const auto& shard_info = m_hs_home_object->_get_hs_shard(last_shard_id)->info;
+    const auto last_shard = m_hs_home_object->_get_hs_shard(last_shard_id);
+    RELEASE_ASSERT(last_shard, "can not find shard=0x{:x} in move_from_chunk={}", last_shard_id, move_from_chunk);
+    const auto& shard_info = last_shard->info;
     const auto& last_shard_state = shard_info.state;
 
     // in most cases(put_blob and seal_shard), the last shard in the chunk, which triggers emergent gc, should be in
@@ -709,7 +944,13 @@ bool GCManager::pdev_gc_actor::copy_valid_data(
     auto pg_index_table = m_hs_home_object->get_hs_pg(pg_id)->index_table_;
     const auto blk_size = data_service.get_blk_size();
 
+    // the extents and runs of the shards, which the ios in flight refer to
+    std::list< shard_copy > shard_copies;
+    std::vector< folly::Future< bool > > shard_futs;
+    std::atomic_bool copy_failed{false};
+
     for (const auto& shard_id : shards) {
+        if (copy_failed.load(std::memory_order_relaxed)) { break; }
         bool is_last_shard = (shard_id == last_shard_id);
         std::vector< std::pair< BlobRouteKey, BlobRouteValue > > valid_blob_indexes;
         auto start_key = BlobRouteKey{BlobRoute{shard_id, std::numeric_limits< uint64_t >::min()}};
@@ -763,7 +1004,8 @@ bool GCManager::pdev_gc_actor::copy_valid_data(
         auto const status = pg_index_table->query(query_req, valid_blob_indexes);
         if (status != homestore::btree_status_t::success) {
             GCLOGE(task_id, pg_id, shard_id, "Failed to query blobs in index table for status={}", status);
-            return false;
+            copy_failed.store(true, std::memory_order_relaxed);
+            break;
         }
 
         if (valid_blob_indexes.empty()) {
@@ -778,6 +1020,22 @@ bool GCManager::pdev_gc_actor::copy_valid_data(
                    move_from_chunk);
         }
 
+        // small blobs packed into one extent have adjacent index entries with the same pbas, the extent is copied once
+        // for all of them.
+        std::vector< gc_extent > extents;
+        for (size_t i = 0; i < valid_blob_indexes.size();) {
+            auto& extent = extents.emplace_back(gc_extent{valid_blob_indexes[i].second.pbas(), {}});
+            for (; i < valid_blob_indexes.size() && valid_blob_indexes[i].second.pbas() == extent.pbas; ++i) {
+                extent.blob_ids.emplace_back(valid_blob_indexes[i].first.key().blob);
+            }
+        }
+        auto runs = plan_copy_runs(extents, HS_BACKEND_DYNAMIC_CONFIG(gc_copy_max_io_size) / blk_size,
+                                   HS_BACKEND_DYNAMIC_CONFIG(gc_copy_max_read_gap_size) / blk_size);
+        if (!runs.empty()) {
+            GCLOGD(task_id, pg_id, shard_id, "{} valid extents of move_from_chunk={} are copied with {} reads",
+                   extents.size(), move_from_chunk, runs.size());
+        }
+
         // prepare a shard header for this shard in move_to_chunk
         sisl::sg_list header_sgs = generate_shard_super_blk_sg_list(shard_id);
 
@@ -801,14 +1059,20 @@ bool GCManager::pdev_gc_actor::copy_valid_data(
             */
         }
 #endif
-        // TODO::involve ratelimiter in the following code, where read/write are scheduled. or do we need a central
-        // ratelimter shared by all components except client io?
-        const auto succeed_copying_shard =
-            // 1 write the shard header to move_to_chunk
+        const bool write_footer = !(is_last_shard && last_shard_state == ShardInfo::State::OPEN);
+        auto& copy = shard_copies.emplace_back(shard_copy{std::move(extents), std::move(runs)});
+
+        // the gc thread only issues the ios of this shard, so that they overlap with the ones of the previous shards
+        // still in flight. every read and write takes its blks from the io budget of the task priority first, and
+        // every run waits for a read buffer of this pdev.
+        std::vector< folly::Future< bool > > futs;
+        futs.reserve(copy.runs.size() + 1);
+
+        // 1 write the shard header to move_to_chunk
+        throttle_io(1, priority).get();
+        futs.emplace_back(
             data_service.async_alloc_write(header_sgs, hints, out_blkids)
-                .thenValue([this, &hints, &move_to_chunk, &move_from_chunk, &is_last_shard, &shard_id, &blk_size,
-                            &valid_blob_indexes, &data_service, task_id, &last_shard_state, &copied_blobs, pg_id,
-                            header_sgs = std::move(header_sgs)](auto&& err) {
+                .thenValue([this, &move_to_chunk, shard_id, task_id, pg_id, header_sgs](auto&& err) {
                     RELEASE_ASSERT(header_sgs.iovs.size() == 1, "header_sgs.iovs.size() should be 1, but not!");
                     // shard header occupies one blk
                     COUNTER_INCREMENT(metrics_, gc_write_blk_count, 1);
@@ -818,185 +1082,79 @@ bool GCManager::pdev_gc_actor::copy_valid_data(
                                "Failed to write shard header for move_to_chunk={}, err={}, err_category={}, "
                                "err_message={}",
                                move_to_chunk, err.value(), err.category().name(), err.message());
-                        return folly::makeFuture< bool >(false);
-                    }
-
-                    if (valid_blob_indexes.empty()) {
-                        RELEASE_ASSERT(is_last_shard && last_shard_state == ShardInfo::State::OPEN,
-                                       "find empty shard in move_from_chunk={} "
-                                       "but is_emergent is false, shard_id=0x{:x}, pg_id={}",
-                                       move_from_chunk, shard_id, pg_id);
-                        return folly::makeFuture< bool >(true);
+                        return false;
                     }
+                    return true;
+                }));
+
+        // 2 copy all the valid blobs in the shard from move_from_chunk to move_to_chunk, with one read and one write
+        // for each run of neighbouring extents.
+        for (const auto& run : copy.runs) {
+            if (copy_failed.load(std::memory_order_relaxed)) { break; }
+            throttle_io(run.read_blk_count + run.live_blk_count, priority).get();
+            auto read_buf = m_copy_buffers.acquire(run.read_blk_count * blk_size,
+                                                   priority == static_cast< uint8_t >(task_priority::emergent));
+            futs.emplace_back(copy_extent_run(copy.extents, run, read_buf, move_from_chunk, move_to_chunk, hints,
+                                              shard_id, copied_blobs, task_id, pg_id));
+        }
 
-                    std::vector< folly::Future< bool > > futs;
-
-                    // 2 copy all the valid blobs in the shard from move_from_chunk to move_to_chunk
-                    for (const auto& [k, v] : valid_blob_indexes) {
-                        // k is shard_id + blob_id, v is multiblk id
-                        auto pba = v.pbas();
-                        auto total_size = pba.blk_count() * blk_size;
-
-                        // buffer for read and write data
-                        sisl::sg_list data_sgs;
-                        data_sgs.size = total_size;
-                        data_sgs.iovs.emplace_back(
-                            iovec{.iov_base = iomanager.iobuf_alloc(blk_size, total_size), .iov_len = total_size});
-
-                        futs.emplace_back(std::move(
-                            // read blob from move_from_chunk
-                            data_service.async_read(pba, data_sgs, total_size)
-                                .thenValue([this, k, &hints, &move_from_chunk, &move_to_chunk, &data_service, task_id,
-                                            pg_id, data_sgs = std::move(data_sgs), pba, &copied_blobs](auto&& err) {
-                                    COUNTER_INCREMENT(metrics_, gc_read_blk_count, pba.blk_count());
-                                    RELEASE_ASSERT(data_sgs.iovs.size() == 1,
-                                                   "data_sgs.iovs.size() should be 1, but not!");
-
-                                    const auto shard_id = k.key().shard;
-                                    const auto blob_id = k.key().blob;
-
-                                    if (err) {
-                                        GCLOGE(task_id, pg_id, shard_id,
-                                               "Failed to read blob from move_from_chunk={}, blob_id={}, err={}, "
-                                               "err_category={}, err_message={}",
-                                               move_from_chunk, blob_id, err.value(), err.category().name(),
-                                               err.message());
-                                        iomanager.iobuf_free(reinterpret_cast< uint8_t* >(data_sgs.iovs[0].iov_base));
-                                        return folly::makeFuture< bool >(false);
-                                    }
-
-                                    GCLOGD(task_id, pg_id, shard_id,
-                                           "successfully read blob from move_from_chunk={}, blob_id={}, pba={}",
-                                           move_from_chunk, blob_id, pba.to_string());
-
-                                    if (m_enable_read_verify) {
-                                        // after a blob is deleted at originator, if it receives a fetch_data request of
-                                        // this blob, a fake delete_marker blob will be returned to the requester. This
-                                        // case happens in incremental resync scenario. when verifying blob, if it is a
-                                        // delete_marker, we let it pass the verification in gc scenario so that it will
-                                        // not block any gc task.
-                                        if (!m_hs_home_object->verify_blob(data_sgs.iovs[0].iov_base, shard_id, blob_id,
-                                                                           true)) {
-                                            GCLOGE(task_id, pg_id, shard_id,
-                                                   "blob verification fails for move_from_chunk={}, blob_id={}, pba={}",
-                                                   move_from_chunk, blob_id, pba.to_string());
-                                            iomanager.iobuf_free(
-                                                reinterpret_cast< uint8_t* >(data_sgs.iovs[0].iov_base));
-                                            return folly::makeFuture< bool >(false);
-                                        }
-                                    }
-
-                                    // write the blob to the move_to_chunk. we do not care about the blob order in a
-                                    // shard since we can not guarantee a certain order
-                                    homestore::MultiBlkId new_pba;
-                                    return data_service.async_alloc_write(data_sgs, hints, new_pba)
-                                        .thenValue([this, shard_id, blob_id, new_pba, &move_to_chunk, task_id, pg_id,
-                                                    &copied_blobs, data_sgs = std::move(data_sgs)](auto&& err) {
-                                            COUNTER_INCREMENT(metrics_, gc_write_blk_count, new_pba.blk_count());
-                                            RELEASE_ASSERT(data_sgs.iovs.size() == 1,
-                                                           "data_sgs.iovs.size() should be 1, but not!");
-                                            iomanager.iobuf_free(
-                                                reinterpret_cast< uint8_t* >(data_sgs.iovs[0].iov_base));
-                                            if (err) {
-                                                GCLOGE(task_id, pg_id, shard_id,
-                                                       "Failed to write blob to move_to_chunk={}, blob_id={}, err={}, "
-                                                       "err_category={}, err_message={}",
-                                                       move_to_chunk, blob_id, err.value(), err.category().name(),
-                                                       err.message());
-                                                return false;
-                                            }
-
-                                            // insert a new entry to gc index table for this blob. [move_to_chunk_id,
-                                            // shard_id, blob_id] -> [new pba]
-                                            BlobRouteByChunkKey key{BlobRouteByChunk{move_to_chunk, shard_id, blob_id}};
-                                            BlobRouteValue value{new_pba}, existing_value;
-
-                                            homestore::BtreeSinglePutRequest put_req{
-                                                &key, &value, homestore::btree_put_type::INSERT, &existing_value};
-                                            auto status = m_index_table->put(put_req);
-                                            if (status != homestore::btree_status_t::success) {
-                                                GCLOGE(task_id, pg_id, shard_id,
-                                                       "Failed to insert new key to gc index table for "
-                                                       "move_to_chunk={}, blob_id={}, err={}",
-                                                       move_to_chunk, blob_id, status);
-                                                return false;
-                                            }
-
-                                            GCLOGD(task_id, pg_id, shard_id,
-                                                   "successfully insert new key to gc index table for "
-                                                   "move_to_chunk={}, blob_id={}, new_pba={}",
-                                                   move_to_chunk, blob_id, new_pba.to_string());
-
-                                            BlobRouteByChunk route_key{move_to_chunk, shard_id, blob_id};
-                                            auto ret = copied_blobs.insert(route_key, value);
-                                            RELEASE_ASSERT(ret.second,
-                                                           "we should not copy the same blob twice in gc task, "
-                                                           "move_to_chunk={}, shard_id=0x{:x}, pg_id={}, blob_id={}",
-                                                           move_to_chunk, shard_id, pg_id, blob_id);
-
-                                            return true;
-                                        });
-                                })));
+        // 3 write a shard footer for this shard once all its blobs are copied
+        shard_futs.emplace_back(
+            folly::collectAllUnsafe(futs).thenValue([this, write_footer, shard_id, &hints, &move_to_chunk,
+                                                     &data_service, &copy_failed, task_id, pg_id,
+                                                     priority](auto&& results) {
+                // if any blob copy fails, we will not write footer, and drop this gc task
+                for (auto const& ok : results) {
+                    RELEASE_ASSERT(ok.hasValue(), "we never throw any exception when copying data");
+                    if (!ok.value()) {
+                        GCLOGE(task_id, pg_id, shard_id,
+                               "Failed to copy blob for move_to_chunk={}, will cancel this task", move_to_chunk);
+                        copy_failed.store(true, std::memory_order_relaxed);
+                        return folly::makeFuture< bool >(false);
                     }
+                }
 
-                    // 3 write a shard footer for this shard
-                    sisl::sg_list footer_sgs = generate_shard_super_blk_sg_list(shard_id);
-                    return folly::collectAllUnsafe(futs)
-                        .thenValue([this, &is_last_shard, &shard_id, &blk_size, &hints, &move_to_chunk, pg_id,
-                                    &last_shard_state, task_id, &data_service, footer_sgs](auto&& results) {
-                            // if any blob copy fails, we will not write footer, and drop this gc task
-                            for (auto const& ok : results) {
-                                RELEASE_ASSERT(ok.hasValue(), "we never throw any exception when copying data");
-                                if (!ok.value()) {
-                                    GCLOGE(task_id, pg_id, shard_id,
-                                           "Failed to copy blob for move_to_chunk={}, will cancel this task",
-                                           move_to_chunk);
-                                    // if any op fails, we drop this gc task.
-                                    return folly::makeFuture< std::error_code >(
-                                        std::make_error_code(std::errc::operation_canceled));
-                                }
-                            }
+                // we skip writing footer only if the last shard of this chunk is in open state.
+                if (!write_footer) {
+                    GCLOGD(task_id, pg_id, shard_id,
+                           "skip writing the footer for move_to_chunk={} for emergent gc task", move_to_chunk);
+                    return folly::makeFuture< bool >(true);
+                }
 
-                            // we skip writing footer only if the last shard of this chunk is in open state.
-                            if (is_last_shard && last_shard_state == ShardInfo::State::OPEN) {
-                                GCLOGD(task_id, pg_id, shard_id,
-                                       "skip writing the footer for move_to_chunk={} for emergent gc task",
-                                       move_to_chunk);
-                                return folly::makeFuture< std::error_code >(std::error_code{});
-                            }
+                // write shard footer, which occupies one blk
+                COUNTER_INCREMENT(metrics_, gc_write_blk_count, 1);
+                sisl::sg_list footer_sgs = generate_shard_super_blk_sg_list(shard_id);
+                return throttle_io(1, priority)
+                    .thenValue([&data_service, &hints, footer_sgs](auto&&) {
+                        homestore::MultiBlkId out_blkids;
+                        return data_service.async_alloc_write(footer_sgs, hints, out_blkids);
+                    })
+                    .thenValue([&move_to_chunk, &copy_failed, shard_id, footer_sgs, task_id, pg_id](auto&& err) {
+                        RELEASE_ASSERT(footer_sgs.iovs.size() == 1, "footer_sgs.iovs.size() should be 1, but not!");
+                        iomanager.iobuf_free(reinterpret_cast< uint8_t* >(footer_sgs.iovs[0].iov_base));
+                        if (err) {
+                            GCLOGE(task_id, pg_id, shard_id,
+                                   "Failed to write shard footer for move_to_chunk={}, err={}, error_category={}, "
+                                   "error_message={}",
+                                   move_to_chunk, err.value(), err.category().name(), err.message());
+                            copy_failed.store(true, std::memory_order_relaxed);
+                            return false;
+                        }
+                        return true;
+                    });
+            }));
+    }
 
-                            // write shard footer, which occupies one blk
-                            homestore::MultiBlkId out_blkids;
-                            COUNTER_INCREMENT(metrics_, gc_write_blk_count, 1);
-                            return data_service.async_alloc_write(footer_sgs, hints, out_blkids);
-                        })
-                        .thenValue([this, &move_to_chunk, &shard_id, footer_sgs, task_id, pg_id](auto&& err) {
-                            RELEASE_ASSERT(footer_sgs.iovs.size() == 1, "footer_sgs.iovs.size() should be 1, but not!");
-                            iomanager.iobuf_free(reinterpret_cast< uint8_t* >(footer_sgs.iovs[0].iov_base));
-
-                            if (err) {
-                                // we will come here if:
-                                //  1 any blob copy fails, then err is operation_canceled
-                                //  2 write footer fails， then err is the error code of write footer
-                                GCLOGE(task_id, pg_id, shard_id,
-                                       "Failed to copy some blos or failed to write shard footer for move_to_chunk={}, "
-                                       "err={}, error_category={}, error_message={}, pls check the log for more "
-                                       "detailed info",
-                                       move_to_chunk, err.value(), err.category().name(), err.message());
-                                return false;
-                            }
-                            return true;
-                        });
-                })
-                .get();
-
-        if (!succeed_copying_shard) {
-            GCLOGE(task_id, pg_id, shard_id, "Failed to copy all blobs from move_from_chunk={} to move_to_chunk={}",
-                   move_from_chunk, move_to_chunk);
-            return false;
-        }
-        GCLOGD(task_id, pg_id, shard_id, "successfully copy blobs from move_from_chunk={} to move_to_chunk={}",
+    // the ios in flight refer to the stack of this function, wait for all of them even if some fail
+    bool succeed_copying{!copy_failed.load(std::memory_order_relaxed)};
+    for (auto const& ok : folly::collectAllUnsafe(shard_futs).get()) {
+        RELEASE_ASSERT(ok.hasValue(), "we never throw any exception when copying data");
+        if (!ok.value()) { succeed_copying = false; }
+    }
+    if (!succeed_copying) {
+        GCLOGE(task_id, pg_id, NO_SHARD_ID, "Failed to copy all blobs from move_from_chunk={} to move_to_chunk={}",
                move_from_chunk, move_to_chunk);
+        return false;
     }
     GCLOGD(task_id, pg_id, NO_SHARD_ID, "all valid blobs are copied from move_from_chunk={} to move_to_chunk={}",
            move_from_chunk, move_to_chunk);
@@ -1056,6 +1214,162 @@ bool GCManager::pdev_gc_actor::copy_valid_data(
     return true;
 }
 
+std::vector< GCManager::pdev_gc_actor::gc_copy_run >
+GCManager::pdev_gc_actor::plan_copy_runs(std::vector< gc_extent >& extents, uint32_t max_io_blks,
+                                         uint32_t max_gap_blks) {
+    std::sort(extents.begin(), extents.end(),
+              [](const auto& l, const auto& r) { return l.pbas.blk_num() < r.pbas.blk_num(); });
+    max_io_blks = std::min< uint32_t >(max_io_blks, std::numeric_limits< homestore::blk_count_t >::max());
+
+    std::vector< gc_copy_run > runs;
+    for (size_t i = 0; i < extents.size(); ++i) {
+        const auto blk_num = extents[i].pbas.blk_num();
+        const uint32_t blk_count = extents[i].pbas.blk_count();
+        if (!runs.empty()) {
+            auto& run = runs.back();
+            const auto run_end = run.blk_num + run.read_blk_count;
+            if (blk_num >= run_end && blk_num - run_end <= max_gap_blks &&
+                blk_num + blk_count - run.blk_num <= max_io_blks) {
+                run.read_blk_count = blk_num + blk_count - run.blk_num;
+                run.live_blk_count += blk_count;
+                run.extent_end = i + 1;
+                continue;
+            }
+        }
+        runs.emplace_back(gc_copy_run{blk_num, blk_count, blk_count, i, i + 1});
+    }
+    return runs;
+}
+
+folly::Future< bool > GCManager::pdev_gc_actor::copy_extent_run(
+    std::vector< gc_extent > const& extents, gc_copy_run const& run, CopyBufferPool::Buffer read_buf,
+    chunk_id_t move_from_chunk, chunk_id_t move_to_chunk, homestore::blk_alloc_hints const& hints, shard_id_t shard_id,
+    folly::ConcurrentHashMap< BlobRouteByChunk, BlobRouteValue >& copied_blobs, const uint64_t task_id,
+    const pg_id_t pg_id) {
+    auto& data_service = homestore::data_service();
+    const auto blk_size = data_service.get_blk_size();
+    const auto read_size = run.read_blk_count * blk_size;
+    RELEASE_ASSERT(read_buf.capacity >= read_size, "read buffer of {} bytes is too small for a run of {} bytes",
+                   read_buf.capacity, read_size);
+
+    sisl::sg_list read_sgs;
+    read_sgs.size = read_size;
+    read_sgs.iovs.emplace_back(iovec{.iov_base = read_buf.bytes, .iov_len = read_size});
+    homestore::MultiBlkId read_pba;
+    read_pba.add(run.blk_num, s_cast< homestore::blk_count_t >(run.read_blk_count), move_from_chunk);
+
+    return data_service.async_read(read_pba, read_sgs, read_size)
+        .thenValue([this, &extents, run, read_buf, read_pba, blk_size, &hints, move_from_chunk, move_to_chunk,
+                    shard_id, &copied_blobs, task_id, pg_id, &data_service](auto&& err) {
+            COUNTER_INCREMENT(metrics_, gc_read_blk_count, run.read_blk_count);
+            if (err) {
+                GCLOGE(task_id, pg_id, shard_id,
+                       "Failed to read from move_from_chunk={}, pba={}, extents={}, err={}, err_category={}, "
+                       "err_message={}",
+                       move_from_chunk, read_pba.to_string(), run.extent_end - run.extent_begin, err.value(),
+                       err.category().name(), err.message());
+                m_copy_buffers.release(read_buf);
+                return folly::makeFuture< bool >(false);
+            }
+
+            GCLOGD(task_id, pg_id, shard_id, "successfully read from move_from_chunk={}, pba={}, extents={}",
+                   move_from_chunk, read_pba.to_string(), run.extent_end - run.extent_begin);
+
+            // the garbage between the extents is dropped, only the extents are written to move_to_chunk in their
+            // order in move_from_chunk.
+            sisl::sg_list write_sgs;
+            write_sgs.size = run.live_blk_count * blk_size;
+            for (auto i = run.extent_begin; i < run.extent_end; ++i) {
+                const auto& pba = extents[i].pbas;
+                auto const extent = read_buf.bytes + (pba.blk_num() - run.blk_num) * blk_size;
+                const auto total_size = pba.blk_count() * blk_size;
+
+                if (m_enable_read_verify) {
+                    // after a blob is deleted at originator, if it receives a fetch_data request of this blob, a fake
+                    // delete_marker blob will be returned to the requester. This case happens in incremental resync
+                    // scenario. when verifying blob, if it is a delete_marker, we let it pass the verification in gc
+                    // scenario so that it will not block any gc task.
+                    for (const auto id : extents[i].blob_ids) {
+                        auto const record = HSHomeObject::locate_blob_record(extent, total_size, id);
+                        if (!m_hs_home_object->verify_blob(extent + record, shard_id, id, true)) {
+                            GCLOGE(task_id, pg_id, shard_id,
+                                   "blob verification fails for move_from_chunk={}, blob_id={}, pba={}",
+                                   move_from_chunk, id, pba.to_string());
+                            m_copy_buffers.release(read_buf);
+                            return folly::makeFuture< bool >(false);
+                        }
+                    }
+                }
+                write_sgs.iovs.emplace_back(iovec{.iov_base = extent, .iov_len = total_size});
+            }
+
+            // we do not care about the blob order in a shard since we can not guarantee a certain order
+            homestore::MultiBlkId new_pba;
+            return data_service.async_alloc_write(write_sgs, hints, new_pba)
+                .thenValue([this, &extents, run, read_buf, new_pba, move_to_chunk, shard_id, &copied_blobs, task_id,
+                            pg_id, write_sgs = std::move(write_sgs)](auto&& err) {
+                    COUNTER_INCREMENT(metrics_, gc_write_blk_count, run.live_blk_count);
+                    m_copy_buffers.release(read_buf);
+                    if (err) {
+                        GCLOGE(task_id, pg_id, shard_id,
+                               "Failed to write to move_to_chunk={}, extents={}, err={}, err_category={}, "
+                               "err_message={}",
+                               move_to_chunk, run.extent_end - run.extent_begin, err.value(), err.category().name(),
+                               err.message());
+                        return false;
+                    }
+
+                    // move_to_chunk is written by the append blk allocator, so the run is always written to one
+                    // piece and the new pba of an extent is its offset in it.
+                    if (new_pba.num_pieces() != 1) {
+                        GCLOGE(task_id, pg_id, shard_id,
+                               "expect one piece for a run written to move_to_chunk={}, but new_pba={}", move_to_chunk,
+                               new_pba.to_string());
+                        return false;
+                    }
+
+                    // insert a new entry to gc index table for each blob in the run.
+                    // [move_to_chunk_id, shard_id, blob_id] -> [new pba]
+                    homestore::blk_num_t blk_offset{0};
+                    for (auto i = run.extent_begin; i < run.extent_end; ++i) {
+                        const auto blk_count = extents[i].pbas.blk_count();
+                        homestore::MultiBlkId extent_pba;
+                        extent_pba.add(new_pba.blk_num() + blk_offset, blk_count, new_pba.chunk_num());
+                        blk_offset += blk_count;
+
+                        BlobRouteValue value{extent_pba};
+                        for (const auto id : extents[i].blob_ids) {
+                            BlobRouteByChunkKey key{BlobRouteByChunk{move_to_chunk, shard_id, id}};
+                            BlobRouteValue existing_value;
+                            homestore::BtreeSinglePutRequest put_req{&key, &value, homestore::btree_put_type::INSERT,
+                                                                     &existing_value};
+                            auto status = m_index_table->put(put_req);
+                            if (status != homestore::btree_status_t::success) {
+                                GCLOGE(task_id, pg_id, shard_id,
+                                       "Failed to insert new key to gc index table for move_to_chunk={}, blob_id={}, "
+                                       "err={}",
+                                       move_to_chunk, id, status);
+                                return false;
+                            }
+
+                            GCLOGD(task_id, pg_id, shard_id,
+                                   "successfully insert new key to gc index table for move_to_chunk={}, blob_id={}, "
+                                   "new_pba={}",
+                                   move_to_chunk, id, extent_pba.to_string());
+
+                            BlobRouteByChunk route_key{move_to_chunk, shard_id, id};
+                            auto ret = copied_blobs.insert(route_key, value);
+                            RELEASE_ASSERT(ret.second,
+                                           "we should not copy the same blob twice in gc task, move_to_chunk={}, "
+                                           "shard_id=0x{:x}, pg_id={}, blob_id={}",
+                                           move_to_chunk, shard_id, pg_id, id);
+                        }
+                    }
+                    return true;
+                });
+        });
+}
+
 bool GCManager::pdev_gc_actor::purge_reserved_chunk(chunk_id_t chunk, const uint64_t task_id, const pg_id_t pg_id) {
     auto vchunk = m_chunk_selector->get_extend_vchunk(chunk);
     RELEASE_ASSERT(!vchunk->m_pg_id.has_value(),
@@ -1374,6 +1688,11 @@ bool GCManager::pdev_gc_actor::process_after_gc_metablk_persisted(
 
     m_chunk_selector->update_vchunk_info_after_gc(move_from_chunk, move_to_chunk, final_state, pg_id, vchunk_id,
                                                   task_id);
+    // move_from_chunk is a reserved chunk now. the only garbage of move_to_chunk is the blobs deleted during the copy,
+    // which are freed already
+    m_chunk_garbage.set(move_from_chunk, 0, 0);
+    m_chunk_garbage.set(move_to_chunk, m_chunk_selector->get_extend_vchunk(move_to_chunk)->get_defrag_nblks(),
+                        m_chunk_selector->get_extend_vchunk(move_to_chunk)->get_total_blks());
     GCLOGD(
         task_id, pg_id, NO_SHARD_ID,
         "vchunk_id={} has been update from move_from_chunk={} to move_to_chunk={}, {} blks are reclaimed, final state "
@@ -1399,28 +1718,194 @@ GCManager::pdev_gc_actor::~pdev_gc_actor() {
 }
 
 /* RateLimiter */
-GCManager::RateLimiter::RateLimiter(uint64_t refill_count_per_second) :
-        tokens_(refill_count_per_second), refillRate_(refill_count_per_second) {
-    lastRefillTime_ = std::chrono::steady_clock::now();
+GCManager::RateLimiter::RateLimiter(std::chrono::nanoseconds burst) : m_burst_ns{burst.count()} {}
+
+std::chrono::nanoseconds GCManager::RateLimiter::acquire(uint64_t count, uint64_t rate,
+                                                         std::chrono::steady_clock::time_point now) {
+    if (rate == 0) { return std::chrono::nanoseconds{0}; }
+    const auto now_ns = std::chrono::duration_cast< std::chrono::nanoseconds >(now.time_since_epoch()).count();
+    const auto cost_ns = static_cast< int64_t >(count * 1000000000ull / rate);
+
+    // the tokens are ours from start_ns on, which is never earlier than the burst credit allows
+    auto empty_at_ns = m_empty_at_ns.load(std::memory_order_relaxed);
+    int64_t start_ns;
+    do {
+        start_ns = std::max(empty_at_ns, now_ns - m_burst_ns);
+    } while (!m_empty_at_ns.compare_exchange_weak(empty_at_ns, start_ns + cost_ns, std::memory_order_relaxed));
+
+    return std::chrono::nanoseconds{std::max< int64_t >(start_ns - now_ns, 0)};
 }
 
-bool GCManager::RateLimiter::allowRequest(uint64_t count) {
-    std::lock_guard lock(mutex_);
-    refillTokens();
-    if (tokens_ >= count) {
-        tokens_ -= count;
-        return true;
+/* CopyBufferPool */
+GCManager::CopyBufferPool::~CopyBufferPool() {
+    RELEASE_ASSERT(m_in_use == 0, "{} gc read buffers are still in use", m_in_use);
+    for (auto const& buf : m_free) {
+        iomanager.iobuf_free(buf.bytes);
     }
-    return false;
 }
 
-void GCManager::RateLimiter::refillTokens() {
-    auto now = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast< std::chrono::seconds >(now - lastRefillTime_).count();
-    if (duration) {
-        tokens_ = refillRate_;
-        lastRefillTime_ = now;
+GCManager::CopyBufferPool::Buffer GCManager::CopyBufferPool::acquire(uint64_t size, bool emergent) {
+    std::unique_lock lg(m_mtx);
+    auto const can_issue = [this, emergent] {
+        const auto depth = std::max< uint32_t >(HS_BACKEND_DYNAMIC_CONFIG(gc_copy_queue_depth), 1);
+        const uint32_t reserved_for_egc = (emergent || depth == 1) ? 0 : 1;
+        return m_in_use + reserved_for_egc < depth;
+    };
+    while (!m_cv.wait_for(lg, depth_recheck_interval, can_issue)) {}
+    ++m_in_use;
+    auto it = std::find_if(m_free.begin(), m_free.end(), [size](auto const& buf) { return buf.capacity >= size; });
+    if (it != m_free.end()) {
+        auto buf = *it;
+        m_free.erase(it);
+        return buf;
     }
+    lg.unlock();
+
+    const auto capacity = std::max< uint64_t >(size, HS_BACKEND_DYNAMIC_CONFIG(gc_copy_max_io_size));
+    return Buffer{iomanager.iobuf_alloc(m_align, capacity), capacity};
+}
+
+void GCManager::CopyBufferPool::release(Buffer buf) {
+    std::vector< Buffer > idle;
+    {
+        std::lock_guard lg(m_mtx);
+        --m_in_use;
+        if (m_in_use == 0) {
+            // gc of the pdev is idle, do not hold up to gc_copy_queue_depth large buffers until its next task
+            idle.swap(m_free);
+        } else if (m_free.size() + m_in_use < HS_BACKEND_DYNAMIC_CONFIG(gc_copy_queue_depth)) {
+            // keep at most one buffer per slot for reuse
+            m_free.push_back(buf);
+            buf.bytes = nullptr;
+        }
+    }
+    m_cv.notify_all();
+    if (buf.bytes) { iomanager.iobuf_free(buf.bytes); }
+    for (auto const& free_buf : idle) {
+        iomanager.iobuf_free(free_buf.bytes);
+    }
+}
+
+uint32_t GCManager::CopyBufferPool::in_use() const {
+    std::lock_guard lg(m_mtx);
+    return m_in_use;
+}
+
+/* RateController */
+uint64_t GCManager::RateController::update(Settings const& settings, uint64_t client_latency_us, double free_ratio) {
+    if (client_latency_us > settings.target_latency_us) {
+        m_rate = static_cast< uint64_t >(m_rate * settings.decrease);
+    } else {
+        m_rate += settings.step;
+    }
+
+    // the floor rises from min_rate to max_rate as the free space of the pdev drops from low_free_ratio to 0
+    auto floor = settings.min_rate;
+    if (free_ratio < settings.low_free_ratio) {
+        floor += static_cast< uint64_t >((settings.max_rate - settings.min_rate) *
+                                         (1.0 - std::max(free_ratio, 0.0) / settings.low_free_ratio));
+    }
+    m_rate = std::clamp(m_rate, floor, settings.max_rate);
+    return m_rate;
+}
+
+/* LatencyWindow */
+size_t GCManager::LatencyWindow::bucket_of(uint64_t latency_us) {
+    if (latency_us < 4) { return latency_us; }
+    // 4 buckets per power of two, picked by the 2 bits after the most significant one
+    const size_t msb = std::bit_width(latency_us) - 1;
+    return std::min(msb * 4 + ((latency_us >> (msb - 2)) & 3) - 4, num_buckets - 1);
+}
+
+uint64_t GCManager::LatencyWindow::bucket_upper_bound(size_t bucket) {
+    if (bucket < 4) { return bucket; }
+    const size_t shift = bucket / 4 - 1;
+    return ((4 + bucket % 4 + 1) << shift) - 1;
+}
+
+void GCManager::LatencyWindow::record(uint64_t latency_us) {
+    m_buckets[bucket_of(latency_us)].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t GCManager::LatencyWindow::take_percentile(double percentile) {
+    std::array< uint64_t, num_buckets > counts;
+    uint64_t total{0};
+    for (size_t i = 0; i < num_buckets; ++i) {
+        counts[i] = m_buckets[i].exchange(0, std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (!total) { return 0; }
+
+    const auto rank = static_cast< uint64_t >(std::ceil(total * percentile / 100.0));
+    uint64_t seen{0};
+    for (size_t i = 0; i < num_buckets; ++i) {
+        seen += counts[i];
+        if (seen >= rank) { return bucket_upper_bound(i); }
+    }
+    return bucket_upper_bound(num_buckets - 1);
+}
+
+double GCManager::ChunkGarbageIndex::ratio_of(chunk_garbage const& garbage) {
+    return garbage.total_blks ? static_cast< double >(garbage.garbage_blks) / garbage.total_blks : 0;
+}
+
+bool GCManager::ChunkGarbageIndex::add(chunk_id_t chunk_id, uint64_t blks, uint64_t total_blks,
+                                       uint8_t threshold_pct) {
+    if (!blks) { return false; }
+    std::scoped_lock lock(m_mtx);
+    chunk_garbage garbage{0, total_blks};
+    if (auto const old = m_heap.find(chunk_id); old) { garbage.garbage_blks = old->garbage_blks; }
+    const bool was_over = 100 * garbage.garbage_blks > total_blks * threshold_pct;
+    garbage.garbage_blks += blks;
+    m_heap.push(chunk_id, ratio_of(garbage), garbage);
+    return !was_over && 100 * garbage.garbage_blks > total_blks * threshold_pct;
+}
+
+void GCManager::ChunkGarbageIndex::set(chunk_id_t chunk_id, uint64_t blks, uint64_t total_blks) {
+    std::scoped_lock lock(m_mtx);
+    if (!blks) {
+        m_heap.erase(chunk_id);
+        return;
+    }
+    chunk_garbage garbage{blks, total_blks};
+    m_heap.push(chunk_id, ratio_of(garbage), garbage);
+}
+
+uint64_t GCManager::ChunkGarbageIndex::garbage_blks(chunk_id_t chunk_id) const {
+    std::scoped_lock lock(m_mtx);
+    auto const garbage = m_heap.find(chunk_id);
+    return garbage ? garbage->garbage_blks : 0;
+}
+
+void GCManager::ChunkGarbageIndex::raise(chunk_id_t chunk_id, uint64_t blks, uint64_t total_blks) {
+    if (!blks) { return; }
+    std::scoped_lock lock(m_mtx);
+    auto const old = m_heap.find(chunk_id);
+    if (old && old->garbage_blks >= blks) { return; }
+    chunk_garbage garbage{blks, total_blks};
+    m_heap.push(chunk_id, ratio_of(garbage), garbage);
+}
+
+std::vector< chunk_id_t > GCManager::ChunkGarbageIndex::over_threshold(uint8_t threshold_pct) {
+    std::vector< std::pair< chunk_id_t, chunk_garbage > > popped;
+    std::scoped_lock lock(m_mtx);
+    while (!m_heap.empty() && 100 * m_heap.top().garbage_blks > m_heap.top().total_blks * threshold_pct) {
+        popped.emplace_back(m_heap.top_id(), m_heap.top());
+        m_heap.pop();
+    }
+
+    std::vector< chunk_id_t > chunks;
+    chunks.reserve(popped.size());
+    for (auto const& [chunk_id, garbage] : popped) {
+        chunks.push_back(chunk_id);
+        m_heap.push(chunk_id, ratio_of(garbage), garbage);
+    }
+    return chunks;
+}
+
+size_t GCManager::ChunkGarbageIndex::size() const {
+    std::scoped_lock lock(m_mtx);
+    return m_heap.size();
 }
 
 } // namespace homeobject
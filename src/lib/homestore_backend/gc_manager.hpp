@@ -1,4 +1,11 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <list>
+#include <mutex>
 #include <string>
 
 #pragma GCC diagnostic push
@@ -30,6 +37,7 @@ namespace homeobject {
 class HSHomeObject;
 
 ENUM(task_priority, uint8_t, emergent = 0, normal, priority_count);
+ENUM(gc_victim_policy, uint8_t, greedy = 0, cost_benefit);
 
 using chunk_id_t = homestore::chunk_num_t;
 using GCBlobIndexTable = homestore::IndexTable< BlobRouteByChunkKey, BlobRouteValue >;
@@ -80,27 +88,133 @@ public:
 #pragma pack()
 
 public:
-    // TODO: refine the rate limiter, currently it is a simple token bucket implementation.
+    // A lock free token bucket refilled continuously at the rate given to each acquire, so a new rate takes effect at
+    // once. The bucket is kept as the time at which it is empty again, a caller reserves its tokens with one CAS and is
+    // told how long to wait for them instead of being rejected. Idle time is credited up to burst.
     class RateLimiter {
-        // TODO::make ratelimiter perceptive to client io, so gc can take more io resource if the io traffic from cline
-        // is not heavy.this is an optimization.
     public:
-        // refillRate means how many tokens can be refilled per second
-        RateLimiter(uint64_t refill_count_per_second);
+        explicit RateLimiter(std::chrono::nanoseconds burst = std::chrono::milliseconds(1));
         ~RateLimiter() = default;
         // Disallow copy and move
+        RateLimiter(const RateLimiter&) = delete;
         RateLimiter(RateLimiter&&) = delete;
+        RateLimiter& operator=(const RateLimiter&) = delete;
         RateLimiter& operator=(RateLimiter&&) = delete;
 
     public:
-        bool allowRequest(uint64_t count);
+        // take count tokens refilled at rate tokens per second, 0 means unlimited. return how long the caller should
+        // wait before using them.
+        std::chrono::nanoseconds acquire(uint64_t count, uint64_t rate,
+                                         std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
 
     private:
-        void refillTokens();
-        uint64_t tokens_;
-        uint64_t refillRate_; // tokens per second
-        std::chrono::steady_clock::time_point lastRefillTime_;
-        std::mutex mutex_;
+        const int64_t m_burst_ns;
+        std::atomic< int64_t > m_empty_at_ns{std::numeric_limits< int64_t >::min()};
+    };
+
+    // The read buffers of the gc copy runs of a pdev, shared by all its gc tasks. It bounds the runs in flight to
+    // gc_copy_queue_depth and keeps their buffers for reuse while any run is in flight, they are freed once gc on the
+    // pdev is idle. Normal gc leaves the last slot to emergent gc, so that emergent gc does not wait behind a
+    // throttled normal gc.
+    class CopyBufferPool {
+    public:
+        struct Buffer {
+            uint8_t* bytes{nullptr};
+            uint64_t capacity{0};
+        };
+
+        explicit CopyBufferPool(uint32_t align) : m_align{align} {}
+        ~CopyBufferPool();
+        // Disallow copy and move
+        CopyBufferPool(const CopyBufferPool&) = delete;
+        CopyBufferPool(CopyBufferPool&&) = delete;
+        CopyBufferPool& operator=(const CopyBufferPool&) = delete;
+        CopyBufferPool& operator=(CopyBufferPool&&) = delete;
+
+    public:
+        // blocks until a run can be issued, the buffer has at least size bytes
+        Buffer acquire(uint64_t size, bool emergent);
+        void release(Buffer buf);
+        uint32_t in_use() const;
+
+    private:
+        // gc_copy_queue_depth is hotswap, a waiting acquire picks up a raised depth after at most this long
+        static constexpr std::chrono::milliseconds depth_recheck_interval{100};
+
+        const uint32_t m_align;
+        mutable std::mutex m_mtx;
+        std::condition_variable m_cv;
+        std::vector< Buffer > m_free;
+        uint32_t m_in_use{0};
+    };
+
+    // An AIMD controller of the io rate of normal gc on a pdev. Every control interval it adds step to the rate while
+    // the client tail latency on the pdev is within the target or there was no client io, and multiplies it by
+    // decrease otherwise. Below low_free_ratio of free space the floor of the rate rises towards max_rate, so that
+    // gc is not starved while the pdev runs out of space. Emergent gc has a budget of its own. Not thread safe.
+    class RateController {
+    public:
+        struct Settings {
+            uint64_t min_rate;
+            uint64_t max_rate;
+            uint64_t target_latency_us;
+            uint64_t step;
+            double decrease;
+            double low_free_ratio;
+        };
+
+        explicit RateController(uint64_t rate) : m_rate{rate} {}
+
+        // client_latency_us is the tail latency of the client ios in the last interval, 0 if there was none.
+        // free_ratio is the free blks of the pdev over its total blks. returns the new rate.
+        uint64_t update(Settings const& settings, uint64_t client_latency_us, double free_ratio);
+        uint64_t rate() const { return m_rate; }
+
+    private:
+        uint64_t m_rate;
+    };
+
+    // A histogram of the client io latencies of a pdev with 4 buckets per power of two, recorded lock free and taken
+    // by the rate controller every interval.
+    class LatencyWindow {
+    public:
+        void record(uint64_t latency_us);
+        // the upper bound of the percentile bucket of the latencies recorded since the last take, 0 if there is none.
+        // the window is empty afterwards.
+        uint64_t take_percentile(double percentile);
+
+    private:
+        static constexpr size_t num_buckets = 128;
+        static size_t bucket_of(uint64_t latency_us);
+        static uint64_t bucket_upper_bound(size_t bucket);
+        std::array< std::atomic< uint64_t >, num_buckets > m_buckets{};
+    };
+
+    // The garbage blks of the chunks of a pdev, counted as the blks of deleted blobs are freed instead of scanned, and
+    // ranked by their garbage ratio, so that each chunk over the gc threshold is found in O(log n). The live blks of a
+    // chunk are its used blks minus its garbage. Only chunks with garbage are kept.
+    class ChunkGarbageIndex {
+    public:
+        // add blks to the garbage of the chunk. return true if this takes it over threshold_pct of total_blks.
+        bool add(chunk_id_t chunk_id, uint64_t blks, uint64_t total_blks, uint8_t threshold_pct);
+        // set the garbage of the chunk, 0 drops it
+        void set(chunk_id_t chunk_id, uint64_t blks, uint64_t total_blks);
+        // raise the garbage of the chunk to blks if it has less
+        void raise(chunk_id_t chunk_id, uint64_t blks, uint64_t total_blks);
+        uint64_t garbage_blks(chunk_id_t chunk_id) const;
+        // the chunks over threshold_pct garbage, the highest ratio first
+        std::vector< chunk_id_t > over_threshold(uint8_t threshold_pct);
+        size_t size() const;
+
+    private:
+        struct chunk_garbage {
+            uint64_t garbage_blks;
+            uint64_t total_blks;
+        };
+        static double ratio_of(chunk_garbage const& garbage);
+
+        mutable std::mutex m_mtx;
+        IndexedHeap< chunk_id_t, double, chunk_garbage > m_heap;
     };
 
 public:
@@ -134,6 +248,10 @@ public:
                 REGISTER_GAUGE(total_reclaimed_space_by_egc, "Total reclaimed space by emergent gc task");
                 REGISTER_COUNTER(gc_read_blk_count, "Total read blk count by gc in this pdev");
                 REGISTER_COUNTER(gc_write_blk_count, "Total written blk count by gc in this pdev");
+                REGISTER_COUNTER(gc_throttled_time_us, "Total time gc ios in this pdev are delayed by the ratelimiter");
+                REGISTER_COUNTER(egc_throttled_time_us,
+                                 "Total time emergent gc ios in this pdev are delayed by the rate limiter");
+                REGISTER_GAUGE(gc_io_rate, "Read/write blk count per second gc can take in this pdev, 0 is unlimited");
 
                 // gc task level histogram metrics
                 REGISTER_HISTOGRAM(
@@ -177,6 +295,7 @@ public:
                     *this, total_reclaimed_space_by_egc,
                     gc_actor_.durable_entities().total_reclaimed_blk_count_by_egc.load(std::memory_order_relaxed) *
                         blk_size_);
+                GAUGE_UPDATE(*this, gc_io_rate, gc_actor_.gc_io_rate());
             }
 
         private:
@@ -211,6 +330,40 @@ public:
         void stop();
         uint32_t get_pdev_id() const { return m_pdev_id; }
 
+        // the latency of a client put or get served by this pdev, which drives the adaptive gc io rate
+        void record_client_io_latency(uint64_t latency_us) { m_client_latency.record(latency_us); }
+        // the current read/write blk count per second budget of normal gc, 0 is unlimited
+        uint64_t gc_io_rate() const;
+
+        ChunkGarbageIndex& chunk_garbage() { return m_chunk_garbage; }
+        // add a normal gc task for a chunk which just went over the gc threshold, unless max_task_num of them are
+        // still pending on this pdev
+        void add_triggered_gc_task(chunk_id_t chunk_id, uint32_t max_task_num);
+
+    public:
+        // a valid extent of a shard in move_from_chunk, shared by all the small blobs packed into it
+        struct gc_extent {
+            homestore::MultiBlkId pbas;
+            std::vector< blob_id_t > blob_ids;
+        };
+
+        // the extents [extent_begin, extent_end) of a shard which are copied with one read and one write. the read
+        // covers read_blk_count blks from blk_num including the garbage between the extents, the write only takes the
+        // live_blk_count blks of the extents.
+        struct gc_copy_run {
+            homestore::blk_num_t blk_num{0};
+            uint32_t read_blk_count{0};
+            uint32_t live_blk_count{0};
+            size_t extent_begin{0};
+            size_t extent_end{0};
+        };
+
+        // sort the extents by their offset in the chunk and merge neighbours into runs of at most max_io_blks blks,
+        // skipping at most max_gap_blks garbage blks between two extents. an extent larger than max_io_blks is still
+        // copied in one run.
+        static std::vector< gc_copy_run > plan_copy_runs(std::vector< gc_extent >& extents, uint32_t max_io_blks,
+                                                         uint32_t max_gap_blks);
+
     private:
         void process_gc_task(chunk_id_t move_from_chunk, uint8_t priority, folly::Promise< bool > task,
                              const uint64_t task_id);
@@ -230,6 +383,21 @@ public:
                              folly::ConcurrentHashMap< BlobRouteByChunk, BlobRouteValue >& copied_blobs,
                              const uint8_t priority, const uint64_t task_id);
 
+        // the extents of a shard to copy and the runs they are copied with
+        struct shard_copy {
+            std::vector< gc_extent > extents;
+            std::vector< gc_copy_run > runs;
+        };
+
+        // copy the extents of a run with one read from move_from_chunk into read_buf and one write to move_to_chunk.
+        // the new pba of each extent is its offset in the written blks. read_buf is released to the pool when done.
+        folly::Future< bool >
+        copy_extent_run(std::vector< gc_extent > const& extents, gc_copy_run const& run,
+                        CopyBufferPool::Buffer read_buf, chunk_id_t move_from_chunk, chunk_id_t move_to_chunk,
+                        homestore::blk_alloc_hints const& hints, shard_id_t shard_id,
+                        folly::ConcurrentHashMap< BlobRouteByChunk, BlobRouteValue >& copied_blobs,
+                        const uint64_t task_id, const pg_id_t pg_id);
+
         // before we select a reserved chunk and start gc, we need:
         //  1 clear all the entries of this chunk in the gc index table
         //  2 reset this chunk to make sure it is empty.
@@ -261,6 +429,17 @@ public:
         // utils
         sisl::sg_list generate_shard_super_blk_sg_list(shard_id_t shard_id);
 
+        // reserve blk_count blks of the io budget of the priority, the returned future completes when the io can be
+        // issued.
+        folly::Future< folly::Unit > throttle_io(uint64_t blk_count, uint8_t priority);
+
+        // the io rate of normal gc, run the rate controller first if gc_adaptive_rate is set and the control interval
+        // has passed
+        uint64_t control_gc_io_rate();
+
+        // free blks over total blks of all the chunks of this pdev
+        double pdev_free_ratio();
+
     private:
         uint32_t m_pdev_id;
         std::shared_ptr< HeapChunkSelector > m_chunk_selector;
@@ -271,8 +450,24 @@ public:
 
         // limit the io resource that gc thread can take, so that it will not impact the client io.
         // assuming the throughput of a HDD is 300M/s(including read and write) and gc can take 10% of the io resource,
-        // which is 30M/s. A block is 4K, so gc can read/write 30M/s / 4K = 7680 blocks per second.
-        RateLimiter m_rate_limiter{HS_BACKEND_DYNAMIC_CONFIG(max_read_write_block_count_per_second)};
+        // which is 30M/s. A block is 4K, so gc can read/write 30M/s / 4K = 7680 blocks per second. It is unlimited by
+        // default, as gc was before the limit was enforced. emergent gc blocks client puts, so it has a budget of its
+        // own.
+        RateLimiter m_gc_rate_limiter;
+        RateLimiter m_egc_rate_limiter;
+
+        // with gc_adaptive_rate, the gc io rate follows the client latency on this pdev and its free space
+        LatencyWindow m_client_latency;
+        std::mutex m_rate_control_mtx;
+        RateController m_gc_rate_controller; // protected by m_rate_control_mtx
+        std::vector< chunk_id_t > m_pdev_chunks; // protected by m_rate_control_mtx
+        std::atomic< uint64_t > m_gc_io_rate;
+        std::atomic< int64_t > m_last_rate_control_ns{0};
+
+        // bounds the copy runs in flight of all the gc tasks of this pdev
+        CopyBufferPool m_copy_buffers;
+        ChunkGarbageIndex m_chunk_garbage;
+        std::atomic< uint32_t > m_triggered_gc_task_num{0};
 
         std::shared_ptr< folly::IOThreadPoolExecutor > m_gc_executor;
         std::shared_ptr< folly::IOThreadPoolExecutor > m_egc_executor;
@@ -308,6 +503,17 @@ public:
 
     bool is_eligible_for_gc(chunk_id_t chunk_id);
 
+    /**
+     * the cost-benefit score of reclaiming a chunk, as in LFS: the free space gained times how long it is likely to
+     * stay free, over the cost of reading the chunk and writing back its live data.
+     * @param garbage_blks blks of the chunk which are not referenced any more
+     * @param live_blks blks of the chunk which have to be copied
+     * @param age_sec seconds since the data of the chunk was last written
+     *
+     * @return garbage * age / (2 * live), infinity if there is no live data to copy
+     */
+    static double cost_benefit_score(uint64_t garbage_blks, uint64_t live_blks, uint64_t age_sec);
+
     void handle_all_recovered_gc_tasks();
 
     void start();
@@ -325,11 +531,35 @@ public:
     auto& get_gc_actor_superblks() { return m_gc_actor_sbs; }
     std::shared_ptr< pdev_gc_actor > get_pdev_gc_actor(uint32_t pdev_id);
 
+    // the latency of a client put or get of a blob in the chunk, fed to the gc actor of its pdev
+    void record_client_io_latency(chunk_id_t chunk_id, uint64_t latency_us);
+
+    // the blks of a deleted blob were freed from the chunk. with gc_trigger_on_garbage, a gc task is added as soon as
+    // this takes the chunk over gc_garbage_rate_threshold.
+    void add_chunk_garbage(chunk_id_t chunk_id, uint64_t blks);
+    // the chunk is no longer taken by an open shard, with gc_trigger_on_garbage it is gc-ed if it is over the threshold
+    void on_chunk_released(chunk_id_t chunk_id);
+    // forget the garbage of an emptied chunk, or set it to what homestore knows of it
+    void reset_chunk_garbage(chunk_id_t chunk_id, uint64_t blks = 0);
+    // the counted garbage blks of the chunk, or the ones known by homestore if they are more
+    uint64_t get_chunk_garbage_blks(chunk_id_t chunk_id) const;
+    // raise the garbage index of every chunk of the pdev to the blks homestore knows as freed. these also cover the
+    // frees which are not counted one by one, e.g. by a baseline resync or by gc itself.
+    void reconcile_chunk_garbage(uint32_t pdev_id, std::vector< chunk_id_t > const& chunks);
+
 private:
     void on_gc_task_meta_blk_found(sisl::byte_view const& buf, void* meta_cookie);
     void on_gc_actor_meta_blk_found(sisl::byte_view const& buf, void* meta_cookie);
     void on_reserved_chunk_meta_blk_found(sisl::byte_view const& buf, void* meta_cookie);
 
+    // the gc actor of the pdev of the chunk, nullptr if there is none
+    std::shared_ptr< pdev_gc_actor > get_chunk_gc_actor(chunk_id_t chunk_id) const;
+    // called from commit threads, so only the config is checked inline and the rest runs on the global executor
+    void trigger_gc_task(std::shared_ptr< pdev_gc_actor > actor, chunk_id_t chunk_id);
+
+    // seconds since the last shard of the chunk was modified, which is when it was sealed or moved here by gc
+    uint64_t chunk_age_sec(chunk_id_t chunk_id, uint64_t now_ms) const;
+
 private:
     std::shared_ptr< HeapChunkSelector > m_chunk_selector;
     folly::ConcurrentHashMap< uint32_t, std::shared_ptr< pdev_gc_actor > > m_pdev_gc_actors;
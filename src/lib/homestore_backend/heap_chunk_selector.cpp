@@ -2,6 +2,10 @@
 
 #include <execution>
 #include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <set>
 #include <utility>
 
 #include <sisl/logging/logging.h>
@@ -18,7 +22,14 @@ namespace homeobject {
 
 // this should only be called when initializing HeapChunkSelector in Homestore
 void HeapChunkSelector::add_chunk(csharedChunk& chunk) {
-    m_chunks.emplace(VChunk(chunk).get_chunk_id(), std::make_shared< ExtendedVChunk >(chunk));
+    auto const& vchunk =
+        m_chunks.emplace(VChunk(chunk).get_chunk_id(), std::make_shared< ExtendedVChunk >(chunk)).first->second;
+    // the pdevs are known from the start, so that a chunk can be locked by its pdev before the heaps are built
+    auto const pdev_id = vchunk->get_pdev_id();
+    if (!m_per_dev_heap.contains(pdev_id)) {
+        m_per_dev_heap.emplace(pdev_id, std::make_shared< ChunkHeap >())
+            .first->second->pdev_name = vchunk->get_pdev_name();
+    }
 }
 
 void HeapChunkSelector::add_chunk_internal(const chunk_num_t p_chunk_id, bool add_to_heap) {
@@ -37,13 +48,38 @@ void HeapChunkSelector::add_chunk_internal(const chunk_num_t p_chunk_id, bool ad
     it->second->m_total_blks += chunk->get_total_blks();
 
     if (add_to_heap) {
-        std::lock_guard< std::mutex > l(it->second->mtx);
+        mutex_lock l(it->second->mtx, LockLevel::pdev);
         auto& heap = it->second->m_heap;
-        heap.emplace(chunk);
+        heap.push(p_chunk_id, chunk->available_blks(), chunk);
         it->second->available_blk_count += chunk->available_blks();
     }
 }
 
+void HeapChunkSelector::set_chunk_state(const std::shared_ptr< ExtendedVChunk >& chunk, const ChunkState state) {
+    if ((chunk->m_state == ChunkState::INUSE) != (state == ChunkState::INUSE)) {
+        if (auto it = m_per_dev_heap.find(chunk->get_pdev_id()); it != m_per_dev_heap.end()) {
+            if (state == ChunkState::INUSE) {
+                ++it->second->num_open_chunks;
+            } else {
+                --it->second->num_open_chunks;
+            }
+        }
+    }
+    chunk->m_state = state;
+
+    if (!chunk->m_pg_id.has_value() || !chunk->m_v_chunk_id.has_value()) { return; }
+    auto pg_it = m_per_pg_chunks.find(chunk->m_pg_id.value());
+    if (pg_it == m_per_pg_chunks.end()) { return; }
+    // an available chunk is (re)added with its current available blks, e.g. less after it was written when released,
+    // or more after it was gc-ed.
+    auto& available_chunks = pg_it->second->m_available_chunks;
+    if (state == ChunkState::AVAILABLE) {
+        available_chunks[chunk->get_pdev_id()].push(chunk->m_v_chunk_id.value(), chunk->available_blks(), chunk);
+    } else if (auto it = available_chunks.find(chunk->get_pdev_id()); it != available_chunks.end()) {
+        it->second.erase(chunk->m_v_chunk_id.value());
+    }
+}
+
 // select_chunk will only be called in homestore when creating a shard.
 csharedChunk HeapChunkSelector::select_chunk(homestore::blk_count_t count, const homestore::blk_alloc_hints& hint) {
     auto& chunkIdHint = hint.chunk_id_hint;
@@ -68,14 +104,17 @@ csharedChunk HeapChunkSelector::select_chunk(homestore::blk_count_t count, const
 }
 
 bool HeapChunkSelector::try_mark_chunk_to_gc_state(const chunk_num_t chunk_id, bool force) {
-    std::unique_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto chunk_it = m_chunks.find(chunk_id);
     if (chunk_it == m_chunks.end()) {
         LOGWARNMOD(homeobject, "No chunk found for chunk_id={}", chunk_id);
         return false;
     }
 
-    auto& chunk_state = chunk_it->second->m_state;
+    // m_pg_id only changes with m_chunk_selector_mtx held exclusively, so the owner of the chunk is stable here
+    auto [owner_mtx, owner_level] = chunk_owner_mtx(*chunk_it->second);
+    mutex_lock owner_lock(owner_mtx, owner_level);
+    auto const chunk_state = chunk_it->second->m_state;
 
     if (chunk_state == ChunkState::GC) {
         LOGWARNMOD(homeobject, "gc: chunk is already in gc state, chunk_id={}", chunk_id);
@@ -87,69 +126,113 @@ bool HeapChunkSelector::try_mark_chunk_to_gc_state(const chunk_num_t chunk_id, b
         return false;
     }
 
-    chunk_state = ChunkState::GC;
+    set_chunk_state(chunk_it->second, ChunkState::GC);
     return true;
 }
 
 void HeapChunkSelector::mark_chunk_out_of_gc_state(const chunk_num_t chunk_id, const ChunkState final_state,
                                                    const uint64_t task_id) {
-    std::unique_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto chunk_it = m_chunks.find(chunk_id);
     RELEASE_ASSERT(chunk_it != m_chunks.end(), "chunk_id={} should be in m_chunks, but not found", chunk_id);
 
-    auto& chunk_state = chunk_it->second->m_state;
+    auto [owner_mtx, owner_level] = chunk_owner_mtx(*chunk_it->second);
+    mutex_lock owner_lock(owner_mtx, owner_level);
+    auto const chunk_state = chunk_it->second->m_state;
     RELEASE_ASSERT(chunk_state == ChunkState::GC, "chunk_id={} should be in gc state, but in {} state", chunk_id,
                    chunk_state);
 
-    chunk_state = final_state;
+    set_chunk_state(chunk_it->second, final_state);
     LOGDEBUGMOD(homeobject, "gc task_id={}, chunk_id={} is marked out of gc state, final_state={}", task_id, chunk_id,
                 final_state);
+
+    // e.g. a failed gc task, the chunk still backs its vchunk
+    auto const& vchunk = chunk_it->second;
+    if (!vchunk->m_pg_id.has_value() || !vchunk->m_v_chunk_id.has_value()) { return; }
+    auto waiters = take_gc_waiters(vchunk->m_pg_id.value(), vchunk->m_v_chunk_id.value());
+    owner_lock.unlock();
+    lock_guard.unlock();
+    for (auto& waiter : waiters) {
+        waiter.setValue();
+    }
 }
 
 csharedChunk HeapChunkSelector::select_specific_chunk(const pg_id_t pg_id, const chunk_num_t v_chunk_id) {
-    homestore::shared< ExtendedVChunk > chunk;
-
     while (true) {
+        std::optional< folly::SemiFuture< folly::Unit > > gc_done;
         {
-            std::unique_lock lock_guard(m_chunk_selector_mtx);
-            auto pg_it = m_per_pg_chunks.find(pg_id);
-            if (pg_it == m_per_pg_chunks.end()) {
-                LOGWARNMOD(homeobject, "No pg found for pg={}", pg_id);
-                return nullptr;
-            }
+            selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
+            auto chunk = select_specific_chunk_locked(pg_id, v_chunk_id, gc_done);
+            if (!gc_done) { return chunk; }
+        }
+        // the chunk is being gc, wait until the gc task moves the vchunk out of gc state and retry
+        std::move(*gc_done).getTry();
+    }
+}
 
-            auto pg_chunk_collection = pg_it->second;
-            auto& pg_chunks = pg_chunk_collection->m_pg_chunks;
-            std::scoped_lock lock(pg_chunk_collection->mtx);
-            if (v_chunk_id >= pg_chunks.size()) {
-                LOGWARNMOD(homeobject, "No chunk found for v_chunk_id={}", v_chunk_id);
-                return nullptr;
-            }
+folly::SemiFuture< csharedChunk > HeapChunkSelector::select_specific_chunk_async(const pg_id_t pg_id,
+                                                                                 const chunk_num_t v_chunk_id) {
+    std::optional< folly::SemiFuture< folly::Unit > > gc_done;
+    csharedChunk chunk;
+    {
+        selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
+        chunk = select_specific_chunk_locked(pg_id, v_chunk_id, gc_done);
+    }
+    if (!gc_done) { return folly::makeSemiFuture(std::move(chunk)); }
+    return std::move(*gc_done).deferValue(
+        [this, pg_id, v_chunk_id](auto&&) { return select_specific_chunk_async(pg_id, v_chunk_id); });
+}
 
-            chunk = pg_chunks[v_chunk_id];
+csharedChunk HeapChunkSelector::select_specific_chunk_locked(
+    const pg_id_t pg_id, const chunk_num_t v_chunk_id, std::optional< folly::SemiFuture< folly::Unit > >& gc_done) {
+    auto pg_it = m_per_pg_chunks.find(pg_id);
+    if (pg_it == m_per_pg_chunks.end()) {
+        LOGWARNMOD(homeobject, "No pg found for pg={}", pg_id);
+        return nullptr;
+    }
 
-            if (chunk->m_state == ChunkState::GC) {
-                LOGDEBUGMOD(homeobject, "v_chunk_id={} for pg={} is pchunk_id={}, in GC state, wait and retry!",
-                            v_chunk_id, pg_id, chunk->get_chunk_id());
-            } else {
-                if (chunk->m_state == ChunkState::AVAILABLE) {
-                    chunk->m_state = ChunkState::INUSE;
-                    --pg_chunk_collection->available_num_chunks;
-                    pg_chunk_collection->available_blk_count -= chunk->available_blks();
-                }
-                break;
-            }
-        }
+    auto pg_chunk_collection = pg_it->second;
+    auto& pg_chunks = pg_chunk_collection->m_pg_chunks;
+    mutex_lock lock(pg_chunk_collection->mtx, LockLevel::pg);
+    if (v_chunk_id >= pg_chunks.size()) {
+        LOGWARNMOD(homeobject, "No chunk found for v_chunk_id={}", v_chunk_id);
+        return nullptr;
+    }
 
-        // if the chunk is not available, probably being gc. we wait for a while and retry
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto chunk = pg_chunks[v_chunk_id];
+    if (chunk->m_state == ChunkState::GC) {
+        LOGDEBUGMOD(homeobject, "v_chunk_id={} for pg={} is pchunk_id={}, in GC state, wait for the gc task!",
+                    v_chunk_id, pg_id, chunk->get_chunk_id());
+        // registered under the pg lock, which the gc task holds while moving the vchunk out of gc state
+        mutex_lock waiters_lock(m_gc_waiters_mtx, LockLevel::gc_waiters);
+        auto& waiters = m_gc_waiters[(uint32_t(pg_id) << 16) | v_chunk_id];
+        gc_done = waiters.emplace_back().getSemiFuture();
+        return nullptr;
     }
 
-    LOGDEBUGMOD(homeobject, "chunk={} is selected for v_chunk_id={}, pg={}", chunk->get_chunk_id(), v_chunk_id, pg_id);
+    if (chunk->m_state == ChunkState::AVAILABLE) {
+        set_chunk_state(chunk, ChunkState::INUSE);
+        --pg_chunk_collection->available_num_chunks;
+        pg_chunk_collection->available_blk_count -= chunk->available_blks();
+    }
 
+    LOGDEBUGMOD(homeobject, "chunk={} is selected for v_chunk_id={}, pg={}", chunk->get_chunk_id(), v_chunk_id, pg_id);
     return chunk->get_internal_chunk();
 }
 
+std::vector< folly::Promise< folly::Unit > >
+HeapChunkSelector::take_gc_waiters(const pg_id_t pg_id, const std::optional< chunk_num_t > v_chunk_id) {
+    mutex_lock waiters_lock(m_gc_waiters_mtx, LockLevel::gc_waiters);
+    std::vector< folly::Promise< folly::Unit > > waiters;
+    auto const first = (uint32_t(pg_id) << 16) | v_chunk_id.value_or(0);
+    auto const last = (uint32_t(pg_id) << 16) | v_chunk_id.value_or(std::numeric_limits< chunk_num_t >::max());
+    for (auto it = m_gc_waiters.lower_bound(first); it != m_gc_waiters.end() && it->first <= last;) {
+        std::move(it->second.begin(), it->second.end(), std::back_inserter(waiters));
+        it = m_gc_waiters.erase(it);
+    }
+    return waiters;
+}
+
 void HeapChunkSelector::foreach_chunks(std::function< void(csharedChunk&) >&& cb) {
     // we should call `cb` on all the chunks, selected or not
     std::for_each(std::execution::par_unseq, m_chunks.begin(), m_chunks.end(),
@@ -157,7 +240,7 @@ void HeapChunkSelector::foreach_chunks(std::function< void(csharedChunk&) >&& cb
 }
 
 bool HeapChunkSelector::release_chunk(const pg_id_t pg_id, const chunk_num_t v_chunk_id) {
-    std::unique_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto pg_it = m_per_pg_chunks.find(pg_id);
     if (pg_it == m_per_pg_chunks.end()) {
         LOGWARNMOD(homeobject, "No pg found for pg={}", pg_id);
@@ -170,10 +253,10 @@ bool HeapChunkSelector::release_chunk(const pg_id_t pg_id, const chunk_num_t v_c
         LOGWARNMOD(homeobject, "No chunk found for v_chunk_id={}", v_chunk_id);
         return false;
     }
-    std::scoped_lock lock(pg_chunk_collection->mtx);
+    mutex_lock lock(pg_chunk_collection->mtx, LockLevel::pg);
     auto chunk = pg_chunks[v_chunk_id];
     if (chunk->m_state == ChunkState::INUSE) {
-        chunk->m_state = ChunkState::AVAILABLE;
+        set_chunk_state(chunk, ChunkState::AVAILABLE);
         ++pg_chunk_collection->available_num_chunks;
         pg_chunk_collection->available_blk_count += chunk->available_blks();
     }
@@ -181,7 +264,7 @@ bool HeapChunkSelector::release_chunk(const pg_id_t pg_id, const chunk_num_t v_c
 }
 
 bool HeapChunkSelector::reset_pg_chunks(pg_id_t pg_id) {
-    std::unique_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto pg_it = m_per_pg_chunks.find(pg_id);
     if (pg_it == m_per_pg_chunks.end()) {
         LOGWARNMOD(homeobject, "No pg found for pg={}", pg_id);
@@ -189,7 +272,7 @@ bool HeapChunkSelector::reset_pg_chunks(pg_id_t pg_id) {
     }
     {
         auto pg_chunk_collection = pg_it->second;
-        std::scoped_lock lock(pg_chunk_collection->mtx);
+        mutex_lock lock(pg_chunk_collection->mtx, LockLevel::pg);
         for (auto& chunk : pg_chunk_collection->m_pg_chunks) {
             LOGDEBUGMOD(homeobject, "reset chunk={} in pg={} for destruction", chunk->get_chunk_id(), pg_id);
             chunk->reset();
@@ -199,7 +282,7 @@ bool HeapChunkSelector::reset_pg_chunks(pg_id_t pg_id) {
 }
 
 bool HeapChunkSelector::return_pg_chunks_to_dev_heap(const pg_id_t pg_id) {
-    std::unique_lock lock_guard(m_chunk_selector_mtx);
+    selector_unique_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto pg_it = m_per_pg_chunks.find(pg_id);
     if (pg_it == m_per_pg_chunks.end()) {
         LOGWARNMOD(homeobject, "No pg found for pg={}", pg_id);
@@ -207,25 +290,34 @@ bool HeapChunkSelector::return_pg_chunks_to_dev_heap(const pg_id_t pg_id) {
     }
 
     auto pg_chunk_collection = pg_it->second;
-    auto pdev_id = pg_chunk_collection->m_pg_chunks[0]->get_pdev_id();
-    auto pdev_it = m_per_dev_heap.find(pdev_id);
-    RELEASE_ASSERT(pdev_it != m_per_dev_heap.end(), "pdev_id={} should in per dev heap", pdev_id);
-    auto pdev_heap = pdev_it->second;
-
     {
-        std::scoped_lock lock(pdev_heap->mtx, pg_chunk_collection->mtx);
+        mutex_lock lock(pg_chunk_collection->mtx, LockLevel::pg);
         for (auto& chunk : pg_chunk_collection->m_pg_chunks) {
+            // the chunks of a striped pg go back to different pdevs
+            auto pdev_id = chunk->get_pdev_id();
+            auto pdev_it = m_per_dev_heap.find(pdev_id);
+            RELEASE_ASSERT(pdev_it != m_per_dev_heap.end(), "pdev_id={} should in per dev heap", pdev_id);
+            auto pdev_heap = pdev_it->second;
+
             if (chunk->m_state == ChunkState::INUSE) {
-                chunk->m_state = ChunkState::AVAILABLE;
+                set_chunk_state(chunk, ChunkState::AVAILABLE);
             } // with shard which should be first
             chunk->m_pg_id = std::nullopt;
             chunk->m_v_chunk_id = std::nullopt;
 
-            pdev_heap->m_heap.emplace(chunk);
+            mutex_lock heap_lock(pdev_heap->mtx, LockLevel::pdev);
+            pdev_heap->m_heap.push(chunk->get_chunk_id(), chunk->available_blks(), chunk);
             pdev_heap->available_blk_count += chunk->available_blks();
         }
     }
     m_per_pg_chunks.erase(pg_it);
+
+    // selections still waiting for a chunk of the pg find it gone
+    auto waiters = take_gc_waiters(pg_id, std::nullopt);
+    lock_guard.unlock();
+    for (auto& waiter : waiters) {
+        waiter.setValue();
+    }
     return true;
 }
 
@@ -236,7 +328,7 @@ uint32_t HeapChunkSelector::get_chunk_size() const {
 
 homestore::cshared< HeapChunkSelector::ExtendedVChunk >
 HeapChunkSelector::get_pg_vchunk(const pg_id_t pg_id, const chunk_num_t v_chunk_id) const {
-    std::shared_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto pg_it = m_per_pg_chunks.find(pg_id);
     if (pg_it == m_per_pg_chunks.end()) {
         LOGWARNMOD(homeobject, "No pg found for pg={}", pg_id);
@@ -249,7 +341,7 @@ HeapChunkSelector::get_pg_vchunk(const pg_id_t pg_id, const chunk_num_t v_chunk_
         LOGWARNMOD(homeobject, "No chunk found for v_chunk_id={}", v_chunk_id);
         return nullptr;
     }
-    std::scoped_lock lock(pg_chunk_collection->mtx);
+    mutex_lock lock(pg_chunk_collection->mtx, LockLevel::pg);
     return pg_chunks[v_chunk_id];
 }
 
@@ -259,8 +351,8 @@ bool HeapChunkSelector::is_chunk_available(const pg_id_t pg_id, const chunk_num_
     return false;
 }
 
-std::optional< uint32_t > HeapChunkSelector::select_chunks_for_pg(pg_id_t pg_id, uint64_t pg_size) {
-    std::unique_lock lock_guard(m_chunk_selector_mtx);
+std::optional< uint32_t > HeapChunkSelector::select_chunks_for_pg(pg_id_t pg_id, uint64_t pg_size, bool stripe) {
+    selector_unique_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     const auto chunk_size = get_chunk_size();
     if (pg_size < chunk_size) {
         LOGWARNMOD(homeobject, "pg_size={} is less than chunk_size={}", pg_size, chunk_size);
@@ -275,28 +367,63 @@ std::optional< uint32_t > HeapChunkSelector::select_chunks_for_pg(pg_id_t pg_id,
         return num_chunk;
     }
 
-    // Select a pdev with the most available num chunk
-    auto most_avail_dev_it = std::max_element(m_per_dev_heap.begin(), m_per_dev_heap.end(),
-                                              [](const std::pair< const uint32_t, std::shared_ptr< ChunkHeap > >& lhs,
-                                                 const std::pair< const uint32_t, std::shared_ptr< ChunkHeap > >& rhs) {
-                                                  return lhs.second->size() < rhs.second->size();
-                                              });
-    auto& pdev_heap = most_avail_dev_it->second;
-    if (num_chunk > pdev_heap->size()) {
-        LOGWARNMOD(homeobject, "Pdev has no enough space to create pg={} with num_chunk={}, available_num_chunk={}",
-                   pg_id, num_chunk, pdev_heap->size());
-        return std::nullopt;
+    // the pdev heap each v_chunk is taken from
+    std::vector< std::shared_ptr< ChunkHeap > > pdev_heaps;
+    pdev_heaps.reserve(num_chunk);
+    if (stripe) {
+        // take every chunk from the pdev with the most chunks left, so that pdevs with as many free chunks take turns
+        // and the others contribute in proportion to their free chunks. Ties go to the lowest pdev id.
+        std::map< uint32_t, uint32_t > pdev_free_chunks;
+        uint64_t total_free_chunks{0};
+        for (auto const& [pdev_id, pdev_heap] : m_per_dev_heap) {
+            pdev_free_chunks.emplace(pdev_id, pdev_heap->size());
+            total_free_chunks += pdev_heap->size();
+        }
+        if (num_chunk > total_free_chunks) {
+            LOGWARNMOD(homeobject, "No enough space to create pg={} with num_chunk={}, available_num_chunk={}", pg_id,
+                       num_chunk, total_free_chunks);
+            return std::nullopt;
+        }
+        std::set< uint32_t > striped_pdevs;
+        for (uint32_t i = 0; i < num_chunk; ++i) {
+            auto it = std::max_element(pdev_free_chunks.begin(), pdev_free_chunks.end(),
+                                       [](auto const& lhs, auto const& rhs) { return lhs.second < rhs.second; });
+            --it->second;
+            striped_pdevs.insert(it->first);
+            pdev_heaps.emplace_back(m_per_dev_heap[it->first]);
+        }
+        LOGINFOMOD(homeobject, "stripe pg_id={} over num_pdevs={}, num_chunk={}", pg_id, striped_pdevs.size(),
+                   num_chunk);
+    } else {
+        // Select a pdev with the most available num chunk
+        auto most_avail_dev_it =
+            std::max_element(m_per_dev_heap.begin(), m_per_dev_heap.end(),
+                             [](const std::pair< const uint32_t, std::shared_ptr< ChunkHeap > >& lhs,
+                                const std::pair< const uint32_t, std::shared_ptr< ChunkHeap > >& rhs) {
+                                 return lhs.second->size() < rhs.second->size();
+                             });
+        auto& pdev_heap = most_avail_dev_it->second;
+        if (num_chunk > pdev_heap->size()) {
+            LOGWARNMOD(homeobject,
+                       "Pdev has no enough space to create pg={} with num_chunk={}, available_num_chunk={}", pg_id,
+                       num_chunk, pdev_heap->size());
+            return std::nullopt;
+        }
+        LOGINFOMOD(homeobject, "select pdev[id={}, name={}] for pg_id={}, num_chunk={}", most_avail_dev_it->first,
+                   most_avail_dev_it->second->pdev_name, pg_id, num_chunk);
+        pdev_heaps.assign(num_chunk, pdev_heap);
     }
-    LOGINFOMOD(homeobject, "select pdev[id={}, name={}] for pg_id={}, num_chunk={}", most_avail_dev_it->first,
-               most_avail_dev_it->second->pdev_name, pg_id, num_chunk);
+
     auto pg_it = m_per_pg_chunks.emplace(pg_id, std::make_shared< PGChunkCollection >()).first;
     auto pg_chunk_collection = pg_it->second;
     auto& pg_chunks = pg_chunk_collection->m_pg_chunks;
-    std::scoped_lock lock(pdev_heap->mtx, pg_chunk_collection->mtx);
+    mutex_lock lock(pg_chunk_collection->mtx, LockLevel::pg);
     pg_chunks.reserve(num_chunk);
 
     // v_chunk_id start from 0.
     for (chunk_num_t v_chunk_id = 0; v_chunk_id < num_chunk; ++v_chunk_id) {
+        auto& pdev_heap = pdev_heaps[v_chunk_id];
+        mutex_lock heap_lock(pdev_heap->mtx, LockLevel::pdev);
         auto chunk = pdev_heap->m_heap.top();
         // sanity check
         RELEASE_ASSERT(chunk->get_total_blks() == chunk->available_blks(), "chunk should be empty");
@@ -307,6 +434,7 @@ std::optional< uint32_t > HeapChunkSelector::select_chunks_for_pg(pg_id_t pg_id,
         chunk->m_pg_id = pg_id;
         chunk->m_v_chunk_id = v_chunk_id;
         pg_chunks.emplace_back(chunk);
+        pg_chunk_collection->m_available_chunks[chunk->get_pdev_id()].push(v_chunk_id, chunk->available_blks(), chunk);
         ++pg_chunk_collection->available_num_chunks;
         pg_chunk_collection->m_total_blks += chunk->get_total_blks();
         pg_chunk_collection->available_blk_count += chunk->available_blks();
@@ -319,7 +447,7 @@ void HeapChunkSelector::update_vchunk_info_after_gc(const chunk_num_t move_from_
                                                     const ChunkState final_state, const pg_id_t pg_id,
                                                     const chunk_num_t vchunk_id, const uint64_t task_id) {
 
-    std::unique_lock lock_guard(m_chunk_selector_mtx);
+    selector_unique_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
 
     // if the state of move_to_chunk is updated to inuse or available, then it might be selected for gc immediately. if
     // we change the state of move_to_chunk before gc_task_sb is destroyed, when crash recovery and redo the gc task,
@@ -348,11 +476,18 @@ void HeapChunkSelector::update_vchunk_info_after_gc(const chunk_num_t move_from_
     // this after reserved_chunk meta blk is updated, so that if crash happens, we recovery the move_to_chunk is the
     // same as that before crash. here, the same means not new put_blob or create_shard happens to it, the data on the
     // chunk is the same as before.
-    move_to_vchunk->m_state = final_state;
+    set_chunk_state(move_to_vchunk, final_state);
 
     LOGDEBUGMOD(homeobject,
                 "gc task_id={}, update vchunk info after gc, move_to_chunk={} now in pg={}, vchunk={}, state={}",
                 task_id, move_to_chunk, pg_id, vchunk_id, final_state);
+
+    // 4 wake up the selections waiting for this vchunk, completed out of the lock since they may select right away
+    auto waiters = take_gc_waiters(pg_id, vchunk_id);
+    lock_guard.unlock();
+    for (auto& waiter : waiters) {
+        waiter.setValue();
+    }
 }
 
 void HeapChunkSelector::switch_chunks_for_pg(const pg_id_t pg_id, const chunk_num_t old_chunk_id,
@@ -373,12 +508,12 @@ void HeapChunkSelector::switch_chunks_for_pg(const pg_id_t pg_id, const chunk_nu
 
     auto v_chunk_id = EXVchunk_old->m_v_chunk_id.value();
 
-    std::unique_lock lock(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto pg_it = m_per_pg_chunks.find(pg_id);
     RELEASE_ASSERT(pg_it != m_per_pg_chunks.end(), "No pg_chunk_collection found for pg={}", pg_id);
     auto& pg_chunk_collection = pg_it->second;
 
-    std::unique_lock lk(pg_chunk_collection->mtx);
+    mutex_lock lock(pg_chunk_collection->mtx, LockLevel::pg);
     auto& pg_chunks = pg_chunk_collection->m_pg_chunks;
 
     // LOGDEBUGMOD(homeobject, "gc: before switch chunks for pg_id={}, pg_chunks={}", pg_chunks);
@@ -398,6 +533,14 @@ void HeapChunkSelector::switch_chunks_for_pg(const pg_id_t pg_id, const chunk_nu
             task_id, v_chunk_id, pg_id, old_chunk_id, pg_chunks[v_chunk_id]->get_chunk_id());
 
         pg_chunks[v_chunk_id] = EXVchunk_new;
+        // both chunks are normally in gc state, which keeps them out of the available chunks of the pg
+        auto& available_chunks = pg_chunk_collection->m_available_chunks;
+        if (auto it = available_chunks.find(EXVchunk_old->get_pdev_id()); it != available_chunks.end()) {
+            it->second.erase(v_chunk_id);
+        }
+        if (EXVchunk_new->available()) {
+            available_chunks[EXVchunk_new->get_pdev_id()].push(v_chunk_id, new_available_blks, EXVchunk_new);
+        }
 
         LOGDEBUGMOD(homeobject,
                     "gc task_id={}, vchunk={} in pg_chunk_collection for pg_id={} has been update from pchunk_id={} to "
@@ -408,7 +551,7 @@ void HeapChunkSelector::switch_chunks_for_pg(const pg_id_t pg_id, const chunk_nu
 }
 
 bool HeapChunkSelector::recover_pg_chunks(pg_id_t pg_id, std::vector< chunk_num_t >&& p_chunk_ids) {
-    std::unique_lock lock_guard(m_chunk_selector_mtx);
+    selector_unique_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     // check pg exist
     if (m_per_pg_chunks.find(pg_id) != m_per_pg_chunks.end()) {
         LOGWARNMOD(homeobject, "pg={} had been recovered", pg_id);
@@ -419,28 +562,18 @@ bool HeapChunkSelector::recover_pg_chunks(pg_id_t pg_id, std::vector< chunk_num_
         return false;
     }
 
-    // check chunks valid, must belong to m_chunks and have same pdev_id
-    std::optional< uint32_t > last_pdev_id;
+    // check chunks valid, must belong to m_chunks. They may be on different pdevs if the pg was striped.
     for (auto p_chunk_id : p_chunk_ids) {
-        auto it = m_chunks.find(p_chunk_id);
-        if (it == m_chunks.end()) {
+        if (m_chunks.find(p_chunk_id) == m_chunks.end()) {
             LOGWARNMOD(homeobject, "No chunk found for p_chunk_id={}", p_chunk_id);
             return false;
         }
-        auto chunk = it->second;
-        if (last_pdev_id.has_value() && last_pdev_id.value() != chunk->get_pdev_id()) {
-            LOGWARNMOD(homeobject, "The pdev value is different, last_pdev_id={}, pdev_id={}", last_pdev_id.value(),
-                       chunk->get_pdev_id());
-            return false;
-        } else {
-            last_pdev_id = chunk->get_pdev_id();
-        }
     }
 
     auto pg_it = m_per_pg_chunks.emplace(pg_id, std::make_shared< PGChunkCollection >()).first;
     auto pg_chunk_collection = pg_it->second;
     auto& pg_chunks = pg_chunk_collection->m_pg_chunks;
-    std::scoped_lock lock(pg_chunk_collection->mtx);
+    mutex_lock lock(pg_chunk_collection->mtx, LockLevel::pg);
     pg_chunks.reserve(p_chunk_ids.size());
 
     // v_chunk_id start from 0.
@@ -455,7 +588,7 @@ bool HeapChunkSelector::recover_pg_chunks(pg_id_t pg_id, std::vector< chunk_num_
 }
 
 void HeapChunkSelector::build_pdev_available_chunk_heap() {
-    std::unique_lock lock_guard(m_chunk_selector_mtx);
+    selector_unique_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     for (auto [p_chunk_id, chunk] : m_chunks) {
         // if selected for pg, or it is marked as GC state(reserved chunk), not add to pdev.
         bool add_to_heap = !chunk->m_pg_id.has_value() && chunk->m_state != ChunkState::GC;
@@ -465,7 +598,7 @@ void HeapChunkSelector::build_pdev_available_chunk_heap() {
 
 bool HeapChunkSelector::recover_pg_chunks_states(pg_id_t pg_id,
                                                  const std::unordered_set< chunk_num_t >& excluding_v_chunk_ids) {
-    std::unique_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto pg_it = m_per_pg_chunks.find(pg_id);
     if (pg_it == m_per_pg_chunks.end()) {
         LOGWARNMOD(homeobject, "PG chunks should be recovered beforhand, pg={}", pg_id);
@@ -474,25 +607,25 @@ bool HeapChunkSelector::recover_pg_chunks_states(pg_id_t pg_id,
 
     auto pg_chunk_collection = pg_it->second;
     auto& pg_chunks = pg_chunk_collection->m_pg_chunks;
-    std::scoped_lock lock(pg_chunk_collection->mtx);
+    mutex_lock lock(pg_chunk_collection->mtx, LockLevel::pg);
 
     for (size_t v_chunk_id = 0; v_chunk_id < pg_chunks.size(); ++v_chunk_id) {
         auto chunk = pg_chunks[v_chunk_id];
         pg_chunk_collection->m_total_blks += chunk->get_total_blks();
         if (excluding_v_chunk_ids.find(v_chunk_id) == excluding_v_chunk_ids.end()) {
-            chunk->m_state = ChunkState::AVAILABLE;
+            set_chunk_state(chunk, ChunkState::AVAILABLE);
             ++pg_chunk_collection->available_num_chunks;
             pg_chunk_collection->available_blk_count += chunk->available_blks();
 
         } else {
-            chunk->m_state = ChunkState::INUSE;
+            set_chunk_state(chunk, ChunkState::INUSE);
         }
     }
     return true;
 }
 
 std::shared_ptr< const std::vector< homestore::chunk_num_t > > HeapChunkSelector::get_pg_chunks(pg_id_t pg_id) const {
-    std::shared_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto pg_it = m_per_pg_chunks.find(pg_id);
     if (pg_it == m_per_pg_chunks.end()) {
         LOGWARNMOD(homeobject, "pg={} had never been created", pg_id);
@@ -501,7 +634,7 @@ std::shared_ptr< const std::vector< homestore::chunk_num_t > > HeapChunkSelector
 
     auto pg_chunk_collection = pg_it->second;
     auto& pg_chunks = pg_chunk_collection->m_pg_chunks;
-    std::scoped_lock lock(pg_chunk_collection->mtx);
+    mutex_lock lock(pg_chunk_collection->mtx, LockLevel::pg);
     auto p_chunk_ids = std::make_shared< std::vector< homestore::chunk_num_t > >();
     p_chunk_ids->reserve(pg_chunks.size());
     for (auto chunk : pg_chunks) {
@@ -511,28 +644,39 @@ std::shared_ptr< const std::vector< homestore::chunk_num_t > > HeapChunkSelector
 }
 
 std::optional< homestore::chunk_num_t > HeapChunkSelector::get_most_available_blk_chunk(uint64_t ctx, pg_id_t pg_id) {
-    std::shared_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto pg_it = m_per_pg_chunks.find(pg_id);
     if (pg_it == m_per_pg_chunks.end()) {
         LOGWARNMOD(homeobject, "No pg found for pg={}", pg_id);
         return std::nullopt;
     }
-    std::scoped_lock lock(pg_it->second->mtx);
+    mutex_lock lock(pg_it->second->mtx, LockLevel::pg);
     auto pg_chunk_collection = pg_it->second;
     auto& pg_chunks = pg_chunk_collection->m_pg_chunks;
-    auto max_it =
-        std::max_element(pg_chunks.begin(), pg_chunks.end(),
-                         [](const std::shared_ptr< ExtendedVChunk >& a, const std::shared_ptr< ExtendedVChunk >& b) {
-                             return !a->available() || (b->available() && a->available_blks() < b->available_blks());
-                         });
-    if (!(*max_it)->available()) {
+    // prefer the pdev with the fewest open chunks, which only differs if the pg is striped, then the chunk with the
+    // most available blks, then the lowest v_chunk_id.
+    ExtendedVChunkHeap const* best{nullptr};
+    uint32_t best_open_chunks{0};
+    for (auto const& [pdev_id, available_chunks] : pg_chunk_collection->m_available_chunks) {
+        if (available_chunks.empty()) { continue; }
+        auto pdev_it = m_per_dev_heap.find(pdev_id);
+        uint32_t const open_chunks = pdev_it == m_per_dev_heap.end() ? 0 : pdev_it->second->num_open_chunks.load();
+        if (best == nullptr || open_chunks < best_open_chunks ||
+            (open_chunks == best_open_chunks &&
+             (best->top_key() < available_chunks.top_key() ||
+              (best->top_key() == available_chunks.top_key() && available_chunks.top_id() < best->top_id())))) {
+            best = &available_chunks;
+            best_open_chunks = open_chunks;
+        }
+    }
+    if (best == nullptr) {
         LOGWARNMOD(homeobject, "No available chunk for pg={}, ctx=0x{:x}", pg_id, ctx);
         return std::nullopt;
     }
-    auto v_chunk_id = std::distance(pg_chunks.begin(), max_it);
+    auto const v_chunk_id = best->top_id();
     LOGDEBUGMOD(homeobject, "Picked v_chunk_id={} : [p_chunk_id={}, avail={}], ctx=0x{:x}", v_chunk_id,
                 pg_chunks[v_chunk_id]->get_chunk_id(), pg_chunks[v_chunk_id]->available_blks(), ctx);
-    pg_chunks[v_chunk_id]->m_state = ChunkState::INUSE;
+    set_chunk_state(pg_chunks[v_chunk_id], ChunkState::INUSE);
     --pg_chunk_collection->available_num_chunks;
     pg_chunk_collection->available_blk_count -= pg_chunks[v_chunk_id]->available_blks();
     return v_chunk_id;
@@ -540,7 +684,7 @@ std::optional< homestore::chunk_num_t > HeapChunkSelector::get_most_available_bl
 
 // return the maximum number of chunks that can be allocated on pdev
 uint32_t HeapChunkSelector::most_avail_num_chunks() const {
-    std::shared_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     uint32_t max_avail_num_chunks = 0ul;
     for (auto const& [_, pdev_heap] : m_per_dev_heap) {
         max_avail_num_chunks = std::max(max_avail_num_chunks, pdev_heap->size());
@@ -550,7 +694,7 @@ uint32_t HeapChunkSelector::most_avail_num_chunks() const {
 }
 
 uint32_t HeapChunkSelector::avail_num_chunks(pg_id_t pg_id) const {
-    std::shared_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto pg_it = m_per_pg_chunks.find(pg_id);
     if (pg_it == m_per_pg_chunks.end()) {
         LOGWARNMOD(homeobject, "No pg found for pg={}", pg_id);
@@ -562,7 +706,7 @@ uint32_t HeapChunkSelector::avail_num_chunks(pg_id_t pg_id) const {
 uint32_t HeapChunkSelector::total_chunks() const { return m_chunks.size(); }
 
 uint64_t HeapChunkSelector::avail_blks(pg_id_t pg_id) const {
-    std::shared_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto pg_it = m_per_pg_chunks.find(pg_id);
     if (pg_it == m_per_pg_chunks.end()) {
         LOGWARNMOD(homeobject, "No pg found for pg={}", pg_id);
@@ -572,7 +716,7 @@ uint64_t HeapChunkSelector::avail_blks(pg_id_t pg_id) const {
 }
 
 uint64_t HeapChunkSelector::total_blks(uint32_t dev_id) const {
-    std::shared_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto it = m_per_dev_heap.find(dev_id);
     if (it == m_per_dev_heap.end()) {
         LOGWARNMOD(homeobject, "No pdev found for pdev {}", dev_id);
@@ -583,7 +727,7 @@ uint64_t HeapChunkSelector::total_blks(uint32_t dev_id) const {
 }
 
 uint64_t HeapChunkSelector::get_used_blks() const {
-    std::shared_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     uint64_t used_blks = 0;
     for (const auto& [_, chunk] : m_chunks) {
         if (chunk->m_state != ChunkState::GC) { used_blks += chunk->get_used_blks(); }
@@ -607,15 +751,51 @@ HeapChunkSelector::get_extend_vchunk(const homestore::chunk_num_t chunk_id) cons
     if (it != m_chunks.end()) { return it->second; }
     return nullptr;
 }
+
+std::pair< std::mutex&, HeapChunkSelector::LockLevel >
+HeapChunkSelector::chunk_owner_mtx(const ExtendedVChunk& chunk) const {
+    if (chunk.m_pg_id.has_value()) {
+        auto pg_it = m_per_pg_chunks.find(chunk.m_pg_id.value());
+        RELEASE_ASSERT(pg_it != m_per_pg_chunks.end(), "pg={} of chunk={} not found", chunk.m_pg_id.value(),
+                       chunk.get_chunk_id());
+        return {pg_it->second->mtx, LockLevel::pg};
+    }
+    auto pdev_it = m_per_dev_heap.find(chunk.get_pdev_id());
+    RELEASE_ASSERT(pdev_it != m_per_dev_heap.end(), "pdev={} of chunk={} not found", chunk.get_pdev_id(),
+                   chunk.get_chunk_id());
+    return {pdev_it->second->mtx, LockLevel::pdev};
+}
+
+#ifndef NDEBUG
+namespace {
+// the number of chunk selector locks of each level held by this thread
+thread_local std::array< uint32_t, static_cast< size_t >(HeapChunkSelector::LockLevel::count) > t_held_locks{};
+} // namespace
+
+HeapChunkSelector::LockOrderGuard::LockOrderGuard(LockLevel level) : m_level(level) {
+    for (auto l = static_cast< size_t >(level); l < t_held_locks.size(); ++l) {
+        DEBUG_ASSERT_EQ(t_held_locks[l], 0, "chunk selector lock of level {} taken while holding one of level {}",
+                        static_cast< size_t >(level), l);
+    }
+    ++t_held_locks[static_cast< size_t >(level)];
+}
+
+void HeapChunkSelector::LockOrderGuard::release() {
+    if (!m_held) { return; }
+    --t_held_locks[static_cast< size_t >(m_level)];
+    m_held = false;
+}
+#endif
 // dump chunks info for given pg_id, return json format
 nlohmann::json HeapChunkSelector::dump_chunks_info(pg_id_t pg_id) const {
-    std::shared_lock lock_guard(m_chunk_selector_mtx);
+    selector_shared_lock lock_guard(m_chunk_selector_mtx, LockLevel::selector);
     auto pg_it = m_per_pg_chunks.find(pg_id);
     if (pg_it == m_per_pg_chunks.end()) {
         LOGWARNMOD(homeobject, "No pg found for pg_id {}", pg_id);
         return nlohmann::json::object(); // Return an empty JSON object if pg_id is not found
     }
 
+    mutex_lock lock(pg_it->second->mtx, LockLevel::pg);
     nlohmann::json pg_chunk_info;
     pg_chunk_info["pg"]["id"] = pg_id;
     nlohmann::json chunks_array = nlohmann::json::array();
@@ -1,17 +1,22 @@
 #pragma once
 
 #include "homeobject/common.hpp"
+#include "indexed_heap.hpp"
 
 #include <homestore/chunk_selector.h>
 #include <homestore/vchunk.h>
 #include <homestore/homestore_decl.hpp>
 #include <homestore/blk.h>
 #include <sisl/utility/enum.hpp>
+#include <folly/futures/Future.h>
 
-#include <queue>
+#include <map>
+#include <optional>
 #include <vector>
 #include <unordered_set>
 #include <mutex>
+#include <shared_mutex>
+#include <utility>
 #include <functional>
 #include <atomic>
 
@@ -29,6 +34,11 @@ public:
     using VChunk = homestore::VChunk;
     using chunk_num_t = homestore::chunk_num_t;
 
+    // The locks of the chunk selector, taken in this order. m_chunk_selector_mtx is only taken exclusively to change
+    // the topology: which chunks belong to which pg, and the content of the pdev heaps. Everything else takes it
+    // shared, and then the lock of the pg or the pdev the chunk belongs to. Debug builds assert the order.
+    enum class LockLevel : uint8_t { selector = 0, pg, pdev, gc_waiters, count };
+
     class ExtendedVChunk : public VChunk {
     public:
         ExtendedVChunk(csharedChunk const& chunk) :
@@ -40,28 +50,27 @@ public:
         bool available() const { return m_state == ChunkState::AVAILABLE; }
     };
 
-    class ExtendedVChunkComparator {
-    public:
-        bool operator()(std::shared_ptr< ExtendedVChunk >& lhs, std::shared_ptr< ExtendedVChunk >& rhs) {
-            return lhs->available_blks() < rhs->available_blks();
-        }
-    };
-    using ExtendedVChunkHeap =
-        std::priority_queue< std::shared_ptr< ExtendedVChunk >, std::vector< std::shared_ptr< ExtendedVChunk > >,
-                             ExtendedVChunkComparator >;
+    // chunks by available blks, addressed by p_chunk_id in a pdev heap and by v_chunk_id in a pg
+    using ExtendedVChunkHeap = IndexedHeap< chunk_num_t, homestore::blk_num_t, std::shared_ptr< ExtendedVChunk > >;
 
     struct ChunkHeap {
+        // protects m_heap and the state of the chunks of this pdev which belong to no pg
         std::mutex mtx;
         ExtendedVChunkHeap m_heap;
         std::atomic_size_t available_blk_count;
         uint64_t m_total_blks{0}; // initlized during boot, and will not change during runtime;
         std::string pdev_name;
+        // the chunks of this pdev in INUSE state, i.e. the open shards writing to this pdev
+        std::atomic_uint32_t num_open_chunks{0};
         uint32_t size() const { return m_heap.size(); }
     };
 
     struct PGChunkCollection {
+        // protects the chunks of the pg and their state
         std::mutex mtx;
         std::vector< std::shared_ptr< ExtendedVChunk > > m_pg_chunks;
+        // the AVAILABLE chunks of m_pg_chunks by pdev, kept in sync by set_chunk_state
+        std::map< uint32_t, ExtendedVChunkHeap > m_available_chunks;
         std::atomic_size_t available_num_chunks;
         std::atomic_size_t available_blk_count;
         uint64_t m_total_blks{0}; // initlized during boot, and will not change during runtime;
@@ -74,9 +83,13 @@ public:
     csharedChunk select_chunk([[maybe_unused]] homestore::blk_count_t nblks, const homestore::blk_alloc_hints& hints);
 
     // this function will be used by create shard or recovery flow to mark one specific chunk to be busy, caller should
-    // be responsible to use release_chunk() interface to release it when no longer to use the chunk anymore.
+    // be responsible to use release_chunk() interface to release it when no longer to use the chunk anymore. If the
+    // chunk is being gc, it blocks until the gc task moves the vchunk out of gc state.
     csharedChunk select_specific_chunk(const pg_id_t pg_id, const chunk_num_t v_chunk_id);
 
+    // same as select_specific_chunk, but the returned future is completed once the gc task is done instead of blocking
+    folly::SemiFuture< csharedChunk > select_specific_chunk_async(const pg_id_t pg_id, const chunk_num_t v_chunk_id);
+
     /**
      * try to mark a chunk as gc state, so that it will not be selected by any creating shard.
      *
@@ -108,13 +121,14 @@ public:
     bool return_pg_chunks_to_dev_heap(pg_id_t pg_id);
 
     /**
-     * select chunks for pg, chunks need to be in same pdev.
+     * select chunks for pg. By default all the chunks are in the pdev with the most available chunks.
      *
      * @param pg_id The ID of the pg.
      * @param pg_size The fix pg size.
+     * @param stripe Spread the chunks over all the pdevs, weighted by their available chunks.
      * @return An optional uint32_t value representing num_chunk, or std::nullopt if no space left.
      */
-    std::optional< uint32_t > select_chunks_for_pg(pg_id_t pg_id, uint64_t pg_size);
+    std::optional< uint32_t > select_chunks_for_pg(pg_id_t pg_id, uint64_t pg_size, bool stripe = false);
 
     // this function is used for pg info superblk persist v_chunk_id <-> p_chunk_id
     std::shared_ptr< const std::vector< chunk_num_t > > get_pg_chunks(pg_id_t pg_id) const;
@@ -219,6 +233,60 @@ public:
 private:
     void add_chunk_internal(const chunk_num_t, bool add_to_heap = true);
 
+    // sets the chunk state and keeps num_open_chunks of its pdev and the available chunks of its pg in sync. Caller
+    // should hold m_chunk_selector_mtx, and the mtx of the pg if it does not hold m_chunk_selector_mtx exclusively.
+    void set_chunk_state(const std::shared_ptr< ExtendedVChunk >& chunk, const ChunkState state);
+
+    // the mtx protecting the state of the chunk: the one of its pg, or of its pdev if it belongs to no pg (e.g. a
+    // reserved chunk). Caller should hold m_chunk_selector_mtx.
+    std::pair< std::mutex&, LockLevel > chunk_owner_mtx(const ExtendedVChunk& chunk) const;
+
+    // counts the chunk selector locks held by the thread to check the lock order, a no-op in release builds
+    class LockOrderGuard {
+    public:
+#ifndef NDEBUG
+        explicit LockOrderGuard(LockLevel level);
+        ~LockOrderGuard() { release(); }
+        void release();
+
+    private:
+        LockLevel m_level;
+        bool m_held{true};
+#else
+        explicit LockOrderGuard(LockLevel) {}
+        void release() {}
+#endif
+    };
+
+    template < typename Lock >
+    class OrderedLock {
+    public:
+        OrderedLock(typename Lock::mutex_type& mtx, LockLevel level) : m_order(level), m_lock(mtx) {}
+        OrderedLock(OrderedLock const&) = delete;
+        OrderedLock& operator=(OrderedLock const&) = delete;
+        void unlock() {
+            m_lock.unlock();
+            m_order.release();
+        }
+
+    private:
+        LockOrderGuard m_order;
+        Lock m_lock;
+    };
+    using selector_shared_lock = OrderedLock< std::shared_lock< std::shared_mutex > >;
+    using selector_unique_lock = OrderedLock< std::unique_lock< std::shared_mutex > >;
+    using mutex_lock = OrderedLock< std::unique_lock< std::mutex > >;
+
+    // marks the chunk of the vchunk in use. If it is being gc, returns nullptr and sets gc_done to a future completed
+    // when the vchunk leaves gc state. Caller should hold m_chunk_selector_mtx.
+    csharedChunk select_specific_chunk_locked(const pg_id_t pg_id, const chunk_num_t v_chunk_id,
+                                              std::optional< folly::SemiFuture< folly::Unit > >& gc_done);
+
+    // takes the waiters of the vchunk, or of all the vchunks of the pg if v_chunk_id is nullopt. Caller should hold
+    // the lock of the pg, or m_chunk_selector_mtx exclusively, and complete them after releasing it.
+    std::vector< folly::Promise< folly::Unit > > take_gc_waiters(const pg_id_t pg_id,
+                                                                 const std::optional< chunk_num_t > v_chunk_id);
+
 private:
     std::unordered_map< uint32_t, std::shared_ptr< ChunkHeap > > m_per_dev_heap;
 
@@ -227,5 +295,9 @@ private:
     std::unordered_map< chunk_num_t, homestore::cshared< ExtendedVChunk > > m_chunks;
 
     mutable std::shared_mutex m_chunk_selector_mtx;
+
+    // selections waiting for a vchunk being gc, keyed by pg_id << 16 | v_chunk_id
+    std::mutex m_gc_waiters_mtx;
+    std::map< uint32_t, std::vector< folly::Promise< folly::Unit > > > m_gc_waiters;
 };
 } // namespace homeobject
@@ -7,6 +7,11 @@
 #include <homestore/homestore.hpp>
 #include <homestore/blkdata_service.hpp>
 
+#include <numeric>
+
+#define XXH_STATIC_LINKING_ONLY
+#include <xxhash.h>
+
 SISL_LOGGING_DECL(blobmgr)
 
 #define BLOG(level, trace_id, shard_id, blob_id, msg, ...)                                                             \
@@ -62,25 +67,141 @@ BlobError toBlobError(ReplServiceError const& e) {
 }
 
 struct put_blob_req_ctx : public repl_result_ctx< BlobManager::Result< HSHomeObject::BlobInfo > > {
-    uint32_t blob_header_idx_{0};
+    bool compact_header_{false};
 
     // Unaligned buffer is good enough for header and key, since they will be explicity copied
-    static intrusive< put_blob_req_ctx > make(uint32_t data_hdr_size) {
-        return intrusive< put_blob_req_ctx >{new put_blob_req_ctx(data_hdr_size)};
+    static intrusive< put_blob_req_ctx > make(bool compact_header = false) {
+        return intrusive< put_blob_req_ctx >{new put_blob_req_ctx(compact_header)};
     }
 
-    put_blob_req_ctx(uint32_t data_hdr_size) : repl_result_ctx(0u /* header_extn_size */, sizeof(blob_id_t)) {
-        uint32_t aligned_size = uint32_cast(sisl::round_up(data_hdr_size, io_align));
-        sisl::io_blob_safe buf{aligned_size, io_align};
-        new (buf.bytes()) HSHomeObject::BlobHeader();
-        add_data_sg(std::move(buf));
-        blob_header_idx_ = data_bufs_.size() - 1;
-    }
+    explicit put_blob_req_ctx(bool compact_header) :
+            repl_result_ctx(0u /* header_extn_size */, sizeof(blob_id_t)), compact_header_{compact_header} {}
 
+    bool is_compact_header() const { return compact_header_; }
     HSHomeObject::BlobHeader* blob_header() { return r_cast< HSHomeObject::BlobHeader* >(blob_header_buf().bytes()); }
-    sisl::io_blob_safe& blob_header_buf() { return data_bufs_[blob_header_idx_]; }
+    HSHomeObject::CompactBlobHeader* compact_blob_header() {
+        return r_cast< HSHomeObject::CompactBlobHeader* >(blob_header_buf().bytes());
+    }
+    std::string blob_header_string() {
+        return compact_header_ ? compact_blob_header()->to_string() : blob_header()->to_string();
+    }
+    // The blob header is at the start of the first data buffer, see add_blob_data_sgs
+    sisl::io_blob_safe& blob_header_buf() { return data_bufs_[0]; }
 };
 
+// The non empty fragments of the payload of a put, from body_sgs or the body itself
+static std::vector< iovec > payload_fragments(Blob const& blob) {
+    if (blob.body_sgs.iovs.empty()) {
+        return {iovec{.iov_base = const_cast< uint8_t* >(blob.body.cbytes()), .iov_len = blob.body.size()}};
+    }
+    std::vector< iovec > frags;
+    std::copy_if(blob.body_sgs.iovs.begin(), blob.body_sgs.iovs.end(), std::back_inserter(frags),
+                 [](iovec const& iov) { return iov.iov_len > 0; });
+    return frags;
+}
+
+// Computes the crc32c of every chunk_size bytes of the payload fragments into crcs, the last chunk may be short.
+static void compute_data_crcs(std::vector< iovec > const& frags, uint64_t chunk_size, uint8_t* crcs) {
+    uint32_t crc{0};
+    uint64_t chunk_left = chunk_size;
+    auto store = [&crcs](uint32_t value) {
+        std::memcpy(crcs, &value, sizeof(value));
+        crcs += sizeof(value);
+    };
+    for (auto const& frag : frags) {
+        auto const* src = r_cast< uint8_t const* >(frag.iov_base);
+        uint64_t len = frag.iov_len;
+        while (len > 0) {
+            auto const n = std::min(len, chunk_left);
+            crc = crc32c(crc, src, n);
+            src += n;
+            len -= n;
+            chunk_left -= n;
+            if (chunk_left == 0) {
+                store(crc);
+                crc = 0;
+                chunk_left = chunk_size;
+            }
+        }
+    }
+    if (chunk_left != chunk_size) { store(crc); }
+}
+
+// Adds the blob header (the first data_offset bytes of the blob, in hdr) and the payload fragments behind it to the
+// data sgs of req. A part of a fragment which is io_align aligned both in memory and in the extent is submitted in
+// place. Everything else (header, the unaligned head and tail of a fragment, a fragment out of step with its extent
+// offset) is bounced into aligned buffers, the last one zero padded up to io_align.
+static void add_blob_data_sgs(ho_repl_ctx& req, uint8_t const* hdr, uint32_t data_offset,
+                              std::vector< iovec > const& frags) {
+    struct segment {
+        uint8_t const* src;
+        uint64_t len;
+        bool in_place;
+    };
+    std::vector< segment > segs{segment{hdr, data_offset, false}};
+    uint64_t extent_offset = data_offset;
+    for (auto const& frag : frags) {
+        auto const* src = r_cast< uint8_t const* >(frag.iov_base);
+        uint64_t const len = frag.iov_len;
+        auto const addr = r_cast< uintptr_t >(src);
+        uint64_t const head = std::min< uint64_t >((io_align - addr % io_align) % io_align, len);
+        uint64_t const middle = (len - head) / io_align * io_align;
+        if ((addr - extent_offset) % io_align == 0 && middle > 0) {
+            if (head > 0) { segs.push_back(segment{src, head, false}); }
+            segs.push_back(segment{src + head, middle, true});
+            if (head + middle < len) { segs.push_back(segment{src + head + middle, len - head - middle, false}); }
+        } else {
+            segs.push_back(segment{src, len, false});
+        }
+        extent_offset += len;
+    }
+
+    for (size_t i = 0; i < segs.size();) {
+        if (segs[i].in_place) {
+            req.add_data_sg(const_cast< uint8_t* >(segs[i].src), uint32_cast(segs[i].len));
+            ++i;
+            continue;
+        }
+        // an in place segment starts at an aligned extent offset, so the bounce buffer before it is fully used
+        uint64_t run_len{0};
+        size_t end = i;
+        for (; end < segs.size() && !segs[end].in_place; ++end) {
+            run_len += segs[end].len;
+        }
+        sisl::io_blob_safe buf{uint32_cast(sisl::round_up(run_len, io_align)), io_align};
+        uint8_t* dst = buf.bytes();
+        for (; i < end; ++i) {
+            std::memcpy(dst, segs[i].src, segs[i].len);
+            dst += segs[i].len;
+        }
+        std::memset(dst, 0, buf.size() - run_len);
+        req.add_data_sg(std::move(buf));
+    }
+}
+
+// Hash algorithm of the payload of new blobs which are not packed
+static HSHomeObject::BlobHeader::HashAlgorithm blob_hash_algorithm() {
+    using HashAlgorithm = HSHomeObject::BlobHeader::HashAlgorithm;
+    auto const algorithm = HashAlgorithm{HS_BACKEND_DYNAMIC_CONFIG(blob_hash_algorithm)};
+    switch (algorithm) {
+    case HashAlgorithm::CRC32:
+    case HashAlgorithm::CRC32C:
+    case HashAlgorithm::XXH3_64:
+        return algorithm;
+    default:
+        LOGW("unsupported blob_hash_algorithm={}, using CRC32", uint8_t(algorithm));
+        return HashAlgorithm::CRC32;
+    }
+}
+
+static uint32_t blob_pack_max_extent_size() {
+    return std::min(HS_BACKEND_DYNAMIC_CONFIG(blob_pack_max_extent_size), HSHomeObject::max_packed_extent_size);
+}
+
+// Largest distance between two blob ids of a get_batch which are resolved by the same index query, about the entries
+// of an index leaf node. Farther ones get a query of their own.
+static constexpr blob_id_t max_batch_query_gap = 64;
+
 BlobManager::AsyncResult< blob_id_t > HSHomeObject::_put_blob(ShardInfo const& shard, Blob&& blob, trace_id_t tid) {
 
     if (is_shutting_down()) {
@@ -95,6 +216,15 @@ BlobManager::AsyncResult< blob_id_t > HSHomeObject::_put_blob(ShardInfo const& s
         decr_pending_request_num();
         return folly::makeUnexpected(BlobError(BlobErrorCode::INVALID_ARG));
     }
+
+    // Small blobs share an extent with other small blobs of the same shard.
+    auto const pack_max_blob_size = HS_BACKEND_DYNAMIC_CONFIG(blob_pack_max_blob_size);
+    if (pack_max_blob_size > 0 && blob.payload_size() <= pack_max_blob_size &&
+        packed_record_size(blob.user_key.size(), blob.payload_size()) <= blob_pack_max_extent_size()) {
+        blob.gather_body();
+        return _put_packed_blob(shard, std::move(blob), tid);
+    }
+
     auto& pg_id = shard.placement_group;
     shared< homestore::ReplDev > repl_dev;
     blob_id_t new_blob_id;
@@ -116,7 +246,7 @@ BlobManager::AsyncResult< blob_id_t > HSHomeObject::_put_blob(ShardInfo const& s
     }
     RELEASE_ASSERT(repl_dev != nullptr, "Repl dev instance null");
     BLOGD(tid, shard.id, new_blob_id, "Blob Put request: pg={}, group={}, shard=0x{:x}, length={}", pg_id,
-          repl_dev->group_id(), shard.id, blob.body.size());
+          repl_dev->group_id(), shard.id, blob.payload_size());
 
     if (!repl_dev->is_leader()) {
         BLOGW(tid, shard.id, new_blob_id, "failed to put blob for pg={}, not leader", pg_id);
@@ -130,8 +260,9 @@ BlobManager::AsyncResult< blob_id_t > HSHomeObject::_put_blob(ShardInfo const& s
         return folly::makeUnexpected(BlobError(BlobErrorCode::RETRY_REQUEST));
     }
 
-    // Create a put_blob request which allocates for header, key and blob_header, user_key. Data sgs are added later
-    auto req = put_blob_req_ctx::make(sisl::round_up(sizeof(BlobHeader), repl_dev->get_blk_size()));
+    // Create a put_blob request which allocates for header and key. Data sgs are added later
+    auto const compact_header = HS_BACKEND_DYNAMIC_CONFIG(blob_header_compact);
+    auto req = put_blob_req_ctx::make(compact_header);
     req->header()->msg_type = ReplicationMessageType::PUT_BLOB_MSG;
     req->header()->payload_size = 0;
     req->header()->payload_crc = 0;
@@ -149,40 +280,29 @@ BlobManager::AsyncResult< blob_id_t > HSHomeObject::_put_blob(ShardInfo const& s
     // 3. Actual data blobs
     // 4. Any padding of zeros (to round off to nearest block size)
 
-    // Blob Header section.
-    auto const blob_size = blob.body.size();
-    req->blob_header()->type = DataHeader::data_type_t::BLOB_INFO;
-    req->blob_header()->shard_id = shard.id;
-    req->blob_header()->blob_id = new_blob_id;
-    req->blob_header()->hash_algorithm = BlobHeader::HashAlgorithm::CRC32;
-    req->blob_header()->blob_size = blob_size;
-    req->blob_header()->user_key_size = blob.user_key.size();
-    req->blob_header()->object_offset = blob.object_off;
-
-    // Append the user key information if present.
-    if (!blob.user_key.empty()) {
-        std::memcpy(req->blob_header()->user_key, blob.user_key.data(), blob.user_key.size());
-    }
-    // TODO support data blocks checksum for partial read integrity
-
-    // Set offset of actual data after the blob header and user key (rounded off)
-    req->blob_header()->data_offset = req->blob_header_buf().size();
-    RELEASE_ASSERT(req->blob_header()->data_offset == _data_block_size,
-                       "blob header should equals _data_block_size");
-    // In case blob body is not aligned, create a new aligned buffer and copy the blob body.
-    if (((r_cast< uintptr_t >(blob.body.cbytes()) % io_align) != 0) || ((blob_size % io_align) != 0)) {
-        // If address or size is not aligned, create a separate aligned buffer and do expensive memcpy.
-        sisl::io_blob_safe new_body = sisl::io_blob_safe(sisl::round_up(blob_size, io_align), io_align);
-        std::memcpy(new_body.bytes(), blob.body.cbytes(), blob_size);
-        blob.body = std::move(new_body);
-    }
-    // Compute the checksum of blob and metadata.
-    compute_blob_payload_hash(req->blob_header()->hash_algorithm, blob.body.cbytes(), blob_size,
-                              req->blob_header()->hash, BlobHeader::blob_max_hash_len);
-    req->blob_header()->seal();
-
-    // Add blob body to the request
-    req->add_data_sg(std::move(blob.body));
+    // Blob Header section. The compact header keeps the user key and hash inline and shares the first data block with
+    // the payload. Its data offset is the header size rounded up to io_align, so that a get can read the payload
+    // straight into the buffer it returns. The fixed size header always takes the whole first data block.
+    auto const frags = payload_fragments(blob);
+    // The compact header may also carry the crcs of the payload chunks, which let range reads verify what they read.
+    auto const data_crcs = compact_header && HS_BACKEND_DYNAMIC_CONFIG(blob_data_crc);
+    auto const hash_algorithm = blob_hash_algorithm();
+    uint32_t data_offset = _data_block_size;
+    if (compact_header) {
+        auto const header_size = CompactBlobHeader::header_size_for(
+            blob.user_key.size(), CompactBlobHeader::hash_length(hash_algorithm),
+            data_crcs ? CompactBlobHeader::data_crc_count_for(blob.payload_size()) : 0);
+        data_offset = uint32_cast(sisl::round_up(header_size, io_align));
+    }
+    learn_blob_layout(shard.id, data_offset, data_crcs);
+    // user key, hash and the padding up to the payload are written to disk as well, keep them zeroed
+    std::vector< uint8_t > hdr_buf(data_offset, 0);
+    write_blob_header(hdr_buf.data(), compact_header, hash_algorithm, shard.id, new_blob_id, blob, data_offset,
+                      data_crcs);
+
+    // Aligned parts of the payload are written in place, only the unaligned heads and tails are copied.
+    add_blob_data_sgs(*req, hdr_buf.data(), data_offset, frags);
+    if (blob.body.size() > 0) { req->keep_data_buf(std::move(blob.body)); }
 
     // Check if any padding of zeroes needs to be added to be aligned to device block size.
     auto pad_len = sisl::round_up(req->data_sgs().size, repl_dev->get_blk_size()) - req->data_sgs().size;
@@ -190,13 +310,14 @@ BlobManager::AsyncResult< blob_id_t > HSHomeObject::_put_blob(ShardInfo const& s
         sisl::io_blob_safe& zbuf = get_pad_buf(pad_len);
         req->add_data_sg(zbuf.bytes(), pad_len);
     }
-    BLOGT(tid, req->blob_header()->shard_id, req->blob_header()->blob_id, "Put blob: header={} sgs={}",
-          req->blob_header()->to_string(), req->data_sgs_string());
+    BLOGT(tid, shard.id, new_blob_id, "Put blob: header={} sgs={}", req->blob_header_string(),
+          req->data_sgs_string());
 
+    auto const start = Clock::now();
     repl_dev->async_alloc_write(req->cheader_buf(), req->ckey_buf(), req->data_sgs(), req, false /* part_of_batch */,
                                 tid);
     return req->result().deferValue(
-        [this, req, repl_dev, tid](const auto& result) -> BlobManager::AsyncResult< blob_id_t > {
+        [this, req, repl_dev, tid, start](const auto& result) -> BlobManager::AsyncResult< blob_id_t > {
             if (result.hasError()) {
                 auto err = result.error();
                 if (err.getCode() == BlobErrorCode::NOT_LEADER) { err.current_leader = repl_dev->get_leader_id(); }
@@ -206,17 +327,350 @@ BlobManager::AsyncResult< blob_id_t > HSHomeObject::_put_blob(ShardInfo const& s
             auto blob_info = result.value();
             BLOGD(tid, blob_info.shard_id, blob_info.blob_id, "Blob Put request: Put blob success blkid={}",
                   blob_info.pbas.to_string());
+            if (gc_mgr_) { gc_mgr_->record_client_io_latency(blob_info.pbas.chunk_num(), get_elapsed_time_us(start)); }
             decr_pending_request_num();
             return blob_info.blob_id;
         });
 }
 
-bool HSHomeObject::local_add_blob_info(pg_id_t const pg_id, BlobInfo const& blob_info, trace_id_t tid) {
+BlobManager::AsyncResult< blob_id_t > HSHomeObject::_put_packed_blob(ShardInfo const& shard, Blob&& blob,
+                                                                    trace_id_t tid) {
+    // The pending request taken in _put_blob is released when the pack holding this blob completes.
+    auto const record_size = packed_record_size(blob.user_key.size(), blob.body.size());
+    folly::Promise< BlobManager::Result< blob_id_t > > promise;
+    auto result = promise.getSemiFuture();
+
+    std::vector< std::vector< PendingPackedBlob > > packs;
+    {
+        std::scoped_lock lock_guard(blob_pack_lock_);
+        auto& queue = blob_pack_queues_[shard.id];
+        queue.pending.emplace_back(PendingPackedBlob{std::move(blob), tid, std::move(promise)});
+        queue.pending_bytes += record_size;
+        packs = take_blob_packs(queue);
+    }
+    BLOGT(tid, shard.id, 0, "Blob Put request: queued for packing, record_size={}, packs_to_write={}", record_size,
+          packs.size());
+
+    for (auto& pack : packs) {
+        write_blob_pack(shard.id, shard.placement_group, std::move(pack));
+    }
+    return result;
+}
+
+std::vector< std::vector< HSHomeObject::PendingPackedBlob > > HSHomeObject::take_blob_packs(BlobPackQueue& queue) {
+    auto const max_extent_size = blob_pack_max_extent_size();
+    std::vector< std::vector< PendingPackedBlob > > packs;
+
+    // A partial pack is only written when nothing else of the shard is in flight, the blobs arriving meanwhile are
+    // packed together once it completes. A full pack does not wait.
+    while (!queue.pending.empty() && (queue.inflight == 0 || queue.pending_bytes >= max_extent_size)) {
+        std::vector< PendingPackedBlob > pack;
+        uint32_t pack_bytes{0};
+        while (!queue.pending.empty()) {
+            auto& next = queue.pending.front();
+            auto const record_size = packed_record_size(next.blob.user_key.size(), next.blob.body.size());
+            if (!pack.empty() && (pack_bytes + record_size > max_extent_size || pack.size() == max_blobs_per_pack)) {
+                break;
+            }
+            pack_bytes += record_size;
+            pack.emplace_back(std::move(next));
+            queue.pending.pop_front();
+        }
+        queue.pending_bytes -= pack_bytes;
+        ++queue.inflight;
+        packs.emplace_back(std::move(pack));
+    }
+    return packs;
+}
+
+void HSHomeObject::on_blob_pack_written(shard_id_t shard_id, pg_id_t pg_id) {
+    std::vector< std::vector< PendingPackedBlob > > packs;
+    {
+        std::scoped_lock lock_guard(blob_pack_lock_);
+        auto it = blob_pack_queues_.find(shard_id);
+        RELEASE_ASSERT(it != blob_pack_queues_.end(), "pack queue not found, shard_id=0x{:x}", shard_id);
+        auto& queue = it->second;
+        --queue.inflight;
+        packs = take_blob_packs(queue);
+        if (queue.pending.empty() && queue.inflight == 0) { blob_pack_queues_.erase(it); }
+    }
+
+    for (auto& pack : packs) {
+        write_blob_pack(shard_id, pg_id, std::move(pack));
+    }
+}
+
+uint32_t HSHomeObject::write_blob_header(uint8_t* buf, bool compact, BlobHeader::HashAlgorithm hash_algorithm,
+                                         shard_id_t shard_id, blob_id_t blob_id, Blob const& blob,
+                                         uint32_t data_offset, bool data_crcs) const {
+    auto const blob_size = uint32_cast(blob.payload_size());
+    auto const frags = payload_fragments(blob);
+
+    if (compact) {
+        auto hdr = new (buf) CompactBlobHeader();
+        hdr->type = DataHeader::data_type_t::BLOB_INFO;
+        hdr->shard_id = shard_id;
+        hdr->blob_id = blob_id;
+        hdr->hash_algorithm = hash_algorithm;
+        hdr->hash_len = CompactBlobHeader::hash_length(hash_algorithm);
+        hdr->blob_size = blob_size;
+        hdr->user_key_size = blob.user_key.size();
+        if (data_crcs) {
+            hdr->data_crc_chunk_shift = CompactBlobHeader::data_crc_chunk_shift_for(blob_size);
+            hdr->data_crc_count = s_cast< uint16_t >(CompactBlobHeader::data_crc_count_for(blob_size));
+        }
+        hdr->header_size = s_cast< uint16_t >(
+            CompactBlobHeader::header_size_for(hdr->user_key_size, hdr->hash_len, hdr->data_crc_count));
+        hdr->object_offset = blob.object_off;
+        hdr->data_offset = data_offset ? data_offset : uint32_cast(sisl::round_up(hdr->header_size, io_align));
+        RELEASE_ASSERT_GE(hdr->data_offset, hdr->header_size, "data offset overlaps the compact header");
+        if (!blob.user_key.empty()) { std::memcpy(hdr->user_key(), blob.user_key.data(), blob.user_key.size()); }
+        compute_blob_payload_hash(hash_algorithm, frags, hdr->hash(), hdr->hash_len);
+        if (hdr->data_crc_count > 0) { compute_data_crcs(frags, hdr->data_crc_chunk_size(), hdr->data_crcs()); }
+        hdr->seal();
+        return hdr->data_offset;
+    }
+
+    auto hdr = new (buf) BlobHeader();
+    hdr->type = DataHeader::data_type_t::BLOB_INFO;
+    hdr->shard_id = shard_id;
+    hdr->blob_id = blob_id;
+    hdr->hash_algorithm = hash_algorithm;
+    hdr->blob_size = blob_size;
+    hdr->user_key_size = blob.user_key.size();
+    hdr->object_offset = blob.object_off;
+    hdr->data_offset = _data_block_size;
+    RELEASE_ASSERT(data_offset == 0 || data_offset == _data_block_size, "blob header should equals _data_block_size");
+    if (!blob.user_key.empty()) { std::memcpy(hdr->user_key, blob.user_key.data(), blob.user_key.size()); }
+    compute_blob_payload_hash(hash_algorithm, frags, hdr->hash, BlobHeader::blob_max_hash_len);
+    hdr->seal();
+    return hdr->data_offset;
+}
+
+uint32_t HSHomeObject::write_packed_record(uint8_t* buf, shard_id_t shard_id, blob_id_t blob_id,
+                                           Blob const& blob) const {
+    // packed blobs are always hashed with CRC32, see packed_record_size
+    auto const data_offset =
+        write_blob_header(buf, true /* compact */, BlobHeader::HashAlgorithm::CRC32, shard_id, blob_id, blob);
+    std::memcpy(buf + data_offset, blob.body.cbytes(), blob.body.size());
+    return packed_record_size(blob.user_key.size(), blob.body.size());
+}
+
+BlobManager::AsyncResult< blob_id_t > HSHomeObject::write_blob_batch(shard_id_t shard_id, pg_id_t pg_id,
+                                                                     std::vector< Blob >&& blobs, trace_id_t tid) {
+    RELEASE_ASSERT(!blobs.empty(), "empty blob batch, shard_id=0x{:x}", shard_id);
+    auto hs_pg = get_hs_pg(pg_id);
+    RELEASE_ASSERT(hs_pg, "PG not found, pg={}", pg_id);
+    auto repl_dev = hs_pg->repl_dev_;
+    RELEASE_ASSERT(repl_dev != nullptr, "Repl dev instance null");
+
+    if (hs_pg->pg_state_.is_state_set(PGStateMask::DISK_DOWN)) {
+        BLOGW(tid, shard_id, 0, "failed to put blob batch for pg={}, pg is disk down and not leader", pg_id);
+        return folly::makeUnexpected(BlobError(BlobErrorCode::NOT_LEADER));
+    }
+    if (!repl_dev->is_leader()) {
+        BLOGW(tid, shard_id, 0, "failed to put blob batch for pg={}, not leader", pg_id);
+        return folly::makeUnexpected(BlobError(BlobErrorCode::NOT_LEADER, repl_dev->get_leader_id()));
+    }
+    if (!repl_dev->is_ready_for_traffic()) {
+        BLOGW(tid, shard_id, 0, "failed to put blob batch for pg={}, not ready for traffic", pg_id);
+        return folly::makeUnexpected(BlobError(BlobErrorCode::RETRY_REQUEST));
+    }
+
+    // Blob ids of a batch are contiguous, is_extent_shared relies on it to find the blobs sharing an extent.
+    blob_id_t first_blob_id;
+    const_cast< HS_PG* >(hs_pg)->durable_entities_update(
+        [&first_blob_id, count = blobs.size()](auto& de) {
+            first_blob_id = de.blob_sequence_num.fetch_add(count, std::memory_order_relaxed);
+        },
+        false /* dirty */);
+
+    auto const payload_size = uint32_cast(blobs.size() * sizeof(BlobBatchEntry));
+    auto req = repl_result_ctx< BlobManager::Result< BlobInfo > >::make(payload_size /* header_extn_size */,
+                                                                         sizeof(blob_id_t) /* key_size */);
+    auto entries = r_cast< BlobBatchEntry* >(req->header_extn());
+
+    // Lay the blobs out in their order. Consecutive small blobs are packed into one extent as long as it has room, any
+    // other blob gets an extent of its own: header, payload and zero padding up to the block size.
+    auto const blk_size = repl_dev->get_blk_size();
+    auto const pack_max_blob_size = HS_BACKEND_DYNAMIC_CONFIG(blob_pack_max_blob_size);
+    auto const max_extent_size = blob_pack_max_extent_size();
+    auto const compact_header = HS_BACKEND_DYNAMIC_CONFIG(blob_header_compact);
+    auto const data_crcs = compact_header && HS_BACKEND_DYNAMIC_CONFIG(blob_data_crc);
+    auto const hash_algorithm = blob_hash_algorithm();
+    auto packable = [pack_max_blob_size, max_extent_size](Blob const& blob) {
+        return pack_max_blob_size > 0 && blob.payload_size() <= pack_max_blob_size &&
+            packed_record_size(blob.user_key.size(), blob.payload_size()) <= max_extent_size;
+    };
+
+    uint32_t blk_offset{0};
+    for (size_t i = 0; i < blobs.size();) {
+        if (packable(blobs[i])) {
+            size_t end{i};
+            uint32_t data_size{0};
+            while (end < blobs.size() && end - i < max_blobs_per_pack && packable(blobs[end])) {
+                auto const record_size = packed_record_size(blobs[end].user_key.size(), blobs[end].payload_size());
+                if (data_size + record_size > max_extent_size) { break; }
+                data_size += record_size;
+                ++end;
+            }
+
+            // zeroes after the last record end the chain
+            auto const extent_size = uint32_cast(sisl::round_up(data_size, blk_size));
+            sisl::io_blob_safe extent{extent_size, io_align};
+            std::memset(extent.bytes(), 0, extent_size);
+            uint32_t offset{0};
+            for (; i < end; ++i) {
+                entries[i] = BlobBatchEntry{first_blob_id + i, blk_offset, extent_size / blk_size};
+                // packed records are copied into the extent anyway
+                blobs[i].gather_body();
+                offset += write_packed_record(extent.bytes() + offset, shard_id, first_blob_id + i, blobs[i]);
+            }
+            req->add_data_sg(std::move(extent));
+            blk_offset += extent_size / blk_size;
+            continue;
+        }
+
+        // Same layout as a single put, aligned parts of the payload are written in place.
+        auto& blob = blobs[i];
+        auto const frags = payload_fragments(blob);
+        uint32_t data_offset = _data_block_size;
+        if (compact_header) {
+            auto const header_size = CompactBlobHeader::header_size_for(
+                blob.user_key.size(), CompactBlobHeader::hash_length(hash_algorithm),
+                data_crcs ? CompactBlobHeader::data_crc_count_for(blob.payload_size()) : 0);
+            data_offset = uint32_cast(sisl::round_up(header_size, io_align));
+        }
+        learn_blob_layout(shard_id, data_offset, data_crcs);
+        std::vector< uint8_t > hdr_buf(data_offset, 0);
+        write_blob_header(hdr_buf.data(), compact_header, hash_algorithm, shard_id, first_blob_id + i, blob,
+                          data_offset, data_crcs);
+        auto const sgs_size = req->data_sgs().size;
+        add_blob_data_sgs(*req, hdr_buf.data(), data_offset, frags);
+        if (blob.body.size() > 0) { req->keep_data_buf(std::move(blob.body)); }
+        auto const data_size = req->data_sgs().size - sgs_size;
+
+        auto const extent_size = uint32_cast(sisl::round_up(data_size, blk_size));
+        if (auto const pad_len = extent_size - data_size; pad_len != 0) {
+            sisl::io_blob_safe& zbuf = get_pad_buf(pad_len);
+            req->add_data_sg(zbuf.bytes(), pad_len);
+        }
+        entries[i] = BlobBatchEntry{first_blob_id + i, blk_offset, extent_size / blk_size};
+        blk_offset += extent_size / blk_size;
+        ++i;
+    }
+
+    req->header()->msg_type = ReplicationMessageType::PUT_BLOB_BATCH_MSG;
+    req->header()->payload_size = payload_size;
+    req->header()->payload_crc = crc32_ieee(init_crc32, req->header_extn(), payload_size);
+    req->header()->shard_id = shard_id;
+    req->header()->pg_id = pg_id;
+    req->header()->blob_id = first_blob_id;
+    req->header()->seal();
+    *(reinterpret_cast< blob_id_t* >(req->key_buf().bytes())) = first_blob_id;
+
+    BLOGT(tid, shard_id, first_blob_id, "Put blob batch: count={}, blks={}, sgs={}", blobs.size(), blk_offset,
+          req->data_sgs_string());
+
+    auto const start = Clock::now();
+    repl_dev->async_alloc_write(req->cheader_buf(), req->ckey_buf(), req->data_sgs(), req, false /* part_of_batch */,
+                                tid);
+    return req->result().deferValue(
+        [this, req, repl_dev, tid, shard_id, start](const auto& result) -> BlobManager::Result< blob_id_t > {
+            if (result.hasError()) {
+                auto err = result.error();
+                if (err.getCode() == BlobErrorCode::NOT_LEADER) { err.current_leader = repl_dev->get_leader_id(); }
+                return folly::makeUnexpected(err);
+            }
+            BLOGD(tid, shard_id, result.value().blob_id, "Put blob batch success: blkid={}",
+                  result.value().pbas.to_string());
+            if (gc_mgr_) {
+                gc_mgr_->record_client_io_latency(result.value().pbas.chunk_num(), get_elapsed_time_us(start));
+            }
+            return result.value().blob_id;
+        });
+}
+
+void HSHomeObject::write_blob_pack(shard_id_t shard_id, pg_id_t pg_id, std::vector< PendingPackedBlob >&& pack) {
+    RELEASE_ASSERT(!pack.empty(), "empty blob pack, shard_id=0x{:x}", shard_id);
+    auto const tid = pack.front().tid;
+    std::vector< Blob > blobs;
+    blobs.reserve(pack.size());
+    for (auto& pending : pack) {
+        blobs.emplace_back(std::move(pending.blob));
+    }
+
+    write_blob_batch(shard_id, pg_id, std::move(blobs), tid)
+        .via(executor_)
+        .thenValue([this, tid, shard_id, pg_id, pack = std::move(pack)](auto const& result) mutable {
+            if (result.hasError()) {
+                BLOGW(tid, shard_id, 0, "failed to put {} packed blobs, err={}", pack.size(), result.error());
+                for (auto& pending : pack) {
+                    pending.promise.setValue(folly::makeUnexpected(result.error()));
+                    decr_pending_request_num();
+                }
+            } else {
+                for (size_t i = 0; i < pack.size(); ++i) {
+                    pack[i].promise.setValue(result.value() + i);
+                    decr_pending_request_num();
+                }
+            }
+            on_blob_pack_written(shard_id, pg_id);
+        });
+}
+
+BlobManager::AsyncResult< std::vector< blob_id_t > >
+HSHomeObject::_put_blob_batch(ShardInfo const& shard, std::vector< Blob >&& blobs, trace_id_t tid) {
+    if (is_shutting_down()) {
+        LOGI("service is being shut down");
+        return folly::makeUnexpected(BlobErrorCode::SHUTTING_DOWN);
+    }
+    incr_pending_request_num();
+    uint64_t batch_size{0};
+    for (auto const& blob : blobs) {
+        if (blob.user_key.size() > BlobHeader::max_user_key_length) {
+            BLOGE(tid, shard.id, 0, "input user key length > max_user_key_length {}", blob.user_key.size(),
+                  BlobHeader::max_user_key_length);
+            decr_pending_request_num();
+            return folly::makeUnexpected(BlobError(BlobErrorCode::INVALID_ARG));
+        }
+        batch_size += blob.payload_size();
+    }
+    // the whole batch goes into one raft entry and one allocation
+    if (blobs.size() > HS_BACKEND_DYNAMIC_CONFIG(blob_batch_max_count) ||
+        batch_size > HS_BACKEND_DYNAMIC_CONFIG(blob_batch_max_size)) {
+        BLOGE(tid, shard.id, 0, "blob batch of count={} size={} is over blob_batch_max_count={} or size={}",
+              blobs.size(), batch_size, HS_BACKEND_DYNAMIC_CONFIG(blob_batch_max_count),
+              HS_BACKEND_DYNAMIC_CONFIG(blob_batch_max_size));
+        decr_pending_request_num();
+        return folly::makeUnexpected(BlobError(BlobErrorCode::INVALID_ARG));
+    }
+
+    auto const num_blobs = blobs.size();
+    BLOGD(tid, shard.id, 0, "Blob batch put request: pg={}, shard=0x{:x}, count={}", shard.placement_group, shard.id,
+          num_blobs);
+    return write_blob_batch(shard.id, shard.placement_group, std::move(blobs), tid)
+        .deferValue([this, num_blobs](auto const& result) -> BlobManager::Result< std::vector< blob_id_t > > {
+            decr_pending_request_num();
+            if (result.hasError()) { return folly::makeUnexpected(result.error()); }
+            std::vector< blob_id_t > blob_ids(num_blobs);
+            std::iota(blob_ids.begin(), blob_ids.end(), result.value());
+            return blob_ids;
+        });
+}
+
+bool HSHomeObject::local_add_blob_info(pg_id_t const pg_id, BlobInfo const& blob_info, std::optional< int64_t > lsn,
+                                       trace_id_t tid, bool count_occupied_blks) {
     auto hs_pg = get_hs_pg(pg_id);
     RELEASE_ASSERT(hs_pg != nullptr, "PG not found");
     shared< BlobIndexTable > index_table = hs_pg->index_table_;
     RELEASE_ASSERT(index_table != nullptr, "Index table not initialized");
 
+    // Added ahead of the index, so that a get never misses a blob found in the index.
+    if (auto hs_shard = _get_hs_shard(blob_info.shard_id); hs_shard) {
+        hs_shard->blob_filter_.add(blob_info.blob_id);
+    }
+
     // Write to index table with key {shard id, blob id} and value {pba}.
     auto const [exist_already, status] = add_to_index_table(index_table, blob_info);
     BLOGT(tid, blob_info.shard_id, blob_info.blob_id, "blob put commit, exist_already={}, status={}, pbas={}",
@@ -234,8 +688,9 @@ bool HSHomeObject::local_add_blob_info(pg_id_t const pg_id, BlobInfo const& blob
         // for this blob put.
 
         // Update the durable counters. We need to update the blob_sequence_num here only for replay case, as the
-        // number is already updated in the put_blob call.
-        const_cast< HS_PG* >(hs_pg)->durable_entities_update([&blob_info](auto& de) {
+        // number is already updated in the put_blob call. A replayed log counted before the last cp is skipped too,
+        // as its index entry may have been lost with the index write back cache.
+        const_cast< HS_PG* >(hs_pg)->durable_entities_update_at(lsn, [&blob_info, count_occupied_blks](auto& de) {
             auto existing_blob_id = de.blob_sequence_num.load();
             auto next_blob_id = blob_info.blob_id + 1;
             while (next_blob_id > existing_blob_id &&
@@ -243,7 +698,9 @@ bool HSHomeObject::local_add_blob_info(pg_id_t const pg_id, BlobInfo const& blob
                    // still get the up-to-date blob_sequence_num
                    !de.blob_sequence_num.compare_exchange_weak(existing_blob_id, next_blob_id)) {}
             de.active_blob_count.fetch_add(1, std::memory_order_relaxed);
-            de.total_occupied_blk_count.fetch_add(blob_info.pbas.blk_count(), std::memory_order_relaxed);
+            if (count_occupied_blks) {
+                de.total_occupied_blk_count.fetch_add(blob_info.pbas.blk_count(), std::memory_order_relaxed);
+            }
         });
     } else {
         BLOGT(tid, blob_info.shard_id, blob_info.blob_id, "blob already exists in index table, skip it.");
@@ -275,7 +732,7 @@ void HSHomeObject::on_blob_put_commit(int64_t lsn, sisl::blob const& header, sis
     blob_info.blob_id = blob_id;
     blob_info.pbas = pbas;
 
-    bool success = local_add_blob_info(pg_id, blob_info, tid);
+    bool success = local_add_blob_info(pg_id, blob_info, lsn, tid);
 
     if (ctx) {
         ctx->promise_.setValue(success ? BlobManager::Result< BlobInfo >(blob_info)
@@ -283,6 +740,58 @@ void HSHomeObject::on_blob_put_commit(int64_t lsn, sisl::blob const& header, sis
     }
 }
 
+void HSHomeObject::on_blob_batch_put_commit(int64_t lsn, sisl::blob const& header, sisl::blob const& key,
+                                            homestore::MultiBlkId const& pbas,
+                                            cintrusive< homestore::repl_req_ctx >& hs_ctx) {
+    LOGTRACEMOD(blobmgr, "blob batch put commit lsn={}, pbas={}", lsn, pbas.to_string());
+    repl_result_ctx< BlobManager::Result< BlobInfo > >* ctx{nullptr};
+    if (hs_ctx && hs_ctx->is_proposer()) {
+        ctx = boost::static_pointer_cast< repl_result_ctx< BlobManager::Result< BlobInfo > > >(hs_ctx).get();
+    }
+    trace_id_t tid = hs_ctx ? hs_ctx->traceID() : 0;
+    auto msg_header = r_cast< ReplicationMessageHeader const* >(header.cbytes());
+    if (msg_header->corrupted()) {
+        LOGE("replication message header is corrupted with crc error, lsn={}, traceID={}", lsn, tid);
+        if (ctx) { ctx->promise_.setValue(folly::makeUnexpected(BlobError(BlobErrorCode::CHECKSUM_MISMATCH))); }
+        return;
+    }
+
+    auto const num_entries = msg_header->payload_size / sizeof(BlobBatchEntry);
+    RELEASE_ASSERT(num_entries > 0 && msg_header->payload_size % sizeof(BlobBatchEntry) == 0 &&
+                       header.size() >= sizeof(ReplicationMessageHeader) + msg_header->payload_size,
+                   "invalid blob batch payload size={}, header size={}, lsn={}", msg_header->payload_size,
+                   header.size(), lsn);
+    auto const* entries = r_cast< BlobBatchEntry const* >(header.cbytes() + sizeof(ReplicationMessageHeader));
+    if (crc32_ieee(init_crc32, r_cast< uint8_t const* >(entries), msg_header->payload_size) !=
+        msg_header->payload_crc) {
+        LOGE("blob batch entries are corrupted with crc error, lsn={}, traceID={}", lsn, tid);
+        if (ctx) { ctx->promise_.setValue(folly::makeUnexpected(BlobError(BlobErrorCode::CHECKSUM_MISMATCH))); }
+        return;
+    }
+
+    bool success{true};
+    bool packed{false};
+    for (size_t i = 0; i < num_entries; ++i) {
+        auto const& entry = entries[i];
+        // Blobs sharing an extent are adjacent in the batch, the blocks are counted with the first of them.
+        bool const first_in_extent = (i == 0) || (entries[i - 1].blk_offset != entry.blk_offset);
+        packed = packed || !first_in_extent;
+        BlobInfo blob_info{msg_header->shard_id, entry.blob_id, slice_blkid(pbas, entry.blk_offset, entry.blk_count)};
+        if (!local_add_blob_info(msg_header->pg_id, blob_info, lsn, tid, first_in_extent)) { success = false; }
+    }
+    // set along with the index entries, before a delete of any of them can commit
+    if (packed) {
+        if (auto hs_shard = _get_hs_shard(msg_header->shard_id); hs_shard) { hs_shard->set_has_packed_blobs(); }
+    }
+
+    if (!ctx) { return; }
+    if (!success) {
+        ctx->promise_.setValue(folly::makeUnexpected(BlobError(BlobErrorCode::INDEX_ERROR)));
+        return;
+    }
+    ctx->promise_.setValue(BlobManager::Result< BlobInfo >(BlobInfo{msg_header->shard_id, entries[0].blob_id, pbas}));
+}
+
 BlobManager::AsyncResult< Blob > HSHomeObject::_get_blob(ShardInfo const& shard, blob_id_t blob_id, uint64_t req_offset,
                                                          uint64_t req_len, bool allow_skip_verify,
                                                          trace_id_t tid) const {
@@ -321,6 +830,29 @@ BlobManager::AsyncResult< Blob > HSHomeObject::_get_blob(ShardInfo const& shard,
 
     BLOGD(tid, shard.id, blob_id, "Blob Get request: pg={}, group={}, shard=0x{:x}, blob={}, offset={}, len={}", pg_id,
           repl_dev->group_id(), shard.id, blob_id, req_offset, req_len);
+
+    BlobRoute const route{shard.id, blob_id};
+    BlobReadCache::ticket_t cache_ticket{0};
+    if (blob_read_cache_) {
+        if (auto cached = blob_read_cache_->get(route); cached) {
+            auto ret = blob_from_cache(*cached, req_offset, req_len, repl_dev->get_leader_id());
+            if (!ret) {
+                BLOGE(tid, shard.id, blob_id, "Invalid range, blob size={}, offset={}, len={}", cached->body.size(),
+                      req_offset, req_len);
+            }
+            decr_pending_request_num();
+            return ret;
+        }
+        // taken before the index lookup, so a delete or gc move committed after it keeps a stale blob out
+        cache_ticket = blob_read_cache_->ticket(route);
+    }
+
+    if (auto hs_shard = _get_hs_shard(shard.id); hs_shard && !hs_shard->blob_filter_.maybe_contains(blob_id)) {
+        BLOGD(tid, shard.id, blob_id, "Blob not in the blob filter of the shard");
+        decr_pending_request_num();
+        return folly::makeUnexpected(BlobError(BlobErrorCode::UNKNOWN_BLOB));
+    }
+
     auto r = get_blob_from_index_table(index_table, shard.id, blob_id);
     if (!r) {
         BLOGE(tid, shard.id, blob_id, "Blob not found in index during get blob");
@@ -328,14 +860,37 @@ BlobManager::AsyncResult< Blob > HSHomeObject::_get_blob(ShardInfo const& shard,
         return folly::makeUnexpected(r.error());
     }
 
+    bool const cacheable = blob_read_cache_ && !allow_skip_verify && req_offset == 0 && req_len == 0;
+    auto const start = Clock::now();
     return _get_blob_data(repl_dev, shard.id, blob_id, req_offset, req_len, r.value() /* blkid*/, tid,
                           allow_skip_verify)
-        .deferValue([this](auto&& result) {
+        .deferValue([this, route, cache_ticket, cacheable, start, chunk_id = r.value().chunk_num()](auto&& result) {
+            // the latency of the reads served by the pdev drives the adaptive gc io rate on it
+            if (gc_mgr_) { gc_mgr_->record_client_io_latency(chunk_id, get_elapsed_time_us(start)); }
+            if (cacheable && result &&
+                result->body.size() <= HS_BACKEND_DYNAMIC_CONFIG(blob_read_cache_max_blob_size)) {
+                sisl::io_blob_safe body(result->body.size());
+                std::memcpy(body.bytes(), result->body.cbytes(), result->body.size());
+                blob_read_cache_->insert(route, cache_ticket,
+                                         BlobReadCache::Entry{std::move(body), result->user_key, result->object_off});
+            }
             decr_pending_request_num();
             return std::forward< decltype(result) >(result);
         });
 }
 
+BlobManager::Result< Blob > HSHomeObject::blob_from_cache(BlobReadCache::Entry const& cached, uint64_t req_offset,
+                                                          uint64_t req_len, peer_id_t leader_id) {
+    auto const blob_size = cached.body.size();
+    if (req_offset > blob_size || req_len > blob_size - req_offset) {
+        return folly::makeUnexpected(BlobError(BlobErrorCode::INVALID_ARG));
+    }
+    auto const len = req_len ? req_len : blob_size - req_offset;
+    sisl::io_blob_safe body(len);
+    std::memcpy(body.bytes(), cached.body.cbytes() + req_offset, len);
+    return Blob(std::move(body), cached.user_key, cached.object_off, leader_id);
+}
+
 BlobManager::AsyncResult< Blob > HSHomeObject::_get_blob_data(const shared< homestore::ReplDev >& repl_dev,
                                                               shard_id_t shard_id, blob_id_t blob_id,
                                                               uint64_t req_offset, uint64_t req_len,
@@ -345,12 +900,46 @@ BlobManager::AsyncResult< Blob > HSHomeObject::_get_blob_data(const shared< home
     auto const total_size = blkid.blk_count() * blk_size;
 
     // Use partial read path only when we can skip at least 1 data block (in addition to header)
-    // to make the optimization worthwhile. This requires req_len > 0 (known exact length).
-    if (allow_skip_verify && req_len > 0 &&
-        (req_offset >= blk_size || req_offset + req_len + blk_size <= total_size - _data_block_size)) {
+    // to make the optimization worthwhile. This requires req_len > 0 (known exact length). Extents which may be
+    // shared by packed blobs are small and always read in full.
+    bool const partial = req_len > 0 && total_size > max_packed_extent_size &&
+        (req_offset >= blk_size || req_offset + req_len + blk_size <= total_size - _data_block_size);
+    if (partial && allow_skip_verify) {
         return _get_blob_data_partial(repl_dev, shard_id, blob_id, req_offset, req_len, blkid, tid);
     }
 
+    // The layout of the blobs of the shard plans the other reads. Without allow_skip_verify the range is still read
+    // partially, but verified against the data crcs, while the blobs of the shard have them. A blob with an extent of
+    // its own is read straight into the buffer which becomes its body, once their data offset is known.
+    auto const hs_shard = total_size > max_packed_extent_size ? _get_hs_shard(shard_id) : nullptr;
+    if (partial && hs_shard && hs_shard->blob_data_crcs_hint()) {
+        return _get_blob_data_partial(repl_dev, shard_id, blob_id, req_offset, req_len, blkid, tid,
+                                      true /* verify_data_crcs */);
+    }
+    if (req_offset == 0 && hs_shard) {
+        auto const hdr_size = hs_shard ? hs_shard->blob_data_offset_hint() : 0;
+        if (hdr_size != 0 && hdr_size < total_size) {
+            return _get_blob_data_direct(repl_dev, shard_id, blob_id, req_len, blkid, hdr_size, tid);
+        }
+    }
+
+    return _get_blob_data_full(repl_dev, shard_id, blob_id, req_offset, req_len, blkid, tid);
+}
+
+void HSHomeObject::learn_blob_layout(shard_id_t shard_id, uint32_t data_offset, bool data_crcs) const {
+    // only an aligned data offset can start the data buffer of a direct read
+    if (data_offset == 0 || data_offset % io_align != 0) { return; }
+    if (auto const hs_shard = _get_hs_shard(shard_id); hs_shard) {
+        hs_shard->set_blob_layout_hint(data_offset, data_crcs);
+    }
+}
+
+BlobManager::AsyncResult< Blob > HSHomeObject::_get_blob_data_full(const shared< homestore::ReplDev >& repl_dev,
+                                                                   shard_id_t shard_id, blob_id_t blob_id,
+                                                                   uint64_t req_offset, uint64_t req_len,
+                                                                   const homestore::MultiBlkId& blkid,
+                                                                   trace_id_t tid) const {
+    auto const total_size = blkid.blk_count() * repl_dev->get_blk_size();
     sisl::io_blob_safe read_buf{total_size, io_align};
 
     sisl::sg_list sgs;
@@ -359,35 +948,292 @@ BlobManager::AsyncResult< Blob > HSHomeObject::_get_blob_data(const shared< home
 
     BLOGD(tid, shard_id, blob_id, "Reading from blkid={} to buf={}", blkid.to_string(), (void*)read_buf.bytes());
     return repl_dev->async_read(blkid, sgs, total_size)
-        .thenValue([this, tid, blob_id, shard_id, req_len, req_offset, blkid, repl_dev,
+        .thenValue([this, tid, blob_id, shard_id, req_len, req_offset, blkid, repl_dev, total_size,
                     read_buf = std::move(read_buf)](auto&& result) mutable -> BlobManager::AsyncResult< Blob > {
             if (result) {
                 BLOGE(tid, shard_id, blob_id, "Failed to get blob: err={}", blob_id, shard_id, result.value());
                 return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
             }
+            if (total_size > max_packed_extent_size) {
+                if (auto header = decode_blob_header(read_buf.cbytes()); header) {
+                    learn_blob_layout(shard_id, header->data_offset, header->data_crc_count != 0);
+                }
+            }
+            return extract_blob(read_buf.cbytes(), total_size, shard_id, blob_id, req_offset, req_len, blkid,
+                                repl_dev->get_leader_id(), tid);
+        });
+}
+
+BlobManager::AsyncResult< Blob > HSHomeObject::_get_blob_data_direct(const shared< homestore::ReplDev >& repl_dev,
+                                                                     shard_id_t shard_id, blob_id_t blob_id,
+                                                                     uint64_t req_len,
+                                                                     const homestore::MultiBlkId& blkid,
+                                                                     uint32_t hdr_size, trace_id_t tid) const {
+    auto const total_size = blkid.blk_count() * repl_dev->get_blk_size();
+
+    // The header goes to its own buffer of hdr_size. When the blob has that data offset, its data starts right at the
+    // beginning of data_buf.
+    sisl::io_blob_safe hdr_buf{hdr_size, io_align};
+    sisl::io_blob_safe data_buf{total_size - hdr_size, io_align};
+
+    sisl::sg_list sgs;
+    sgs.size = total_size;
+    sgs.iovs.emplace_back(iovec{.iov_base = hdr_buf.bytes(), .iov_len = hdr_buf.size()});
+    sgs.iovs.emplace_back(iovec{.iov_base = data_buf.bytes(), .iov_len = data_buf.size()});
+
+    BLOGD(tid, shard_id, blob_id, "Reading from blkid={} to hdr_buf={}, data_buf={}", blkid.to_string(),
+          (void*)hdr_buf.bytes(), (void*)data_buf.bytes());
+    return repl_dev->async_read(blkid, sgs, total_size)
+        .thenValue([this, tid, blob_id, shard_id, req_len, blkid, repl_dev, total_size, hdr_buf = std::move(hdr_buf),
+                    data_buf = std::move(data_buf)](auto&& result) mutable -> BlobManager::AsyncResult< Blob > {
+            if (result) {
+                BLOGE(tid, shard_id, blob_id, "Failed to get blob: err={}", result.value());
+                return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
+            }
 
-            auto verify_result = do_verify_blob(read_buf.cbytes(), shard_id, 0 /* no blob_id check */);
-            if (!verify_result.hasValue()) {
-                return folly::makeUnexpected(verify_result.error());
+            auto const header_size = blob_header_size(hdr_buf.cbytes());
+            auto header = (header_size != 0 && header_size <= hdr_buf.size())
+                ? decode_blob_header(hdr_buf.cbytes())
+                : std::nullopt;
+            if (!header || header->data_offset != hdr_buf.size()) {
+                // Written with the other header format or with a header larger than hdr_buf, fall back to copying and
+                // plan the next read of the shard with this layout
+                BLOGD(tid, shard_id, blob_id, "Blob data not at offset={}, copying it out of blkid={}", hdr_buf.size(),
+                      blkid.to_string());
+                sisl::io_blob_safe record{total_size, io_align};
+                std::memcpy(record.bytes(), hdr_buf.cbytes(), hdr_buf.size());
+                std::memcpy(record.bytes() + hdr_buf.size(), data_buf.cbytes(), data_buf.size());
+                if (!header) { header = decode_blob_header(record.cbytes()); }
+                if (header) { learn_blob_layout(shard_id, header->data_offset, header->data_crc_count != 0); }
+                return extract_blob(record.cbytes(), total_size, shard_id, blob_id, 0 /* req_offset */, req_len, blkid,
+                                    repl_dev->get_leader_id(), tid);
             }
-            std::string user_key = std::move(verify_result.value());
 
-            BlobHeader const* header = r_cast< BlobHeader const* >(read_buf.cbytes());
-            if (req_offset + req_len > header->blob_size) {
-                BLOGE(tid, shard_id, blob_id, "Invalid offset length requested in get blob offset={} len={} size={}",
-                      req_offset, req_len, header->blob_size);
+            learn_blob_layout(shard_id, header->data_offset, header->data_crc_count != 0);
+            auto verify_result =
+                do_verify_blob(hdr_buf.cbytes(), shard_id, 0 /* no blob_id check */, data_buf.cbytes());
+            if (!verify_result.hasValue()) { return folly::makeUnexpected(verify_result.error()); }
+            auto& verified = verify_result.value();
+            if (verified.blob_hdr_version == CompactBlobHeader::blob_header_version && verified.blob_id != blob_id) {
+                BLOGE(tid, shard_id, blob_id, "blob not found in extent blkid={}, blob in header={}", blkid.to_string(),
+                      verified.blob_id);
+                return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
+            }
+            if (req_len > verified.blob_size) {
+                BLOGE(tid, shard_id, blob_id, "Invalid length requested in get blob len={} size={}", req_len,
+                      verified.blob_size);
                 return folly::makeUnexpected(BlobError(BlobErrorCode::INVALID_ARG));
             }
 
-            // Copy the blob bytes from the offset. If request len is 0, take the
-            // whole blob size else copy only the request length.
-            auto res_len = req_len == 0 ? header->blob_size - req_offset : req_len;
-            auto body = sisl::io_blob_safe(res_len);
-            uint8_t const* blob_bytes = read_buf.bytes() + header->data_offset;
-            std::memcpy(body.bytes(), blob_bytes + req_offset, res_len);
-
+            data_buf.set_size(req_len == 0 ? verified.blob_size : req_len);
             BLOGD(tid, shard_id, blob_id, "Blob get success: blkid={}", blkid.to_string());
-            return Blob(std::move(body), std::move(user_key), header->object_offset, repl_dev->get_leader_id());
+            return Blob(std::move(data_buf), std::move(verified.user_key), verified.object_offset,
+                        repl_dev->get_leader_id());
+        });
+}
+
+BlobManager::Result< Blob > HSHomeObject::extract_blob(uint8_t const* extent, uint64_t extent_size,
+                                                       shard_id_t shard_id, blob_id_t blob_id, uint64_t req_offset,
+                                                       uint64_t req_len, homestore::MultiBlkId const& blkid,
+                                                       peer_id_t const& leader_id, trace_id_t tid) const {
+    uint8_t const* record = extent + locate_blob_record(extent, extent_size, blob_id);
+    auto verify_result = do_verify_blob(record, shard_id, 0 /* no blob_id check */);
+    if (!verify_result.hasValue()) { return folly::makeUnexpected(verify_result.error()); }
+    auto& header = verify_result.value();
+    if (header.blob_hdr_version == CompactBlobHeader::blob_header_version && header.blob_id != blob_id) {
+        BLOGE(tid, shard_id, blob_id, "blob not found in extent blkid={}, first blob={}", blkid.to_string(),
+              header.blob_id);
+        return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
+    }
+
+    if (req_offset + req_len > header.blob_size) {
+        BLOGE(tid, shard_id, blob_id, "Invalid offset length requested in get blob offset={} len={} size={}",
+              req_offset, req_len, header.blob_size);
+        return folly::makeUnexpected(BlobError(BlobErrorCode::INVALID_ARG));
+    }
+
+    // Copy the blob bytes from the offset. If request len is 0, take the
+    // whole blob size else copy only the request length.
+    auto res_len = req_len == 0 ? header.blob_size - req_offset : req_len;
+    auto body = sisl::io_blob_safe(res_len);
+    uint8_t const* blob_bytes = record + header.data_offset;
+    std::memcpy(body.bytes(), blob_bytes + req_offset, res_len);
+
+    BLOGD(tid, shard_id, blob_id, "Blob get success: blkid={}", blkid.to_string());
+    return Blob(std::move(body), std::move(header.user_key), header.object_offset, leader_id);
+}
+
+BlobManager::AsyncResult< std::vector< BlobManager::Result< Blob > > >
+HSHomeObject::_get_blob_batch(ShardInfo const& shard, std::vector< blob_id_t > const& blob_ids, trace_id_t tid) const {
+    if (is_shutting_down()) {
+        LOGI("service is being shutdown");
+        return folly::makeUnexpected(BlobErrorCode::SHUTTING_DOWN);
+    }
+    incr_pending_request_num();
+    auto& pg_id = shard.placement_group;
+    auto hs_pg = get_hs_pg(pg_id);
+    RELEASE_ASSERT(hs_pg, "PG not found");
+    auto repl_dev = hs_pg->repl_dev_;
+    auto index_table = hs_pg->index_table_;
+
+    RELEASE_ASSERT(repl_dev != nullptr, "Repl dev instance null");
+    RELEASE_ASSERT(index_table != nullptr, "Index table instance null");
+
+    // see _get_blob for why this is configurable
+    if (HS_BACKEND_DYNAMIC_CONFIG(check_traffic_ready_before_get) && !repl_dev->is_ready_for_traffic()) {
+        LOGW("failed to get blob batch for pg={}, shardID=0x{:x},pg={},shard=0x{:x}, not ready for traffic", pg_id,
+             shard.id, (shard.id >> homeobject::shard_width), (shard.id & homeobject::shard_mask));
+        decr_pending_request_num();
+        return folly::makeUnexpected(BlobError(BlobErrorCode::RETRY_REQUEST));
+    }
+
+    LOGD("Blob batch get request: traceID={}, pg={}, group={}, shard=0x{:x}, blobs={}", tid, pg_id,
+         repl_dev->group_id(), shard.id, blob_ids.size());
+
+    // Resolve the routes with one range query per run of requested blob ids, only the requested live blobs are
+    // returned. A run ends where the next requested id is more than max_batch_query_gap away, so that a sparse request
+    // does not sweep all the blobs in between. Entries left out by the filter still count against the batch size of a
+    // query, so it covers every blob id of its run, and it goes on for as long as the index has more of them.
+    std::vector< blob_id_t > sorted_ids{blob_ids};
+    std::sort(sorted_ids.begin(), sorted_ids.end());
+    sorted_ids.erase(std::unique(sorted_ids.begin(), sorted_ids.end()), sorted_ids.end());
+
+    std::vector< std::pair< BlobRouteKey, BlobRouteValue > > routes;
+    for (auto run_begin = sorted_ids.cbegin(); run_begin != sorted_ids.cend();) {
+        auto run_end = std::next(run_begin);
+        while (run_end != sorted_ids.cend() && *run_end - *std::prev(run_end) <= max_batch_query_gap) {
+            ++run_end;
+        }
+        auto const first_id = *run_begin;
+        auto const last_id = *std::prev(run_end);
+        auto const range_size = std::min< uint64_t >(last_id - first_id + 1, std::numeric_limits< uint32_t >::max());
+        homestore::BtreeQueryRequest< BlobRouteKey > query_req{
+            homestore::BtreeKeyRange< BlobRouteKey >{BlobRouteKey{BlobRoute{shard.id, first_id}}, true /* inclusive */,
+                                                     BlobRouteKey{BlobRoute{shard.id, last_id}}, true /* inclusive */},
+            homestore::BtreeQueryType::SWEEP_NON_INTRUSIVE_PAGINATION_QUERY, static_cast< uint32_t >(range_size),
+            [run_begin, run_end](homestore::BtreeKey const& key, homestore::BtreeValue const& value) -> bool {
+                if (BlobRouteValue{value}.pbas() == HSHomeObject::tombstone_pbas) { return false; }
+                return std::binary_search(run_begin, run_end, BlobRouteKey{key}.key().blob);
+            }};
+        auto status = index_table->query(query_req, routes);
+        while (status == homestore::btree_status_t::has_more) {
+            status = index_table->query(query_req, routes);
+        }
+        if (status != homestore::btree_status_t::success) {
+            LOGE("Failed to query blobs in index table for status={}, traceID={}, shard=0x{:x}", status, tid,
+                 shard.id);
+            decr_pending_request_num();
+            return folly::makeUnexpected(BlobError(BlobErrorCode::INDEX_ERROR));
+        }
+        run_begin = run_end;
+    }
+
+    // A blob which is not found keeps UNKNOWN_BLOB, the same blob may be requested more than once.
+    struct batch_extent {
+        homestore::MultiBlkId pbas;
+        std::vector< size_t > result_idx;
+    };
+    struct coalesced_read {
+        homestore::MultiBlkId blkid;
+        size_t extent_begin;
+        size_t extent_end;
+        sisl::io_blob_safe buf;
+    };
+    struct batch_read_state {
+        std::vector< blob_id_t > blob_ids;
+        std::vector< BlobManager::Result< Blob > > results;
+        std::vector< batch_extent > extents;
+        std::vector< coalesced_read > reads;
+    };
+    auto state = std::make_shared< batch_read_state >();
+    state->blob_ids = blob_ids;
+    state->results.reserve(blob_ids.size());
+    std::unordered_map< blob_id_t, std::vector< size_t > > result_idx;
+    for (size_t i = 0; i < blob_ids.size(); ++i) {
+        state->results.emplace_back(folly::makeUnexpected(BlobError(BlobErrorCode::UNKNOWN_BLOB)));
+        result_idx[blob_ids[i]].push_back(i);
+    }
+
+    // Sort the routes by physical location, blobs packed into one extent share the read of it.
+    std::vector< BlobInfo > located;
+    located.reserve(routes.size());
+    for (auto const& [key, value] : routes) {
+        located.push_back(BlobInfo{shard.id, key.key().blob, value.pbas()});
+    }
+    std::sort(located.begin(), located.end(), [](BlobInfo const& l, BlobInfo const& r) {
+        if (l.pbas.chunk_num() != r.pbas.chunk_num()) { return l.pbas.chunk_num() < r.pbas.chunk_num(); }
+        if (l.pbas.blk_num() != r.pbas.blk_num()) { return l.pbas.blk_num() < r.pbas.blk_num(); }
+        return l.blob_id < r.blob_id;
+    });
+    for (auto const& info : located) {
+        auto const& idx = result_idx[info.blob_id];
+        if (state->extents.empty() || !(state->extents.back().pbas == info.pbas)) {
+            state->extents.push_back(batch_extent{info.pbas, {}});
+        }
+        auto& extent_idx = state->extents.back().result_idx;
+        extent_idx.insert(extent_idx.end(), idx.begin(), idx.end());
+    }
+
+    // Merge physically adjacent extents into one read, bounded by blob_get_batch_max_read_size.
+    auto const blk_size = repl_dev->get_blk_size();
+    uint32_t const max_read_blks =
+        std::clamp< uint32_t >(HS_BACKEND_DYNAMIC_CONFIG(blob_get_batch_max_read_size) / blk_size, 1,
+                               std::numeric_limits< homestore::blk_count_t >::max());
+    for (size_t i = 0; i < state->extents.size();) {
+        auto const& first = state->extents[i].pbas;
+        uint32_t blk_count = first.blk_count();
+        size_t end = i + 1;
+        for (; end < state->extents.size(); ++end) {
+            auto const& next = state->extents[end].pbas;
+            if (next.chunk_num() != first.chunk_num() || next.blk_num() != first.blk_num() + blk_count ||
+                blk_count + next.blk_count() > max_read_blks) {
+                break;
+            }
+            blk_count += next.blk_count();
+        }
+        homestore::MultiBlkId read_blkid;
+        read_blkid.add(first.blk_num(), s_cast< homestore::blk_count_t >(blk_count), first.chunk_num());
+        state->reads.push_back(
+            coalesced_read{std::move(read_blkid), i, end, sisl::io_blob_safe{blk_count * blk_size, io_align}});
+        i = end;
+    }
+    LOGD("Blob batch get: traceID={}, shard=0x{:x}, found={}, extents={}, reads={}", tid, shard.id, located.size(),
+         state->extents.size(), state->reads.size());
+
+    auto const leader_id = repl_dev->get_leader_id();
+    std::vector< folly::Future< folly::Unit > > futs;
+    futs.reserve(state->reads.size());
+    for (auto& read : state->reads) {
+        sisl::sg_list sgs;
+        sgs.size = read.buf.size();
+        sgs.iovs.emplace_back(iovec{.iov_base = read.buf.bytes(), .iov_len = read.buf.size()});
+        futs.emplace_back(
+            repl_dev->async_read(read.blkid, sgs, read.buf.size())
+                .thenValue([this, state, &read, shard_id = shard.id, leader_id, blk_size, tid](auto&& err) {
+                    auto const& blob_ids = state->blob_ids;
+                    for (auto e = read.extent_begin; e < read.extent_end; ++e) {
+                        auto const& extent = state->extents[e];
+                        uint64_t const offset = (extent.pbas.blk_num() - read.blkid.blk_num()) * blk_size;
+                        uint64_t const size = extent.pbas.blk_count() * blk_size;
+                        for (auto const i : extent.result_idx) {
+                            if (err) {
+                                BLOGE(tid, shard_id, blob_ids[i], "Failed to read blkid={}: err={}",
+                                      read.blkid.to_string(), err.message());
+                                state->results[i] = folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
+                                continue;
+                            }
+                            state->results[i] = extract_blob(read.buf.cbytes() + offset, size, shard_id, blob_ids[i],
+                                                             0 /* req_offset */, 0 /* req_len */, extent.pbas,
+                                                             leader_id, tid);
+                        }
+                    }
+                }));
+    }
+
+    return folly::collectAllUnsafe(std::move(futs))
+        .deferValue([this, state](auto&&) -> BlobManager::Result< std::vector< BlobManager::Result< Blob > > > {
+            decr_pending_request_num();
+            return std::move(state->results);
         });
 }
 
@@ -395,25 +1241,42 @@ BlobManager::AsyncResult< Blob > HSHomeObject::_get_blob_data_partial(const shar
                                                                       shard_id_t shard_id, blob_id_t blob_id,
                                                                       uint64_t req_offset, uint64_t req_len,
                                                                       const homestore::MultiBlkId& blkid,
-                                                                      trace_id_t tid) const {
+                                                                      trace_id_t tid, bool verify_data_crcs) const {
     auto const blk_size = repl_dev->get_blk_size();
 
-    // In v4, BlobHeader is fixed at _data_block_size (4KB), and data starts immediately after
-    // We can skip reading the header entirely for partial reads that don't overlap with it
-    auto const fixed_data_offset = _data_block_size;
-
-    // Calculate byte range within the storage (including header)
-    auto const read_start_byte = fixed_data_offset + req_offset;
-    auto const read_end_byte = read_start_byte + req_len;
+    // Payload range to read. Verifying it takes the whole data crc chunks covering it, whose size is only known once
+    // the header is read. The chunk size grows with the blob size in powers of two, so the one of a blob filling the
+    // whole extent is an upper bound and a multiple of it: aligning the range to it covers every chunk it touches.
+    uint64_t read_offset{req_offset};
+    uint64_t read_end{req_offset + req_len};
+    if (verify_data_crcs) {
+        uint64_t const max_chunk_size = uint64_t{1}
+            << CompactBlobHeader::data_crc_chunk_shift_for(uint64_t{blkid.blk_count()} * blk_size);
+        read_offset = read_offset / max_chunk_size * max_chunk_size;
+        read_end = sisl::round_up(read_end, max_chunk_size);
+    }
 
-    // Calculate which blocks we need to read
-    uint32_t start_blk = read_start_byte / blk_size;
-    uint32_t num_blks = (read_end_byte + blk_size - 1) / blk_size - start_blk;
-    uint32_t read_size = num_blks * blk_size;
+    // The data offset depends on the header format: BlobHeader places the data at _data_block_size, while
+    // CompactBlobHeader places it right after the header. So we read the requested range for any data offset in
+    // [sizeof(CompactBlobHeader), _data_block_size], together with the first block which holds the header and tells
+    // which one applies. The body is still skipped, only the header block is added to the read.
+    uint32_t start_blk = (sizeof(CompactBlobHeader) + read_offset) / blk_size;
+    uint32_t const end_blk =
+        std::min< uint64_t >((_data_block_size + read_end + blk_size - 1) / blk_size, blkid.blk_count());
 
-    // Create MultiBlkId for the range we need
+    // Offset in the read buffer where the block start_blk lands.
+    uint32_t range_buf_offset{0};
     homestore::MultiBlkId read_blkid;
-    read_blkid.add(blkid.blk_num() + start_blk, num_blks, blkid.chunk_num());
+    if (start_blk <= 1) {
+        // header block and requested range are contiguous
+        start_blk = 0;
+        read_blkid.add(blkid.blk_num(), end_blk, blkid.chunk_num());
+    } else {
+        range_buf_offset = blk_size;
+        read_blkid.add(blkid.blk_num(), 1, blkid.chunk_num());
+        read_blkid.add(blkid.blk_num() + start_blk, end_blk - start_blk, blkid.chunk_num());
+    }
+    uint32_t const read_size = read_blkid.blk_count() * blk_size;
 
     sisl::io_blob_safe read_buf{read_size, io_align};
     sisl::sg_list sgs;
@@ -421,37 +1284,98 @@ BlobManager::AsyncResult< Blob > HSHomeObject::_get_blob_data_partial(const shar
     sgs.iovs.emplace_back(iovec{.iov_base = read_buf.bytes(), .iov_len = read_buf.size()});
 
     BLOGD(tid, shard_id, blob_id,
-          "Reading partial data: offset={}, len={}, full_blkid={}, read_blkid={}, start_blk={}, num_blks={}",
-          req_offset, req_len, blkid.to_string(), read_blkid.to_string(), start_blk, num_blks);
+          "Reading partial data: offset={}, len={}, full_blkid={}, read_blkid={}, start_blk={}, end_blk={}, "
+          "verify_data_crcs={}",
+          req_offset, req_len, blkid.to_string(), read_blkid.to_string(), start_blk, end_blk, verify_data_crcs);
 
     return repl_dev->async_read(read_blkid, sgs, read_size)
-        .thenValue([tid, blob_id, shard_id, req_offset, req_len, blkid, repl_dev, start_blk, blk_size,
+        .thenValue([this, tid, blob_id, shard_id, req_offset, req_len, blkid, repl_dev, start_blk, end_blk, blk_size,
+                    range_buf_offset, verify_data_crcs,
                     read_buf = std::move(read_buf)](auto&& result) mutable -> BlobManager::AsyncResult< Blob > {
             if (result) {
                 BLOGE(tid, shard_id, blob_id, "Failed to read partial data: err={}", result.value());
                 return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
             }
 
+            // The payload hash covers the whole blob and can not be checked here, only the header and, if asked for,
+            // the data crc chunks covering the requested range are verified.
+            auto header = decode_blob_header(read_buf.cbytes());
+            if (!header) {
+                BLOGE(tid, shard_id, blob_id, "Invalid header found in partial read: [header={}]",
+                      blob_header_to_string(read_buf.cbytes()));
+                return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
+            }
+            if (header->shard_id != shard_id ||
+                (header->blob_hdr_version == CompactBlobHeader::blob_header_version && header->blob_id != blob_id)) {
+                BLOGE(tid, shard_id, blob_id, "Invalid shard_id or blob_id in header: [header={}]",
+                      blob_header_to_string(read_buf.cbytes()));
+                return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
+            }
+            if (req_offset + req_len > header->blob_size) {
+                BLOGE(tid, shard_id, blob_id, "Invalid offset length requested in get blob offset={} len={} size={}",
+                      req_offset, req_len, header->blob_size);
+                return folly::makeUnexpected(BlobError(BlobErrorCode::INVALID_ARG));
+            }
+
+            learn_blob_layout(shard_id, header->data_offset, header->data_crc_count != 0);
+            if (verify_data_crcs && header->data_crc_count == 0) {
+                BLOGD(tid, shard_id, blob_id, "Blob has no data crcs, reading it in full: blkid={}",
+                      blkid.to_string());
+                return _get_blob_data_full(repl_dev, shard_id, blob_id, req_offset, req_len, blkid, tid);
+            }
+
             // Calculate offset within read buffer
-            auto const data_start_in_storage = _data_block_size;
-            auto const req_start_in_storage = data_start_in_storage + req_offset;
-            auto const read_start_in_storage = start_blk * blk_size;
-            auto const offset_in_buf = req_start_in_storage - read_start_in_storage;
+            uint64_t const range_start_in_storage = static_cast< uint64_t >(start_blk) * blk_size;
+            uint64_t const range_end_in_storage = static_cast< uint64_t >(end_blk) * blk_size;
+            auto in_read_range = [&](uint64_t offset, uint64_t len) {
+                auto const start = header->data_offset + offset;
+                return start >= range_start_in_storage && start + len <= range_end_in_storage;
+            };
+            auto read_bytes = [&](uint64_t offset) -> uint8_t* {
+                return read_buf.bytes() + range_buf_offset + (header->data_offset + offset - range_start_in_storage);
+            };
+            if (!in_read_range(req_offset, req_len)) {
+                BLOGE(tid, shard_id, blob_id, "Unexpected data_offset={} in header, read range=[{}, {}) blks",
+                      header->data_offset, start_blk, end_blk);
+                return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
+            }
 
-            uint8_t const* blob_bytes = read_buf.bytes() + offset_in_buf;
+            if (verify_data_crcs) {
+                auto const chunk_size = header->data_crc_chunk_size;
+                for (auto chunk = uint32_cast(req_offset / chunk_size);
+                     chunk < uint32_cast((req_offset + req_len + chunk_size - 1) / chunk_size); ++chunk) {
+                    uint64_t const chunk_offset = chunk * chunk_size;
+                    uint64_t const chunk_len = std::min< uint64_t >(chunk_size, header->blob_size - chunk_offset);
+                    if (!in_read_range(chunk_offset, chunk_len)) {
+                        BLOGE(tid, shard_id, blob_id, "Data crc chunk={} size={} out of read range=[{}, {}) blks",
+                              chunk, chunk_size, start_blk, end_blk);
+                        return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
+                    }
+                    auto const crc = crc32c(0, read_bytes(chunk_offset), chunk_len);
+                    if (crc != header->data_crc(chunk)) {
+                        BLOGE(tid, shard_id, blob_id,
+                              "Data crc mismatch in partial read: chunk={} size={} computed={:#x} stored={:#x}",
+                              chunk, chunk_size, crc, header->data_crc(chunk));
+                        return folly::makeUnexpected(BlobError(BlobErrorCode::CHECKSUM_MISMATCH));
+                    }
+                }
+            }
+            uint8_t const* blob_bytes = read_bytes(req_offset);
 
-            // Copy the requested blob bytes
-            auto body = sisl::io_blob_safe(req_len);
-            std::memcpy(body.bytes(), blob_bytes, req_len);
+            // Move the requested bytes to the front of the read buffer and hand it out as the body, instead of
+            // copying them into a newly allocated one.
+            std::memmove(read_buf.bytes(), blob_bytes, req_len);
+            read_buf.set_size(req_len);
 
             BLOGD(tid, shard_id, blob_id, "Blob partial get success: blkid={}", blkid.to_string());
-            // user_key and object_offset are not available in partial read mode
-            return Blob(std::move(body), std::string{}, 0 /* object_offset */, repl_dev->get_leader_id());
+            return Blob(std::move(read_buf), std::move(header->user_key), header->object_offset,
+                        repl_dev->get_leader_id());
         });
 }
 
 homestore::ReplResult< homestore::blk_alloc_hints >
-HSHomeObject::blob_put_get_blk_alloc_hints(sisl::blob const& header, cintrusive< homestore::repl_req_ctx >& hs_ctx) {
+HSHomeObject::blob_put_get_blk_alloc_hints(sisl::blob const& header, uint32_t data_size,
+                                           cintrusive< homestore::repl_req_ctx >& hs_ctx) {
     repl_result_ctx< BlobManager::Result< BlobInfo > >* ctx{nullptr};
     if (hs_ctx && hs_ctx->is_proposer()) {
         ctx = boost::static_pointer_cast< repl_result_ctx< BlobManager::Result< BlobInfo > > >(hs_ctx).get();
@@ -478,9 +1402,9 @@ HSHomeObject::blob_put_get_blk_alloc_hints(sisl::blob const& header, cintrusive<
         return folly::makeUnexpected(homestore::ReplServiceError::RESULT_NOT_EXIST_YET);
     }
 
-    std::scoped_lock lock_guard(_shard_lock);
-    auto shard_iter = _shard_map.find(msg_header->shard_id);
-    if (shard_iter == _shard_map.end()) {
+    // lock free, this is called for every blob put on every member
+    auto hs_shard = _get_hs_shard(msg_header->shard_id);
+    if (hs_shard == nullptr) {
         LOGW("traceID={}, shardID=0x{:x}, pg={}, shard=0x{:x}, Received a blob_put on an unknown shard, underlying "
              "engine will retry this later",
              tid, msg_header->shard_id, (msg_header->shard_id >> homeobject::shard_width),
@@ -489,18 +1413,19 @@ HSHomeObject::blob_put_get_blk_alloc_hints(sisl::blob const& header, cintrusive<
         return folly::makeUnexpected(homestore::ReplServiceError::RESULT_NOT_EXIST_YET);
     }
 
-    auto hs_shard = d_cast< HS_Shard* >((*shard_iter->second).get());
-
+    auto const p_chunk_id = hs_shard->p_chunk_id();
     homestore::blk_alloc_hints hints;
-    hints.chunk_id_hint = hs_shard->sb_->p_chunk_id;
+    hints.chunk_id_hint = p_chunk_id;
     if (hs_ctx->is_proposer()) { hints.reserved_blks = get_reserved_blks(); }
-    BLOGD(tid, msg_header->shard_id, msg_header->blob_id, "Picked p_chunk_id={}, reserved_blks={}",
-          hs_shard->sb_->p_chunk_id, get_reserved_blks());
+    BLOGD(tid, msg_header->shard_id, msg_header->blob_id, "Picked p_chunk_id={}, reserved_blks={}", p_chunk_id,
+          get_reserved_blks());
 
     if (msg_header->blob_id != 0) {
         // check if the blob already exists, if yes, return the blk id
         auto r = get_blob_from_index_table(hs_pg->index_table_, msg_header->shard_id, msg_header->blob_id);
-        if (r.hasValue()) {
+        // a batch may span several extents, its blkids are only known if the extent of its first blob covers all
+        if (r.hasValue() && (msg_header->msg_type == ReplicationMessageType::PUT_BLOB_MSG ||
+                             r.value().blk_count() * hs_pg->repl_dev_->get_blk_size() == data_size)) {
             BLOGT(tid, msg_header->shard_id, msg_header->blob_id,
                   "Blob has already been persisted, blk_num={}, blk_count={}", r.value().blk_num(),
                   r.value().blk_count());
@@ -610,6 +1535,7 @@ void HSHomeObject::on_blob_del_commit(int64_t lsn, sisl::blob const& header, sis
                                                 &existing_value};
 
     auto status = index_table->put(update_req);
+    invalidate_cached_blob(shard_id, blob_id);
 
     if (sisl_unlikely(status == homestore::btree_status_t::not_found)) {
         // in baseline resync case, the blob might have already been deleted at leader and follower does not receive
@@ -624,44 +1550,90 @@ void HSHomeObject::on_blob_del_commit(int64_t lsn, sisl::blob const& header, sis
         LOGD("shard_id={}, blob_id={} has been moved to tombstone, lsn={}", shard_id, blob_id, lsn);
 
         auto existing_pbas = existing_value.pbas();
-        if (sisl_likely(existing_pbas != tombstone_pbas)) {
-            repl_dev->async_free_blks(lsn, existing_pbas).thenValue([hs_pg](auto&& err) {
-                if (err) {
-                    // even if async_free_blks fails, as the blob is already updated to tombstone, it will be gc
-                    // eventually.
-                    LOGE("Failed to free blocks for tombstoned blob, error={}", err.value());
-                }
-                const_cast< HS_PG* >(hs_pg)->durable_entities_update([](auto& de) {
-                    de.active_blob_count.fetch_sub(1, std::memory_order_relaxed);
-                    de.tombstone_blob_count.fetch_add(1, std::memory_order_relaxed);
-                });
-            });
-        } else {
+        if (sisl_unlikely(existing_pbas == tombstone_pbas)) {
             LOGW("shard_id={}, blob_id={} already tombstoned, lsn={}", shard_id, blob_id, lsn);
+        } else {
+            // counted by the commit itself rather than once the blks are freed, so that the counters persisted by a
+            // cp never miss a delete older than their lsn
+            const_cast< HS_PG* >(hs_pg)->durable_entities_update_at(lsn, [](auto& de) {
+                de.active_blob_count.fetch_sub(1, std::memory_order_relaxed);
+                de.tombstone_blob_count.fetch_add(1, std::memory_order_relaxed);
+            });
+            if (sisl_unlikely(may_share_extent(shard_id, existing_pbas) &&
+                              is_extent_shared(index_table, shard_id, blob_id, existing_pbas))) {
+                // other blobs packed into this extent are still alive, the extent is freed along with the last of
+                // them
+                LOGD("shard_id={}, blob_id={} shares pbas={} with live blobs, lsn={}", shard_id, blob_id,
+                     existing_pbas.to_string(), lsn);
+            } else {
+                repl_dev->async_free_blks(lsn, existing_pbas).thenValue([](auto&& err) {
+                    if (err) {
+                        // even if async_free_blks fails, as the blob is already updated to tombstone, it will be gc
+                        // eventually.
+                        LOGE("Failed to free blocks for tombstoned blob, error={}", err.value());
+                    }
+                });
+                if (gc_mgr_) { gc_mgr_->add_chunk_garbage(existing_pbas.chunk_num(), existing_pbas.blk_count()); }
+            }
         }
     }
 
     if (ctx) { ctx->promise_.setValue(BlobManager::Result< BlobInfo >({shard_id, blob_id, tombstone_pbas})); }
 }
 
-void HSHomeObject::compute_blob_payload_hash(BlobHeader::HashAlgorithm algorithm, const uint8_t* blob_bytes,
-                                             size_t blob_size, uint8_t* hash_bytes, size_t hash_len) const {
+void HSHomeObject::compute_blob_payload_hash(BlobHeader::HashAlgorithm algorithm, std::vector< iovec > const& frags,
+                                             uint8_t* hash_bytes, size_t hash_len) const {
     std::memset(hash_bytes, 0, hash_len);
     switch (algorithm) {
     case HSHomeObject::BlobHeader::HashAlgorithm::NONE: {
         break;
     }
     case HSHomeObject::BlobHeader::HashAlgorithm::CRC32: {
-        auto hash32 = crc32_ieee(init_crc32, blob_bytes, blob_size);
+        auto hash32 = init_crc32;
+        for (auto const& frag : frags) {
+            hash32 = crc32_ieee(hash32, r_cast< uint8_t const* >(frag.iov_base), frag.iov_len);
+        }
+        RELEASE_ASSERT(sizeof(uint32_t) <= hash_len, "Hash length invalid");
+        std::memcpy(hash_bytes, r_cast< uint8_t* >(&hash32), sizeof(uint32_t));
+        break;
+    }
+    case HSHomeObject::BlobHeader::HashAlgorithm::CRC32C: {
+        uint32_t hash32{0};
+        for (auto const& frag : frags) {
+            hash32 = crc32c(hash32, r_cast< uint8_t const* >(frag.iov_base), frag.iov_len);
+        }
         RELEASE_ASSERT(sizeof(uint32_t) <= hash_len, "Hash length invalid");
         std::memcpy(hash_bytes, r_cast< uint8_t* >(&hash32), sizeof(uint32_t));
         break;
     }
+    case HSHomeObject::BlobHeader::HashAlgorithm::XXH3_64: {
+        XXH64_hash_t hash64;
+        if (frags.size() == 1) {
+            hash64 = XXH3_64bits(frags.front().iov_base, frags.front().iov_len);
+        } else {
+            XXH3_state_t state;
+            XXH3_INITSTATE(&state);
+            XXH3_64bits_reset(&state);
+            for (auto const& frag : frags) {
+                XXH3_64bits_update(&state, frag.iov_base, frag.iov_len);
+            }
+            hash64 = XXH3_64bits_digest(&state);
+        }
+        RELEASE_ASSERT(sizeof(uint64_t) <= hash_len, "Hash length invalid");
+        std::memcpy(hash_bytes, r_cast< uint8_t* >(&hash64), sizeof(uint64_t));
+        break;
+    }
     default:
         RELEASE_ASSERT(false, "Hash not implemented");
     }
 }
 
+void HSHomeObject::compute_blob_payload_hash(BlobHeader::HashAlgorithm algorithm, const uint8_t* blob_bytes,
+                                             size_t blob_size, uint8_t* hash_bytes, size_t hash_len) const {
+    compute_blob_payload_hash(algorithm, {iovec{.iov_base = const_cast< uint8_t* >(blob_bytes), .iov_len = blob_size}},
+                              hash_bytes, hash_len);
+}
+
 void HSHomeObject::on_blob_message_rollback(int64_t lsn, sisl::blob const& header, sisl::blob const& key,
                                             cintrusive< homestore::repl_req_ctx >& hs_ctx) {
     repl_result_ctx< BlobManager::Result< BlobInfo > >* ctx{nullptr};
@@ -678,6 +1650,7 @@ void HSHomeObject::on_blob_message_rollback(int64_t lsn, sisl::blob const& heade
 
     switch (msg_header->msg_type) {
     case ReplicationMessageType::PUT_BLOB_MSG:
+    case ReplicationMessageType::PUT_BLOB_BATCH_MSG:
     case ReplicationMessageType::DEL_BLOB_MSG: {
         // TODO:: add rollback logic for put_blob and del_blob if necessary
         LOGI("traceID={}, lsn={}, mes_type={} is rollbacked", tid, lsn, msg_header->msg_type);
@@ -692,42 +1665,176 @@ void HSHomeObject::on_blob_message_rollback(int64_t lsn, sisl::blob const& heade
     }
 }
 
-BlobManager::Result< std::string > HSHomeObject::do_verify_blob(const void* blob, shard_id_t expected_shard_id,
-                                                                blob_id_t expected_blob_id) const {
+std::optional< HSHomeObject::DecodedBlobHeader > HSHomeObject::decode_blob_header(const void* blob) {
+    // BlobHeader and CompactBlobHeader share the DataHeader and blob_hdr_version fields.
+    auto const hdr_version = *(r_cast< uint8_t const* >(blob) + sizeof(DataHeader));
+    if (hdr_version == CompactBlobHeader::blob_header_version) {
+        auto const* header = r_cast< CompactBlobHeader const* >(blob);
+        if (!header->valid()) { return std::nullopt; }
+        return DecodedBlobHeader{.blob_hdr_version = header->blob_hdr_version,
+                                 .hash_algorithm = header->hash_algorithm,
+                                 .hash = header->hash(),
+                                 .hash_len = header->hash_len,
+                                 .shard_id = header->shard_id,
+                                 .blob_id = header->blob_id,
+                                 .blob_size = header->blob_size,
+                                 .object_offset = header->object_offset,
+                                 .data_offset = header->data_offset,
+                                 .user_key = header->get_user_key().value(),
+                                 .data_crcs = header->data_crcs(),
+                                 .data_crc_count = header->data_crc_count,
+                                 .data_crc_chunk_size = header->data_crc_chunk_size()};
+    }
+
+    auto const* header = r_cast< BlobHeader const* >(blob);
+    if (!header->valid()) { return std::nullopt; }
+    return DecodedBlobHeader{.blob_hdr_version = header->blob_hdr_version,
+                             .hash_algorithm = header->hash_algorithm,
+                             .hash = header->hash,
+                             .hash_len = BlobHeader::blob_max_hash_len,
+                             .shard_id = header->shard_id,
+                             .blob_id = header->blob_id,
+                             .blob_size = header->blob_size,
+                             .object_offset = header->object_offset,
+                             .data_offset = header->data_offset,
+                             .user_key = header->get_user_key().value()};
+}
+
+uint32_t HSHomeObject::blob_header_size(const void* blob) {
+    if (!r_cast< DataHeader const* >(blob)->valid()) { return 0; }
+    auto const hdr_version = *(r_cast< uint8_t const* >(blob) + sizeof(DataHeader));
+    if (hdr_version == CompactBlobHeader::blob_header_version) {
+        return r_cast< CompactBlobHeader const* >(blob)->header_size;
+    }
+    return sizeof(BlobHeader);
+}
+
+std::string HSHomeObject::blob_header_to_string(const void* blob) {
+    auto const hdr_version = *(r_cast< uint8_t const* >(blob) + sizeof(DataHeader));
+    if (hdr_version == CompactBlobHeader::blob_header_version) {
+        auto const* header = r_cast< CompactBlobHeader const* >(blob);
+        // sizes are not trusted until the header is verified, don't let to_string run past the header
+        if (header->user_key_size > BlobHeader::max_user_key_length) {
+            return fmt::format("magic={:#x} version={} hdr_version={} header_size={}", header->magic, header->version,
+                               header->blob_hdr_version, header->header_size);
+        }
+        return header->to_string();
+    }
+    return r_cast< BlobHeader const* >(blob)->to_string();
+}
+
+uint32_t HSHomeObject::locate_blob_record(const uint8_t* extent, uint64_t extent_size, blob_id_t blob_id) {
+    uint64_t offset{0};
+    while (offset + sizeof(CompactBlobHeader) <= extent_size) {
+        auto const* record = extent + offset;
+        if (*(record + sizeof(DataHeader)) != CompactBlobHeader::blob_header_version) { break; }
+        auto const* header = r_cast< CompactBlobHeader const* >(record);
+        // header_size is not trusted until the header is verified, don't let valid() run past the extent
+        if (header->header_size > extent_size - offset || !header->valid()) { break; }
+        if (header->blob_id == blob_id) { return uint32_cast(offset); }
+        offset += sisl::round_up(static_cast< uint64_t >(header->data_offset) + header->blob_size, io_align);
+    }
+    return 0;
+}
+
+uint32_t HSHomeObject::packed_record_size(uint32_t user_key_size, uint32_t blob_size) {
+    // packed blobs are always hashed with CRC32, see write_packed_record
+    auto const header_size = CompactBlobHeader::header_size_for(
+        user_key_size, CompactBlobHeader::hash_length(BlobHeader::HashAlgorithm::CRC32));
+    return uint32_cast(sisl::round_up(header_size, io_align) + sisl::round_up(blob_size, io_align));
+}
+
+homestore::MultiBlkId HSHomeObject::slice_blkid(homestore::MultiBlkId const& blkid, uint32_t blk_offset,
+                                                uint32_t blk_count) {
+    if (blk_offset == 0 && blk_count == blkid.blk_count()) { return blkid; }
+
+    homestore::MultiBlkId slice;
+    auto it = blkid.iterate();
+    while (auto const piece = it.next()) {
+        if (blk_count == 0) { break; }
+        uint32_t const piece_count = piece->blk_count();
+        if (blk_offset >= piece_count) {
+            blk_offset -= piece_count;
+            continue;
+        }
+        auto const nblks = std::min(piece_count - blk_offset, blk_count);
+        slice.add(piece->blk_num() + blk_offset, s_cast< homestore::blk_count_t >(nblks), piece->chunk_num());
+        blk_offset = 0;
+        blk_count -= nblks;
+    }
+    RELEASE_ASSERT_EQ(blk_count, 0, "blk range out of blkid={}", blkid.to_string());
+    return slice;
+}
+
+bool HSHomeObject::may_share_extent(shard_id_t shard_id, homestore::MultiBlkId const& pbas) const {
+    if (pbas.blk_count() * homestore::data_service().get_blk_size() > max_packed_extent_size) { return false; }
+    auto hs_shard = _get_hs_shard(shard_id);
+    return !hs_shard || hs_shard->may_have_packed_blobs();
+}
+
+bool HSHomeObject::is_extent_shared(shared< BlobIndexTable > index_table, shard_id_t shard_id, blob_id_t blob_id,
+                                    homestore::MultiBlkId const& pbas) const {
+    // Only small extents are shared, and the blobs packed into one have contiguous blob ids.
+    if (pbas.blk_count() * homestore::data_service().get_blk_size() > max_packed_extent_size) { return false; }
+
+    auto const start_blob_id = blob_id > max_blobs_per_pack ? blob_id - max_blobs_per_pack : 0;
+    auto start_key = BlobRouteKey{BlobRoute{shard_id, start_blob_id}};
+    auto end_key = BlobRouteKey{BlobRoute{shard_id, blob_id + max_blobs_per_pack}};
+    bool shared_extent{false};
+    homestore::BtreeQueryRequest< BlobRouteKey > query_req{
+        homestore::BtreeKeyRange< BlobRouteKey >{std::move(start_key), true /* inclusive */, std::move(end_key),
+                                                 true /* inclusive */},
+        homestore::BtreeQueryType::SWEEP_NON_INTRUSIVE_PAGINATION_QUERY, 2 * max_blobs_per_pack + 1,
+        [&pbas, &shared_extent](homestore::BtreeKey const&, homestore::BtreeValue const& value) -> bool {
+            // blob_id itself is already a tombstone
+            if (BlobRouteValue{value}.pbas() == pbas) { shared_extent = true; }
+            return false;
+        }};
+
+    std::vector< std::pair< BlobRouteKey, BlobRouteValue > > out_vector;
+    auto const ret = index_table->query(query_req, out_vector);
+    RELEASE_ASSERT(ret == homestore::btree_status_t::success || ret == homestore::btree_status_t::has_more,
+                   "Failed to query index table for shard=0x{:x}, blob_id={}, status={}", shard_id, blob_id, ret);
+    return shared_extent;
+}
+
+BlobManager::Result< HSHomeObject::DecodedBlobHeader >
+HSHomeObject::do_verify_blob(const void* blob, shard_id_t expected_shard_id, blob_id_t expected_blob_id,
+                             uint8_t const* payload) const {
     uint8_t const* blob_data = static_cast< uint8_t const* >(blob);
-    BlobHeader const* header = r_cast< BlobHeader const* >(blob_data);
 
     // Check if header is valid
-    if (!header->valid()) {
-        LOGE("Invalid header found: [header={}]", header->to_string());
+    auto header = decode_blob_header(blob_data);
+    if (!header) {
+        LOGE("Invalid header found: [header={}]", blob_header_to_string(blob_data));
         return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
     }
 
     // Check if shard_id matches
     if (header->shard_id != expected_shard_id) {
-        LOGE("Invalid shard_id in header: [header={}]", header->to_string());
+        LOGE("Invalid shard_id in header: [header={}]", blob_header_to_string(blob_data));
         return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
     }
 
     // Check if blob_id matches (only if expected_blob_id != 0)
     if (expected_blob_id != 0 && header->blob_id != expected_blob_id) {
-        LOGE("Invalid blob_id in header: [header={}]", header->to_string());
+        LOGE("Invalid blob_id in header: [header={}]", blob_header_to_string(blob_data));
         return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
     }
 
     // Verify hash
-    uint8_t const* blob_bytes = blob_data + header->data_offset;
+    uint8_t const* blob_bytes = payload ? payload : blob_data + header->data_offset;
     uint8_t computed_hash[BlobHeader::blob_max_hash_len]{};
     compute_blob_payload_hash(header->hash_algorithm, blob_bytes, header->blob_size, computed_hash,
                               BlobHeader::blob_max_hash_len);
 
-    if (std::memcmp(computed_hash, header->hash, BlobHeader::blob_max_hash_len) != 0) {
-        LOGE("Hash mismatch header, [header={}] [computed={:np}]", header->to_string(),
-             spdlog::to_hex(computed_hash, computed_hash + BlobHeader::blob_max_hash_len));
+    if (std::memcmp(computed_hash, header->hash, header->hash_len) != 0) {
+        LOGE("Hash mismatch header, [header={}] [computed={:np}]", blob_header_to_string(blob_data),
+             spdlog::to_hex(computed_hash, computed_hash + header->hash_len));
         return folly::makeUnexpected(BlobError(BlobErrorCode::CHECKSUM_MISMATCH));
     }
 
-    return header->get_user_key().value(); // Must have a value as header verified above
+    return std::move(header.value());
 }
 
 bool HSHomeObject::verify_blob(const void* blob, const shard_id_t shard_id, const blob_id_t blob_id,
@@ -30,27 +30,23 @@ std::unique_ptr< CPContext > HSHomeObject::MyCPCallbacks::on_switchover_cp(CP* c
 // when cp_flush is called, it means that all the dirty candidates are already in the dirty list.
 // new dirty candidates will arrive on next cp's context.
 folly::Future< bool > HSHomeObject::MyCPCallbacks::cp_flush(CP* cp) {
-    std::vector< HSHomeObject::HS_PG* > dirty_pg_list;
-    dirty_pg_list.reserve(home_obj_._pg_map.size());
-
-    // the metablk update in cp flush might have a confict with gc, which will also try to update metablk, so we need
-    // hold the unique lock until all the updates are completed
-    std::unique_lock lock_guard(home_obj_._pg_lock);
+    // the metablk update in cp flush might have a confict with gc, which will also try to update metablk of the pg, so
+    // we hold the lock of each pg until its update is completed. pgs can't be added or removed during the flush.
+    std::shared_lock lock_guard(home_obj_._pg_lock);
     for (auto const& [id, pg] : home_obj_._pg_map) {
         auto hs_pg = static_cast< HSHomeObject::HS_PG* >(pg.get());
 
-        // All dirty durable entries are updated in the superblk. We persist outside the pg_lock
-        if (!hs_pg->is_dirty_.exchange(false)) { continue; }
+#ifdef _PRERELEASE
+        // keeps the superblk at the counters of an earlier cp, as if the node crashed before this one
+        if (iomgr_flip::instance()->test_flip("pg_skip_counters_cp_flush")) { continue; }
+#endif
 
-        hs_pg->pg_sb_->blob_sequence_num = hs_pg->durable_entities().blob_sequence_num.load();
-        hs_pg->pg_sb_->active_blob_count = hs_pg->durable_entities().active_blob_count.load();
-        hs_pg->pg_sb_->tombstone_blob_count = hs_pg->durable_entities().tombstone_blob_count.load();
-        hs_pg->pg_sb_->total_occupied_blk_count = hs_pg->durable_entities().total_occupied_blk_count.load();
-        hs_pg->pg_sb_->total_reclaimed_blk_count = hs_pg->durable_entities().total_reclaimed_blk_count.load();
-        dirty_pg_list.push_back(hs_pg);
-    }
+        // All dirty durable entries are updated in the superblk.
+        if (!hs_pg->is_dirty_.exchange(false)) { continue; }
 
-    for (auto& hs_pg : dirty_pg_list) {
+        // exclusive, so that no commit is halfway between updating the counters and their lsn
+        std::scoped_lock pg_lock_guard(hs_pg->mtx_);
+        hs_pg->durable_entities_to_sb();
         hs_pg->pg_sb_.write();
     }
 
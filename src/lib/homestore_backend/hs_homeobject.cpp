@@ -147,6 +147,11 @@ void HSHomeObject::init_homestore() {
 
     http_mgr_ = std::make_unique< HttpManager >(*this);
 
+    if (auto const cache_size = HS_BACKEND_DYNAMIC_CONFIG(blob_read_cache_size_mb) * Mi; cache_size > 0) {
+        LOGI("Blob read cache enabled with {}", homestore::in_bytes(cache_size));
+        blob_read_cache_ = std::make_unique< BlobReadCache >(cache_size);
+    }
+
     const uint64_t app_mem_size = app->mem_size();
     RELEASE_ASSERT(app_mem_size > 0, "Invalid app_mem_size");
     LOGI("Initialize and start HomeStore with app_mem_size = {}", homestore::in_bytes(app_mem_size));
@@ -245,6 +250,9 @@ void HSHomeObject::init_homestore() {
 
     LOGI("Initialize and start HomeStore is successfully");
 
+    // all the logs before dc_lsn have been replayed, the index has every blob put before the restart
+    rebuild_blob_filters();
+
     // Now cache the zero padding bufs to avoid allocating during IO time
     for (size_t i{0}; i < max_zpad_bufs; ++i) {
         size_t const size = io_align * (i + 1);
@@ -464,20 +472,15 @@ HomeObjectStats HSHomeObject::_get_stats() const {
     HomeObjectStats stats;
     // total capacity
     auto const& repl_svc = homestore::hs()->repl_service();
-    auto const num_pdevs = chunk_selector()->get_pdev_chunks().size();
+    auto const num_pdevs = chunk_selector()->total_disks();
     auto const reserved_chunk_num_per_pdev = HS_BACKEND_DYNAMIC_CONFIG(reserved_chunk_num_per_pdev);
     uint64_t reserved_gc_bytes = num_pdevs * reserved_chunk_num_per_pdev * _hs_chunk_size;
     stats.total_capacity_bytes = repl_svc.get_cap_stats().total_capacity - reserved_gc_bytes;
     // used capacity
     stats.used_capacity_bytes = chunk_selector()->get_used_blks() * _data_block_size;
 
-    uint32_t num_open_shards = 0ul;
-    std::scoped_lock lock_guard(_pg_lock);
-    for (auto const& [_, pg] : _pg_map) {
-        auto hs_pg = static_cast< HS_PG* >(pg.get());
-        num_open_shards += hs_pg->open_shards();
-    }
-
+    // maintained as shards are opened and sealed, the stats take no pg or shard lock
+    auto const num_open_shards = _num_open_shards.load(std::memory_order_relaxed);
     stats.num_open_shards = num_open_shards;
     stats.avail_open_shards = chunk_selector()->total_chunks() - num_open_shards;
     stats.num_disks = chunk_selector()->total_disks();
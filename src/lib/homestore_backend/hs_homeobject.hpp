@@ -1,5 +1,6 @@
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <mutex>
 
@@ -8,6 +9,9 @@
 #include <homestore/superblk_handler.hpp>
 #include <homestore/replication/repl_dev.h>
 
+#include "blob_id_filter.hpp"
+#include "blob_read_cache.hpp"
+#include "crc32c.hpp"
 #include "heap_chunk_selector.h"
 #include "lib/homeobject_impl.hpp"
 #include "replication_message.hpp"
@@ -59,8 +63,12 @@ private:
     ShardManager::AsyncResult< ShardInfo > _seal_shard(ShardInfo const&, trace_id_t tid) override;
 
     BlobManager::AsyncResult< blob_id_t > _put_blob(ShardInfo const&, Blob&&, trace_id_t tid) override;
+    BlobManager::AsyncResult< std::vector< blob_id_t > > _put_blob_batch(ShardInfo const&, std::vector< Blob >&&,
+                                                                         trace_id_t tid) override;
     BlobManager::AsyncResult< Blob > _get_blob(ShardInfo const&, blob_id_t, uint64_t off, uint64_t len,
                                                bool allow_skip_verify, trace_id_t tid) const override;
+    BlobManager::AsyncResult< std::vector< BlobManager::Result< Blob > > >
+    _get_blob_batch(ShardInfo const&, std::vector< blob_id_t > const&, trace_id_t tid) const override;
     BlobManager::NullAsyncResult _del_blob(ShardInfo const&, blob_id_t, trace_id_t tid) override;
 
     PGManager::NullAsyncResult _create_pg(PGInfo&& pg_info, std::set< peer_id_t > const& peers,
@@ -191,6 +199,24 @@ public:
         const homestore::chunk_num_t* get_chunk_ids() const {
             return reinterpret_cast< const homestore::chunk_num_t* >(data + this->pg_members_space_size());
         }
+
+        // The chunk ids are followed by this tail, except in a superblk written by an older version, which ends at
+        // the chunk ids. It is not part of size().
+        struct counters_lsn_tail {
+            static constexpr uint64_t tail_magic = 0x7e7eae73ba66324b; // echo "PGCountersLsn" | md5sum
+            uint64_t magic{tail_magic};
+            // the last log whose updates are included in the durable counters of this superblk
+            int64_t lsn{-1};
+        };
+        uint32_t size_with_tail() const { return size() + sizeof(counters_lsn_tail); }
+        counters_lsn_tail* get_counters_lsn_tail_mutable() {
+            return reinterpret_cast< counters_lsn_tail* >(data + this->pg_members_space_size() +
+                                                          num_chunks * sizeof(homestore::chunk_num_t));
+        }
+        const counters_lsn_tail* get_counters_lsn_tail() const {
+            return reinterpret_cast< const counters_lsn_tail* >(data + this->pg_members_space_size() +
+                                                                num_chunks * sizeof(homestore::chunk_num_t));
+        }
     };
 
     struct DataHeader {
@@ -373,16 +399,45 @@ public:
 
         HS_PG(PGInfo info, shared< homestore::ReplDev > rdev, shared< BlobIndexTable > index_table,
               std::shared_ptr< const std::vector< homestore::chunk_num_t > > pg_chunk_ids);
-        HS_PG(homestore::superblk< pg_info_superblk >&& sb, shared< homestore::ReplDev > rdev);
+        // The lsn of the last log counted in the durable entities, persisted along with them.
+        std::atomic< int64_t > counters_lsn_{-1};
+        // Logs up to this lsn are already counted in the durable entities recovered from the superblk, so replaying
+        // them must not count them again.
+        int64_t recovered_counters_lsn_{-1};
+        // Recovered from a superblk without counters lsn, the durable entities are recounted once the log is replayed.
+        bool counters_need_refresh_{false};
+
+        HS_PG(homestore::superblk< pg_info_superblk >&& sb, shared< homestore::ReplDev > rdev,
+              bool has_counters_lsn);
         ~HS_PG() override = default;
 
+        /**
+         * Applies the counter updates of the log committed at lsn, unless its replay finds them in the recovered
+         * durable entities already. The logs of a pg are committed in order, a batch calls it once per blob. Updates
+         * without a log (e.g. from a snapshot) pass no lsn.
+         */
+        void durable_entities_update_at(std::optional< int64_t > lsn, auto&& cb) {
+            if (!lsn) {
+                durable_entities_update(cb);
+                return;
+            }
+            if (*lsn <= recovered_counters_lsn_) { return; }
+            // shared with the other commits, cp_flush takes it exclusively to see the counters and lsn together
+            std::shared_lock lg(mtx_);
+            durable_entities_update(cb);
+            counters_lsn_.store(*lsn, std::memory_order_relaxed);
+        }
+
+        /**
+         * Copies the durable entities and their lsn into pg_sb_, the caller holds mtx_ exclusively.
+         */
+        void durable_entities_to_sb();
+
         static PGInfo pg_info_from_sb(homestore::superblk< pg_info_superblk > const& sb);
 
         ///////////////// PG stats APIs /////////////////
-        /// Note: Caller needs to hold the _pg_lock before calling these apis
         /**
          * Returns the total number of created shards on this PG.
-         * It is caller's responsibility to hold the _pg_lock.
          */
         uint32_t total_shards() const;
 
@@ -420,13 +475,44 @@ public:
 
     struct HS_Shard : public Shard {
         homestore::superblk< shard_info_superblk > sb_;
-        HS_Shard(ShardInfo info, homestore::chunk_num_t p_chunk_id, homestore::chunk_num_t v_chunk_id);
+        // Blob ids put into this shard. Not ready for a recovered shard until rebuild_blob_filters.
+        mutable BlobIdFilter blob_filter_;
+        HS_Shard(ShardInfo info, homestore::chunk_num_t p_chunk_id, homestore::chunk_num_t v_chunk_id,
+                 bool blob_filter_ready);
         HS_Shard(homestore::superblk< shard_info_superblk >&& sb);
         ~HS_Shard() override = default;
 
         void update_info(const ShardInfo& info, std::optional< homestore::chunk_num_t > p_chunk_id = std::nullopt);
-        auto p_chunk_id() const { return sb_->p_chunk_id; }
-        auto v_chunk_id() const { return sb_->v_chunk_id; }
+        // Readable without _shard_lock, e.g. by the allocation hints of every blob put.
+        homestore::chunk_num_t p_chunk_id() const { return p_chunk_id_.load(std::memory_order_acquire); }
+        homestore::chunk_num_t v_chunk_id() const { return v_chunk_id_.load(std::memory_order_acquire); }
+        // Layout of the blobs last put to or read from this shard. A get reads the header into a buffer of the data
+        // offset, 0 while unknown, so that a blob with the same layout lands right in the body it returns. A verified
+        // range read only reads the range and checks it against the data crcs while the blobs are known to have them.
+        uint32_t blob_data_offset_hint() const { return blob_data_offset_hint_.load(std::memory_order_relaxed); }
+        bool blob_data_crcs_hint() const { return blob_data_crcs_hint_.load(std::memory_order_relaxed); }
+        // Whether blobs of this shard were ever packed into a shared extent. Found by the same scan of the index which
+        // readies the blob filter of a recovered shard, so it is only known once the filter is ready.
+        bool may_have_packed_blobs() const {
+            return has_packed_blobs_.load(std::memory_order_acquire) || !blob_filter_.is_ready();
+        }
+        void set_has_packed_blobs() const { has_packed_blobs_.store(true, std::memory_order_release); }
+        void set_blob_layout_hint(uint32_t data_offset, bool data_crcs) const {
+            if (blob_data_offset_hint_.load(std::memory_order_relaxed) != data_offset) {
+                blob_data_offset_hint_.store(data_offset, std::memory_order_relaxed);
+            }
+            if (blob_data_crcs_hint_.load(std::memory_order_relaxed) != data_crcs) {
+                blob_data_crcs_hint_.store(data_crcs, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        // copies of the chunks in sb_, which GC moves the shard between
+        std::atomic< homestore::chunk_num_t > p_chunk_id_;
+        std::atomic< homestore::chunk_num_t > v_chunk_id_;
+        mutable std::atomic< uint32_t > blob_data_offset_hint_{0};
+        mutable std::atomic< bool > blob_data_crcs_hint_{false};
+        mutable std::atomic< bool > has_packed_blobs_{false};
     };
 
 #pragma pack(1)
@@ -442,6 +528,8 @@ public:
             CRC32 = 1,
             MD5 = 2,
             SHA1 = 3,
+            CRC32C = 4,  // crc32c, 4 bytes
+            XXH3_64 = 5, // 64 bit XXH3, 8 bytes little endian
         };
 
         uint8_t blob_hdr_version{blob_header_version};
@@ -505,6 +593,18 @@ public:
                 static_assert(sizeof(header_hash) == blob_max_hash_len && blob_max_hash_len >= sizeof(uint32_t),
                               "buffer too small!!");
 #pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wstringop-overflow"
+                std::memcpy(header_hash, &computed_hash, sizeof(uint32_t));
+#pragma GCC diagnostic pop
+
+                return true;
+            }
+            case HashAlgorithm::CRC32C:
+            case HashAlgorithm::XXH3_64: {
+                // The header is sealed with crc32c when the payload uses one of the faster hashes.
+                std::memset(header_hash, 0, blob_max_hash_len);
+                uint32_t computed_hash = crc32c(0, (uint8_t*)this, sizeof(BlobHeader));
+#pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wstringop-overflow"
                 std::memcpy(header_hash, &computed_hash, sizeof(uint32_t));
 #pragma GCC diagnostic pop
@@ -522,6 +622,150 @@ public:
 #pragma pack()
     // size of BlobHeader should be smaller than _data_block_size
     static_assert(sizeof(BlobHeader) == _data_block_size);
+
+#pragma pack(1)
+    // Compact blob header, blob_hdr_version 0x03. It is sized to the actual user key and payload hash instead of
+    // being padded to a full data block, so it shares the first data block with the payload:
+    // compact blob header | user key | payload hash | padding to data_offset | blob data | padding.
+    // The DataHeader and blob_hdr_version fields are laid out exactly as in BlobHeader, which is what readers use to
+    // tell the two formats apart.
+    struct CompactBlobHeader : DataHeader {
+        static constexpr uint8_t blob_header_version = 0x03;
+
+        uint8_t blob_hdr_version{blob_header_version};
+        BlobHeader::HashAlgorithm hash_algorithm{BlobHeader::HashAlgorithm::NONE};
+        uint8_t hash_len{0};     // Size of the payload hash stored after the user key
+        uint32_t header_crc{0};  // crc32 of the first header_size bytes, computed with this field zeroed
+        uint16_t header_size{0}; // sizeof(CompactBlobHeader) + user_key_size + hash_len + data crc array
+        uint16_t user_key_size{0};
+        shard_id_t shard_id{0};
+        blob_id_t blob_id{0};
+        uint32_t blob_size{0};
+        uint64_t object_offset{0}; // Offset of this blob in the object. Provided by GW.
+        uint32_t data_offset{0};   // Offset of actual data blob, at least header_size. It is header_size rounded up to
+                                   // io_align
+        uint16_t data_crc_count{0};      // Number of crc32c of payload chunks stored after the hash, 0 if none
+        uint8_t data_crc_chunk_shift{0}; // log2 of the payload chunk size covered by one data crc
+
+        // The data crcs let a range read verify only the chunks it covers instead of the whole payload. Chunks start
+        // at 4K and grow so that the array never takes more than max_data_crc_count entries, which keeps the header
+        // in the first data block whatever the blob size.
+        static constexpr uint16_t max_data_crc_count = 512;
+        static constexpr uint8_t min_data_crc_chunk_shift = 12;
+
+        static uint8_t hash_length(BlobHeader::HashAlgorithm algorithm) {
+            switch (algorithm) {
+            case BlobHeader::HashAlgorithm::CRC32:
+            case BlobHeader::HashAlgorithm::CRC32C:
+                return sizeof(uint32_t);
+            case BlobHeader::HashAlgorithm::XXH3_64:
+                return sizeof(uint64_t);
+            case BlobHeader::HashAlgorithm::MD5:
+                return 16;
+            case BlobHeader::HashAlgorithm::SHA1:
+                return 20;
+            case BlobHeader::HashAlgorithm::NONE:
+            default:
+                return 0;
+            }
+        }
+
+        static uint32_t header_size_for(uint32_t user_key_size, uint8_t hash_len, uint32_t data_crc_count = 0) {
+            return sizeof(CompactBlobHeader) + user_key_size + hash_len + data_crc_count * sizeof(uint32_t);
+        }
+
+        static uint8_t data_crc_chunk_shift_for(uint64_t blob_size) {
+            uint8_t shift = min_data_crc_chunk_shift;
+            while (((blob_size + (1ull << shift) - 1) >> shift) > max_data_crc_count) {
+                ++shift;
+            }
+            return shift;
+        }
+
+        static uint32_t data_crc_count_for(uint64_t blob_size) {
+            auto const shift = data_crc_chunk_shift_for(blob_size);
+            return uint32_cast((blob_size + (1ull << shift) - 1) >> shift);
+        }
+
+        uint8_t* user_key() { return r_cast< uint8_t* >(this) + sizeof(CompactBlobHeader); }
+        uint8_t const* user_key() const { return r_cast< uint8_t const* >(this) + sizeof(CompactBlobHeader); }
+        uint8_t* hash() { return user_key() + user_key_size; }
+        uint8_t const* hash() const { return user_key() + user_key_size; }
+        // crc32c of the payload chunks, not aligned, see DecodedBlobHeader::data_crc
+        uint8_t* data_crcs() { return hash() + hash_len; }
+        uint8_t const* data_crcs() const { return hash() + hash_len; }
+        uint64_t data_crc_chunk_size() const { return 1ull << data_crc_chunk_shift; }
+
+        std::optional< std::string > get_user_key() const {
+            if (user_key_size > BlobHeader::max_user_key_length) { return std::nullopt; }
+            return std::string(r_cast< const char* >(user_key()), user_key_size);
+        }
+
+        std::string to_string() const {
+            return fmt::format("magic={:#x} version={} hdr_version={} shard={:#x} blob_size={} header_size={} "
+                               "user_size={} algo={} hash={:np}, data_crcs={} chunk_shift={}, user_key={}\n",
+                               magic, version, blob_hdr_version, shard_id, blob_size, header_size, user_key_size,
+                               (uint8_t)hash_algorithm, spdlog::to_hex(hash(), hash() + hash_len), data_crc_count,
+                               data_crc_chunk_shift, get_user_key().value_or("<null>"));
+        }
+
+        bool valid() const {
+            if (!DataHeader::valid() || blob_hdr_version != blob_header_version ||
+                user_key_size > BlobHeader::max_user_key_length || hash_len != hash_length(hash_algorithm) ||
+                header_size != header_size_for(user_key_size, hash_len, data_crc_count) || data_offset < header_size) {
+                return false;
+            }
+            if (data_crc_count != 0 &&
+                (data_crc_chunk_shift < min_data_crc_chunk_shift || data_crc_chunk_shift >= 32 ||
+                 data_crc_count != ((uint64_t{blob_size} + data_crc_chunk_size() - 1) >> data_crc_chunk_shift))) {
+                return false;
+            }
+            return header_crc == compute_crc();
+        }
+
+        void seal() { header_crc = compute_crc(); }
+
+    private:
+        uint32_t compute_crc() const {
+            // header_crc itself is excluded from the checksum.
+            auto const* bytes = r_cast< uint8_t const* >(this);
+            auto const crc_off = r_cast< uint8_t const* >(&header_crc) - bytes;
+            auto const crc = crc32_ieee(init_crc32, bytes, crc_off);
+            return crc32_ieee(crc, bytes + crc_off + sizeof(header_crc), header_size - crc_off - sizeof(header_crc));
+        }
+    };
+#pragma pack()
+    // The largest compact header (max user key, hash and data crcs) must still leave room for payload in the first
+    // data block.
+    static_assert(sizeof(CompactBlobHeader) + BlobHeader::max_user_key_length + BlobHeader::blob_max_hash_len +
+                      CompactBlobHeader::max_data_crc_count * sizeof(uint32_t) <
+                  _data_block_size);
+
+    // Format independent view of a blob header read from disk, decoded from either a BlobHeader or a
+    // CompactBlobHeader. hash points into the buffer the header was decoded from.
+    struct DecodedBlobHeader {
+        uint8_t blob_hdr_version;
+        BlobHeader::HashAlgorithm hash_algorithm;
+        uint8_t const* hash;
+        uint32_t hash_len;
+        shard_id_t shard_id;
+        blob_id_t blob_id;
+        uint32_t blob_size;
+        uint64_t object_offset;
+        uint32_t data_offset;
+        std::string user_key;
+        // crc32c of each data_crc_chunk_size bytes of the payload, compact header only
+        uint8_t const* data_crcs{nullptr};
+        uint32_t data_crc_count{0};
+        uint64_t data_crc_chunk_size{0};
+
+        uint32_t data_crc(uint32_t chunk) const {
+            uint32_t crc;
+            std::memcpy(&crc, data_crcs + chunk * sizeof(uint32_t), sizeof(crc));
+            return crc;
+        }
+    };
+
     struct BlobInfo {
         shard_id_t shard_id;
         blob_id_t blob_id;
@@ -534,6 +778,22 @@ public:
         ALL = 2,
     };
 
+    // Upper bound of an extent shared by packed small blobs, whatever blob_pack_max_extent_size is set to. Larger
+    // extents always belong to a single blob.
+    static constexpr uint32_t max_packed_extent_size = 32 * Ki;
+    static constexpr uint32_t max_blobs_per_pack = max_packed_extent_size / io_align;
+
+#pragma pack(1)
+    // Header extension of PUT_BLOB_BATCH_MSG, one entry per blob in the order the blobs are laid out in the data. Blobs
+    // packed into the same extent are stored back to back as CompactBlobHeader records, each starting at an io_align
+    // boundary, and all their index entries point to that extent. A blob which is not packed has an extent of its own.
+    struct BlobBatchEntry {
+        blob_id_t blob_id;
+        uint32_t blk_offset; // First block of the extent holding this blob, relative to the allocated blkids
+        uint32_t blk_count;  // Number of blocks of that extent
+    };
+#pragma pack()
+
     inline const static homestore::MultiBlkId tombstone_pbas{0, 0, 0};
     inline const static std::string delete_marker_blob_data{"HOMEOBJECT_BLOB_DELETE_MARKER"};
 
@@ -733,10 +993,30 @@ private:
     shared< HeapChunkSelector > chunk_selector_;
     shared< GCManager > gc_mgr_;
     unique< HttpManager > http_mgr_;
+    // Verified blobs recently read by get, null if blob_read_cache_size_mb is 0
+    unique< BlobReadCache > blob_read_cache_;
+    // Set once the blob filters of the recovered shards are rebuilt, shards created later start with a ready filter.
+    std::atomic< bool > blob_filters_ready_{false};
 
     static constexpr size_t max_zpad_bufs = _data_block_size / io_align;
     std::array< sisl::io_blob_safe, max_zpad_bufs > zpad_bufs_; // Zero padded buffers for blob payload.
 
+    // Small blobs waiting to be packed into a shared extent, per shard. A pack is written as soon as nothing else is
+    // in flight for the shard or enough blobs are queued to fill an extent, so packing adds no latency on an idle
+    // shard and packs grow with the load.
+    struct PendingPackedBlob {
+        Blob blob;
+        trace_id_t tid;
+        folly::Promise< BlobManager::Result< blob_id_t > > promise;
+    };
+    struct BlobPackQueue {
+        std::deque< PendingPackedBlob > pending;
+        uint32_t pending_bytes{0}; // Sum of the record sizes of the pending blobs
+        uint32_t inflight{0};      // Packs written but not yet committed
+    };
+    std::mutex blob_pack_lock_;
+    std::unordered_map< shard_id_t, BlobPackQueue > blob_pack_queues_;
+
     static homestore::ReplicationService& hs_repl_service() { return homestore::hs()->repl_service(); }
 
     // blob related
@@ -744,11 +1024,55 @@ private:
                                                     blob_id_t blob_id, uint64_t req_offset, uint64_t req_len,
                                                     const homestore::MultiBlkId& blkid, trace_id_t tid,
                                                     bool allow_skip_verify = false) const;
-
+    // Verifies the record of blob_id in an extent read from blkid and copies the requested range of it out.
+    BlobManager::Result< Blob > extract_blob(uint8_t const* extent, uint64_t extent_size, shard_id_t shard_id,
+                                             blob_id_t blob_id, uint64_t req_offset, uint64_t req_len,
+                                             homestore::MultiBlkId const& blkid, peer_id_t const& leader_id,
+                                             trace_id_t tid) const;
+    // Copies the requested range of a blob out of the read cache.
+    static BlobManager::Result< Blob > blob_from_cache(BlobReadCache::Entry const& cached, uint64_t req_offset,
+                                                       uint64_t req_len, peer_id_t leader_id);
+
+    BlobManager::AsyncResult< blob_id_t > _put_packed_blob(ShardInfo const& shard, Blob&& blob, trace_id_t tid);
+    std::vector< std::vector< PendingPackedBlob > > take_blob_packs(BlobPackQueue& queue);
+    void write_blob_pack(shard_id_t shard_id, pg_id_t pg_id, std::vector< PendingPackedBlob >&& pack);
+    void on_blob_pack_written(shard_id_t shard_id, pg_id_t pg_id);
+    uint32_t write_packed_record(uint8_t* buf, shard_id_t shard_id, blob_id_t blob_id, Blob const& blob) const;
+    // Writes the data header of blob into buf and returns the data offset. data_offset 0 takes the default one of
+    // the header format, only the compact header accepts others. data_crcs adds the crcs of the payload chunks to a
+    // compact header, header_size_for has to account for them in data_offset.
+    uint32_t write_blob_header(uint8_t* buf, bool compact, BlobHeader::HashAlgorithm hash_algorithm,
+                               shard_id_t shard_id, blob_id_t blob_id, Blob const& blob, uint32_t data_offset = 0,
+                               bool data_crcs = false) const;
+    // Replicates the blobs as one PUT_BLOB_BATCH_MSG with consecutive blob ids, returning the first of them. Small blobs
+    // are packed into shared extents as far as the packing settings allow.
+    BlobManager::AsyncResult< blob_id_t > write_blob_batch(shard_id_t shard_id, pg_id_t pg_id,
+                                                           std::vector< Blob >&& blobs, trace_id_t tid);
+
+    // Reads a blob which has an extent of its own with the header and the data going to separate buffers, so that the
+    // data buffer becomes the body of the returned blob without copying it.
+    // hdr_size is the data offset the blob is expected at, a blob laid out differently is copied out instead.
+    BlobManager::AsyncResult< Blob > _get_blob_data_direct(const shared< homestore::ReplDev >& repl_dev,
+                                                           shard_id_t shard_id, blob_id_t blob_id, uint64_t req_len,
+                                                           const homestore::MultiBlkId& blkid, uint32_t hdr_size,
+                                                           trace_id_t tid) const;
+    // Records the data offset and the data crc presence of a blob of shard_id with an extent of its own, which plan
+    // the reads of its neighbours.
+    void learn_blob_layout(shard_id_t shard_id, uint32_t data_offset, bool data_crcs) const;
+
+    // Reads the whole extent of blkid, verifies the blob and copies the requested range out.
+    BlobManager::AsyncResult< Blob > _get_blob_data_full(const shared< homestore::ReplDev >& repl_dev,
+                                                         shard_id_t shard_id, blob_id_t blob_id, uint64_t req_offset,
+                                                         uint64_t req_len, const homestore::MultiBlkId& blkid,
+                                                         trace_id_t tid) const;
+
+    // Reads only the header block and the blocks covering the requested range. Without verify_data_crcs the payload
+    // is not verified at all. With it the read is widened to whole data crc chunks which are checked against the crcs
+    // in the header, a blob written without data crcs is read again in full.
     BlobManager::AsyncResult< Blob > _get_blob_data_partial(const shared< homestore::ReplDev >& repl_dev,
                                                             shard_id_t shard_id, blob_id_t blob_id, uint64_t req_offset,
                                                             uint64_t req_len, const homestore::MultiBlkId& blkid,
-                                                            trace_id_t tid) const;
+                                                            trace_id_t tid, bool verify_data_crcs = false) const;
 
     // create pg related
     static PGManager::NullAsyncResult do_create_pg(cshared< homestore::ReplDev > repl_dev, PGInfo&& pg_info,
@@ -764,8 +1088,10 @@ private:
 
     static ShardInfo deserialize_shard_info(const char* shard_info_str, size_t size);
     static std::string serialize_shard_info(const ShardInfo& info);
+    // lsn is the log of the shard creation, none when the shard comes from a snapshot
     void local_create_shard(ShardInfo shard_info, homestore::chunk_num_t v_chunk_id, homestore::chunk_num_t p_chunk_id,
-                            homestore::blk_count_t blk_count, trace_id_t tid = 0);
+                            homestore::blk_count_t blk_count, std::optional< int64_t > lsn = std::nullopt,
+                            trace_id_t tid = 0);
     void add_new_shard_to_map(std::unique_ptr< HS_Shard > shard);
     void update_shard_in_map(const ShardInfo& shard_info);
 
@@ -915,6 +1241,14 @@ public:
      */
     std::optional< homestore::chunk_num_t > get_shard_p_chunk_id(shard_id_t id) const;
 
+    /**
+     * @brief Retrieves the published copy of the info of the given shard, which is safe to read without _shard_lock.
+     *
+     * @param id The ID of the shard to retrieve the info for.
+     * @return An optional shard info if the shard ID is valid, otherwise an empty optional.
+     */
+    std::optional< ShardInfo > get_shard_info(shard_id_t id) const;
+
     void update_shard_meta_after_gc(const homestore::chunk_num_t move_from_chunk,
                                     const homestore::chunk_num_t move_to_chunk, const uint64_t task_id);
 
@@ -987,6 +1321,12 @@ public:
     cshared< HeapChunkSelector > chunk_selector() const { return chunk_selector_; }
     cshared< GCManager > gc_manager() const { return gc_mgr_; }
 
+    // Drops a blob from the read cache, it has been deleted or moved.
+    void invalidate_cached_blob(shard_id_t shard_id, blob_id_t blob_id) {
+        if (blob_read_cache_) { blob_read_cache_->invalidate(BlobRoute{shard_id, blob_id}); }
+    }
+    BlobReadCache const* blob_read_cache() const { return blob_read_cache_.get(); }
+
     /**
      * @brief Reconciles the leaders for all PGs or a specific PG identified by pg_id.
      *
@@ -1024,13 +1364,56 @@ public:
                                   cintrusive< homestore::repl_req_ctx >& hs_ctx);
     void on_blob_put_commit(int64_t lsn, sisl::blob const& header, sisl::blob const& key,
                             const homestore::MultiBlkId& pbas, cintrusive< homestore::repl_req_ctx >& hs_ctx);
+    void on_blob_batch_put_commit(int64_t lsn, sisl::blob const& header, sisl::blob const& key,
+                                  const homestore::MultiBlkId& pbas, cintrusive< homestore::repl_req_ctx >& hs_ctx);
     void on_blob_del_commit(int64_t lsn, sisl::blob const& header, sisl::blob const& key,
                             cintrusive< homestore::repl_req_ctx >& hs_ctx);
-    bool local_add_blob_info(pg_id_t pg_id, BlobInfo const& blob_info, trace_id_t tid = 0);
+    // count_occupied_blks is false for all but the first blob of a shared extent, so its blocks are counted once.
+    // lsn is the log of the put, none when the blob comes from a snapshot
+    bool local_add_blob_info(pg_id_t pg_id, BlobInfo const& blob_info, std::optional< int64_t > lsn = std::nullopt,
+                             trace_id_t tid = 0, bool count_occupied_blks = true);
     homestore::ReplResult< homestore::blk_alloc_hints >
-    blob_put_get_blk_alloc_hints(sisl::blob const& header, cintrusive< homestore::repl_req_ctx >& ctx);
+    blob_put_get_blk_alloc_hints(sisl::blob const& header, uint32_t data_size,
+                                 cintrusive< homestore::repl_req_ctx >& ctx);
     void compute_blob_payload_hash(BlobHeader::HashAlgorithm algorithm, const uint8_t* blob_bytes, size_t blob_size,
                                    uint8_t* hash_bytes, size_t hash_len) const;
+    void compute_blob_payload_hash(BlobHeader::HashAlgorithm algorithm, std::vector< iovec > const& frags,
+                                   uint8_t* hash_bytes, size_t hash_len) const;
+
+    /**
+     * @brief Decode the blob header at the start of a stored blob, in either BlobHeader or CompactBlobHeader format.
+     *
+     * @param blob Pointer to the first data block of the blob.
+     * @return The decoded header if it is valid, otherwise std::nullopt.
+     */
+    static std::optional< DecodedBlobHeader > decode_blob_header(const void* blob);
+    // Number of leading bytes of a stored blob taken by its header, 0 if it does not start with a data header.
+    static uint32_t blob_header_size(const void* blob);
+    static std::string blob_header_to_string(const void* blob);
+
+    /**
+     * @brief Find the record of a blob in an extent read from disk. An extent holds either a single blob or several
+     * small blobs of the same shard packed as a chain of CompactBlobHeader records.
+     *
+     * @param extent Pointer to the first data block of the extent.
+     * @param extent_size Size of the extent in bytes.
+     * @param blob_id The blob to look for.
+     * @return Offset of the record in the extent. 0 is returned if the record is not found, so verifying the first
+     * record reports the mismatch.
+     */
+    static uint32_t locate_blob_record(const uint8_t* extent, uint64_t extent_size, blob_id_t blob_id);
+
+    /**
+     * @brief Size of a packed blob record: compact header, user key and hash, then payload, each rounded up to
+     * io_align.
+     */
+    static uint32_t packed_record_size(uint32_t user_key_size, uint32_t blob_size);
+
+    /**
+     * @brief Returns the blk_count blocks starting at block blk_offset of blkid, following its pieces in order.
+     */
+    static homestore::MultiBlkId slice_blkid(homestore::MultiBlkId const& blkid, uint32_t blk_offset,
+                                             uint32_t blk_count);
 
     std::shared_ptr< homestore::IndexTableBase >
     recover_index_table(homestore::superblk< homestore::index_table_sb >&& sb);
@@ -1046,7 +1429,7 @@ public:
     sisl::io_blob_safe get_snapshot_sb_data(homestore::group_id_t group_id);
     void update_snapshot_sb(homestore::group_id_t group_id, std::shared_ptr< homestore::snapshot_context > ctx);
     void destroy_snapshot_sb(homestore::group_id_t group_id);
-    const Shard* _get_hs_shard(const shard_id_t shard_id) const;
+    shared< const HS_Shard > _get_hs_shard(const shard_id_t shard_id) const;
     std::shared_ptr< GCBlobIndexTable > get_gc_index_table(std::string uuid) const;
     void trigger_immediate_gc();
     const HS_PG* _get_hs_pg_unlocked(pg_id_t pg_id) const;
@@ -1054,13 +1437,18 @@ public:
                      bool allow_delete_marker = false) const;
 
     BlobManager::Result< std::vector< BlobInfo > > get_shard_blobs(shard_id_t shard_id);
+    // Fills the blob filters of the recovered shards from the pg index tables and makes them ready.
+    void rebuild_blob_filters();
 
-    // Refresh PG statistics (called after log replay)
+    // Recounts the PG statistics with a full scan of the pg index. Called after log replay only for a superblk
+    // without counters lsn, otherwise on demand to verify the counters (see /api/v1/refresh_pg_stats).
     void refresh_pg_statistics(pg_id_t pg_id);
 
 private:
-    BlobManager::Result< std::string > do_verify_blob(const void* blob, shard_id_t expected_shard_id,
-                                                      blob_id_t expected_blob_id = 0) const;
+    // payload is the blob data when it was not read right behind the header, at data_offset of blob.
+    BlobManager::Result< DecodedBlobHeader > do_verify_blob(const void* blob, shard_id_t expected_shard_id,
+                                                            blob_id_t expected_blob_id = 0,
+                                                            uint8_t const* payload = nullptr) const;
     std::shared_ptr< BlobIndexTable > create_pg_index_table();
     std::shared_ptr< GCBlobIndexTable > create_gc_index_table();
 
@@ -1070,6 +1458,13 @@ private:
     BlobManager::Result< homestore::MultiBlkId >
     get_blob_from_index_table(shared< BlobIndexTable > index_table, shard_id_t shard_id, blob_id_t blob_id) const;
 
+    // Whether pbas of a blob of shard_id can be shared at all: it is small enough and the shard has ever had packed
+    // blobs. Only then is_extent_shared has to look at the index.
+    bool may_share_extent(shard_id_t shard_id, homestore::MultiBlkId const& pbas) const;
+    // Whether another live blob of the shard is packed into the same extent as blob_id.
+    bool is_extent_shared(shared< BlobIndexTable > index_table, shard_id_t shard_id, blob_id_t blob_id,
+                          homestore::MultiBlkId const& pbas) const;
+
     void print_btree_index(pg_id_t pg_id) const;
 
     shared< BlobIndexTable > get_index_table(pg_id_t pg_id);
@@ -58,6 +58,8 @@ HttpManager::HttpManager(HSHomeObject& ho) : ho_(ho) {
          Pistache::Rest::Routes::bind(&HttpManager::crash_system, this)},
 #endif
         {Pistache::Http::Method::Get, "/api/v1/pg", Pistache::Rest::Routes::bind(&HttpManager::get_pg, this)},
+        {Pistache::Http::Method::Post, "/api/v1/refresh_pg_stats",
+         Pistache::Rest::Routes::bind(&HttpManager::refresh_pg_stats, this)},
         {Pistache::Http::Method::Get, "/api/v1/chunks",
          Pistache::Rest::Routes::bind(&HttpManager::get_pg_chunks, this)},
         {Pistache::Http::Method::Get, "/api/v1/shard", Pistache::Rest::Routes::bind(&HttpManager::get_shard, this)},
@@ -179,6 +181,29 @@ void HttpManager::get_pg(const Pistache::Rest::Request& request, Pistache::Http:
     response.send(Pistache::Http::Code::Ok, json.dump());
 }
 
+void HttpManager::refresh_pg_stats(const Pistache::Rest::Request& request, Pistache::Http::ResponseWriter response) {
+    auto pg_str = request.query().get("pg_id");
+    if (!pg_str) {
+        response.send(Pistache::Http::Code::Bad_Request, "pg_id is required");
+        return;
+    }
+    uint16_t pg_id = std::stoul(pg_str.value());
+    auto hs_pg = ho_.get_hs_pg(pg_id);
+    if (!hs_pg || !hs_pg->index_table_) {
+        response.send(Pistache::Http::Code::Not_Found, "pg not found");
+        return;
+    }
+    // the counters are kept incrementally, this full scan of the pg index only verifies and corrects them
+    LOGINFO("Received refresh stats request for pg_id {}", pg_id);
+    ho_.refresh_pg_statistics(pg_id);
+    PGStats stats;
+    if (!ho_.pg_manager()->get_stats(pg_id, stats)) {
+        response.send(Pistache::Http::Code::Not_Found, "pg not found");
+        return;
+    }
+    response.send(Pistache::Http::Code::Ok, stats.to_string());
+}
+
 void HttpManager::get_pg_chunks(const Pistache::Rest::Request& request, Pistache::Http::ResponseWriter response) {
     auto pg_str = request.query().get("pg_id");
     if (!pg_str) {
@@ -111,7 +111,8 @@ PGManager::NullAsyncResult HSHomeObject::_create_pg(PGInfo&& pg_info, std::set<
         return folly::makeUnexpected(PGError::INVALID_ARG);
     }
 
-    auto const num_chunk = chunk_selector()->select_chunks_for_pg(pg_id, pg_info.size);
+    auto const num_chunk =
+        chunk_selector()->select_chunks_for_pg(pg_id, pg_info.size, HS_BACKEND_DYNAMIC_CONFIG(pg_chunk_stripe));
     if (!num_chunk.has_value()) {
         LOGW("Failed to select chunks for pg={}", pg_id);
         decr_pending_request_num();
@@ -207,7 +208,8 @@ folly::Expected< HSHomeObject::HS_PG*, PGError > HSHomeObject::local_create_pg(s
     }
 
     // select chunks for pg
-    auto const num_chunk = chunk_selector()->select_chunks_for_pg(pg_id, pg_info.size);
+    auto const num_chunk =
+        chunk_selector()->select_chunks_for_pg(pg_id, pg_info.size, HS_BACKEND_DYNAMIC_CONFIG(pg_chunk_stripe));
     if (!num_chunk.has_value()) {
         LOGW("Failed to select chunks for pg={}, trace_id={}", pg_id, tid);
         return folly::makeUnexpected(PGError::NO_SPACE_LEFT);
@@ -701,6 +703,7 @@ bool HSHomeObject::pg_destroy(pg_id_t pg_id, bool need_to_pause_pg_state_machine
     gc_mgr_->drain_pg_pending_gc_task(pg_id);
 
     destroy_shards(pg_id);
+    if (blob_read_cache_) { blob_read_cache_->invalidate_pg(pg_id); }
     destroy_hs_resources(pg_id);
     destroy_pg_index_table(pg_id);
     destroy_pg_superblk(pg_id);
@@ -789,29 +792,39 @@ bool HSHomeObject::resume_pg_state_machine(pg_id_t pg_id) {
 }
 
 void HSHomeObject::mark_pg_destroyed(pg_id_t pg_id) {
-    auto lg = std::scoped_lock(_pg_lock);
+    auto lg = std::shared_lock(_pg_lock);
     auto hs_pg = const_cast< HS_PG* >(_get_hs_pg_unlocked(pg_id));
     if (hs_pg == nullptr) {
         LOGW("mark pg destroyed with unknown pg={}", pg_id);
         return;
     }
+    auto pg_lg = std::scoped_lock(hs_pg->mtx_);
     hs_pg->pg_sb_->state = PGState::DESTROYED;
     hs_pg->pg_sb_.write();
     LOGD("pg={} is marked as destroyed", pg_id);
 }
 
 bool HSHomeObject::can_chunks_in_pg_be_gc(pg_id_t pg_id) const {
-    auto lg = std::scoped_lock(_pg_lock);
+    auto lg = std::shared_lock(_pg_lock);
     auto hs_pg = const_cast< HS_PG* >(_get_hs_pg_unlocked(pg_id));
     if (hs_pg == nullptr) {
         LOGW("unknown pg={}", pg_id);
         return false;
     }
+    auto pg_lg = std::shared_lock(hs_pg->mtx_);
 
     return hs_pg->pg_sb_->state == PGState::ALIVE;
 }
 
-void HSHomeObject::destroy_hs_resources(pg_id_t pg_id) { chunk_selector_->reset_pg_chunks(pg_id); }
+void HSHomeObject::destroy_hs_resources(pg_id_t pg_id) {
+    // the chunks are emptied along with all the shards of the pg
+    if (auto chunks = chunk_selector_->get_pg_chunks(pg_id); gc_mgr_ && chunks) {
+        for (auto const chunk_id : *chunks) {
+            gc_mgr_->reset_chunk_garbage(chunk_id);
+        }
+    }
+    chunk_selector_->reset_pg_chunks(pg_id);
+}
 
 void HSHomeObject::destroy_pg_index_table(pg_id_t pg_id) {
     std::shared_ptr< BlobIndexTable > index_table;
@@ -819,7 +832,7 @@ void HSHomeObject::destroy_pg_index_table(pg_id_t pg_id) {
     {
         // index_table->destroy() will trigger a cp_flush, which will call homeobject#cp_flush and try to acquire
         // `_pg_lock`, so we need to release the lock here to avoid a dead lock
-        auto lg = std::scoped_lock(_pg_lock);
+        auto lg = std::shared_lock(_pg_lock);
         auto hs_pg = _get_hs_pg_unlocked(pg_id);
         if (hs_pg == nullptr) {
             LOGW("destroy pg index table with unknown pg={}", pg_id);
@@ -935,7 +948,16 @@ void HSHomeObject::on_pg_meta_blk_found(sisl::byte_view const& buf, void* meta_c
     std::vector< chunk_num_t > p_chunk_ids(pg_sb->get_chunk_ids(), pg_sb->get_chunk_ids() + pg_sb->num_chunks);
     bool set_pg_chunks_res = chunk_selector_->recover_pg_chunks(pg_id, std::move(p_chunk_ids));
     auto uuid_str = boost::uuids::to_string(pg_sb->index_table_uuid);
-    auto hs_pg = std::make_unique< HS_PG >(std::move(pg_sb), std::move(v.value()));
+    bool const has_counters_lsn = buf.size() >= pg_sb->size_with_tail() &&
+        pg_sb->get_counters_lsn_tail()->magic == pg_info_superblk::counters_lsn_tail::tail_magic;
+    if (!has_counters_lsn) {
+        // written by an older version. The tail is only marked valid once refresh_pg_statistics recounts the
+        // counters, until then a restart treats the superblk as an old one again.
+        pg_sb.resize(pg_sb->size_with_tail());
+        *pg_sb->get_counters_lsn_tail_mutable() = pg_info_superblk::counters_lsn_tail{};
+        pg_sb->get_counters_lsn_tail_mutable()->magic = 0;
+    }
+    auto hs_pg = std::make_unique< HS_PG >(std::move(pg_sb), std::move(v.value()), has_counters_lsn);
     if (!set_pg_chunks_res) {
         hs_pg->pg_state_.set_state(PGStateMask::DISK_DOWN);
         hs_pg->repl_dev_->set_stage(homestore::repl_dev_stage_t::UNREADY);
@@ -982,7 +1004,7 @@ HSHomeObject::HS_PG::HS_PG(PGInfo info, shared< homestore::ReplDev > rdev, share
     RELEASE_ASSERT(pg_chunk_ids != nullptr, "PG chunks null, pg={}", pg_info_.id);
     const uint32_t num_chunks = pg_chunk_ids->size();
     pg_sb_.create(sizeof(pg_info_superblk) - sizeof(char) + 2 * pg_info_.expected_member_num * sizeof(pg_members) +
-                  num_chunks * sizeof(homestore::chunk_num_t));
+                  num_chunks * sizeof(homestore::chunk_num_t) + sizeof(pg_info_superblk::counters_lsn_tail));
     pg_sb_->id = pg_info_.id;
     pg_sb_->state = PGState::ALIVE;
     pg_sb_->num_expected_members = pg_info_.expected_member_num;
@@ -1010,24 +1032,40 @@ HSHomeObject::HS_PG::HS_PG(PGInfo info, shared< homestore::ReplDev > rdev, share
     for (i = 0; i < num_chunks; ++i) {
         pg_sb_chunk_ids[i] = pg_chunk_ids->at(i);
     }
+    *pg_sb_->get_counters_lsn_tail_mutable() = pg_info_superblk::counters_lsn_tail{};
     pg_sb_.write();
 }
 
-HSHomeObject::HS_PG::HS_PG(superblk< pg_info_superblk >&& sb, shared< ReplDev > rdev) :
+HSHomeObject::HS_PG::HS_PG(superblk< pg_info_superblk >&& sb, shared< ReplDev > rdev, bool has_counters_lsn) :
         PG{pg_info_from_sb(sb)}, pg_sb_{std::move(sb)}, repl_dev_{std::move(rdev)}, metrics_{*this} {
     durable_entities_.blob_sequence_num = pg_sb_->blob_sequence_num;
     durable_entities_.active_blob_count = pg_sb_->active_blob_count;
     durable_entities_.tombstone_blob_count = pg_sb_->tombstone_blob_count;
     durable_entities_.total_occupied_blk_count = pg_sb_->total_occupied_blk_count;
     durable_entities_.total_reclaimed_blk_count = pg_sb_->total_reclaimed_blk_count;
+    if (has_counters_lsn) {
+        recovered_counters_lsn_ = pg_sb_->get_counters_lsn_tail()->lsn;
+        counters_lsn_.store(recovered_counters_lsn_, std::memory_order_relaxed);
+    } else {
+        // the replay cannot tell which logs are counted already, so it counts them all and the counters are
+        // recounted from the index afterwards.
+        counters_need_refresh_ = true;
+    }
 }
 
-uint32_t HSHomeObject::HS_PG::total_shards() const { return shards_.size(); }
-
-uint32_t HSHomeObject::HS_PG::open_shards() const {
-    return std::count_if(shards_.begin(), shards_.end(), [](auto const& s) { return s->is_open(); });
+void HSHomeObject::HS_PG::durable_entities_to_sb() {
+    pg_sb_->blob_sequence_num = durable_entities_.blob_sequence_num.load();
+    pg_sb_->active_blob_count = durable_entities_.active_blob_count.load();
+    pg_sb_->tombstone_blob_count = durable_entities_.tombstone_blob_count.load();
+    pg_sb_->total_occupied_blk_count = durable_entities_.total_occupied_blk_count.load();
+    pg_sb_->total_reclaimed_blk_count = durable_entities_.total_reclaimed_blk_count.load();
+    pg_sb_->get_counters_lsn_tail_mutable()->lsn = counters_lsn_.load(std::memory_order_relaxed);
 }
 
+uint32_t HSHomeObject::HS_PG::total_shards() const { return num_shards_.load(std::memory_order_relaxed); }
+
+uint32_t HSHomeObject::HS_PG::open_shards() const { return num_open_shards_.load(std::memory_order_relaxed); }
+
 // Return the percentage of snapshot progress
 uint32_t HSHomeObject::HS_PG::get_snp_progress() const {
     return snp_rcvr_info_sb_->progress.total_bytes > 0
@@ -1090,6 +1128,7 @@ void HSHomeObject::HS_PG::trigger_snapshot_creation(int64_t compact_lsn, bool wa
 
 std::vector< Shard > HSHomeObject::HS_PG::get_chunk_shards(chunk_num_t v_chunk_id) const {
     std::vector< Shard > ret;
+    std::shared_lock lg(mtx_);
     for (auto const& s : shards_) {
         auto hs_shard = dynamic_cast< HS_Shard* >(s.get());
         if (hs_shard->v_chunk_id() == v_chunk_id) { ret.push_back(*s); }
@@ -1308,6 +1347,11 @@ void HSHomeObject::refresh_pg_statistics(pg_id_t pg_id) {
         de.tombstone_blob_count.store(tombstone_count, std::memory_order_relaxed);
         de.total_occupied_blk_count.store(total_occupied, std::memory_order_relaxed);
     });
+    {
+        // the counters are trustworthy from now on, even if the superblk was written by an older version
+        std::scoped_lock lg(hs_pg->mtx_);
+        hs_pg->pg_sb_->get_counters_lsn_tail_mutable()->magic = pg_info_superblk::counters_lsn_tail::tail_magic;
+    }
 
     LOGI("Refreshed statistics for pg={}: active_blobs={} (original={}), tombstone_blobs={} (original={}), "
          "occupied_blocks={} (original={})",
@@ -1318,11 +1362,13 @@ void HSHomeObject::refresh_pg_statistics(pg_id_t pg_id) {
 void HSHomeObject::update_pg_meta_after_gc(const pg_id_t pg_id, const homestore::chunk_num_t move_from_chunk,
                                            const homestore::chunk_num_t move_to_chunk, const uint64_t task_id) {
     // 1 update pg metrics
-    std::unique_lock lck(_pg_lock);
+    std::shared_lock lck(_pg_lock);
     auto iter = _pg_map.find(pg_id);
     // TODO:: revisit here with the considering of destroying pg
     RELEASE_ASSERT(iter != _pg_map.end(), "can not find pg_id={} in pg_map", pg_id);
     auto hs_pg = dynamic_cast< HS_PG* >(iter->second.get());
+    // the pg superblk is also written by cp_flush
+    std::scoped_lock pg_lck(hs_pg->mtx_);
     auto move_from_v_chunk = chunk_selector()->get_extend_vchunk(move_from_chunk);
 
     // TODO:: for now, when updating pchunk for a vchunk, we have to update the whole pg super blk. we can optimize this
@@ -1380,11 +1426,8 @@ void HSHomeObject::update_pg_meta_after_gc(const pg_id_t pg_id, const homestore:
                  total_occupied_blk_count_by_move_to_chunk, de.total_occupied_blk_count.load());
         });
 
-        hs_pg->pg_sb_->total_occupied_blk_count =
-            hs_pg->durable_entities().total_occupied_blk_count.load(std::memory_order_relaxed);
-
-        hs_pg->pg_sb_->tombstone_blob_count =
-            hs_pg->durable_entities().tombstone_blob_count.load(std::memory_order_relaxed);
+        // all the counters go with the lsn, so that the replay after a restart counts the later logs only
+        hs_pg->durable_entities_to_sb();
 
         // we need to persist the updated pg superblk since we have updated the pg_chunks
         hs_pg->pg_sb_.write();
@@ -64,10 +64,11 @@ uint64_t ShardManager::max_shard_size() { return Gi; }
 uint64_t ShardManager::max_shard_num_in_pg() { return ((uint64_t)0x01) << shard_width; }
 
 shard_id_t HSHomeObject::generate_new_shard_id(pg_id_t pgid) {
-    std::scoped_lock lock_guard(_pg_lock);
+    std::shared_lock lock_guard(_pg_lock);
     auto hs_pg = const_cast< HS_PG* >(_get_hs_pg_unlocked(pgid));
     RELEASE_ASSERT(hs_pg, "Missing pg info");
 
+    std::scoped_lock pg_lock_guard(hs_pg->mtx_);
     auto new_sequence_num = ++hs_pg->shard_sequence_num_;
     RELEASE_ASSERT(new_sequence_num < ShardManager::max_shard_num_in_pg(),
                    "new shard id must be less than ShardManager::max_shard_num_in_pg()");
@@ -288,6 +289,8 @@ ShardManager::AsyncResult< ShardInfo > HSHomeObject::_seal_shard(ShardInfo const
 
     ShardInfo tmp_info = info;
     tmp_info.state = ShardInfo::State::SEALED;
+    // the seal time is when the data of the shard was last written, which is the age of it for gc victim selection
+    tmp_info.last_modified_time = get_current_timestamp();
 
     // Prepare the shard info block
     sisl::io_blob_safe sb_blob(sisl::round_up(sizeof(shard_info_superblk), repl_dev->get_blk_size()), io_align);
@@ -361,6 +364,7 @@ bool HSHomeObject::on_shard_message_pre_commit(int64_t lsn, sisl::blob const& he
             // the update of superblk will be done in on_shard_message_commit;
             if (state == ShardInfo::State::OPEN) {
                 state = ShardInfo::State::SEALED;
+                _publish_shard(*iter->second);
             } else {
                 SLOGW(tid, shard_info.id, "try to seal an unopened shard");
             }
@@ -427,6 +431,7 @@ void HSHomeObject::on_shard_message_rollback(int64_t lsn, sisl::blob const& head
             // the update of superblk will be done in on_shard_message_commit;
             if (state == ShardInfo::State::SEALED) {
                 state = ShardInfo::State::OPEN;
+                _publish_shard(*iter->second);
             } else {
                 SLOGW(tid, shard_info.id, "try to rollback seal_shard message , but the shard state is not sealed");
             }
@@ -444,7 +449,7 @@ void HSHomeObject::on_shard_message_rollback(int64_t lsn, sisl::blob const& head
 
 void HSHomeObject::local_create_shard(ShardInfo shard_info, homestore::chunk_num_t v_chunk_id,
                                       homestore::chunk_num_t p_chunk_id, homestore::blk_count_t blk_count,
-                                      trace_id_t tid) {
+                                      std::optional< int64_t > lsn, trace_id_t tid) {
     bool shard_exist = false;
     {
         scoped_lock lock_guard(_shard_lock);
@@ -462,7 +467,9 @@ void HSHomeObject::local_create_shard(ShardInfo shard_info, homestore::chunk_num
         // comes and try to select chunk before the chunk is marked in_use, and at the same time gc kicks in (since the
         // chunk is still marked as available), then data loss will happen since gc is work on a chunk which is
         // accepting new blobs.
-        add_new_shard_to_map(std::make_unique< HS_Shard >(shard_info, p_chunk_id, v_chunk_id));
+        // a shard created while replaying the log may already have blobs in the index, its filter is rebuilt
+        add_new_shard_to_map(std::make_unique< HS_Shard >(
+            shard_info, p_chunk_id, v_chunk_id, blob_filters_ready_.load(std::memory_order_acquire)));
     } else {
         SLOGD(tid, shard_info.id, "shard already exist, skip creating shard");
     }
@@ -475,8 +482,8 @@ void HSHomeObject::local_create_shard(ShardInfo shard_info, homestore::chunk_num
     SLOGD(tid, shard_info.id, "local_create_shard {}, vchunk_id={}, p_chunk_id={}, pg_id={}", shard_info.id, v_chunk_id,
           p_chunk_id, shard_info.placement_group);
 
-    const_cast< HS_PG* >(hs_pg)->durable_entities_update(
-        [blk_count](auto& de) { de.total_occupied_blk_count.fetch_add(blk_count, std::memory_order_relaxed); });
+    const_cast< HS_PG* >(hs_pg)->durable_entities_update_at(
+        lsn, [blk_count](auto& de) { de.total_occupied_blk_count.fetch_add(blk_count, std::memory_order_relaxed); });
 }
 
 void HSHomeObject::on_shard_message_commit(int64_t lsn, sisl::blob const& h, homestore::MultiBlkId const& blkids,
@@ -524,7 +531,7 @@ void HSHomeObject::on_shard_message_commit(int64_t lsn, sisl::blob const& h, hom
         auto v_chunk_id = sb->v_chunk_id;
         shard_info.lsn = lsn;
 
-        local_create_shard(shard_info, v_chunk_id, blkids.chunk_num(), blkids.blk_count(), tid);
+        local_create_shard(shard_info, v_chunk_id, blkids.chunk_num(), blkids.blk_count(), lsn, tid);
         if (ctx) { ctx->promise_.setValue(ShardManager::Result< ShardInfo >(shard_info)); }
 
         SLOGD(tid, shard_info.id, "Commit done for creating shard");
@@ -580,6 +587,12 @@ void HSHomeObject::on_shard_message_commit(int64_t lsn, sisl::blob const& h, hom
         RELEASE_ASSERT(v_chunkID.has_value(), "v_chunk id not found");
         bool res = chunk_selector()->release_chunk(pg_id, v_chunkID.value());
         RELEASE_ASSERT(res, "Failed to release v_chunk_id={}, pg={}", v_chunkID.value(), pg_id);
+        if (gc_mgr_) {
+            // the chunk may have gone over the gc threshold while it was taken by the shard
+            if (auto p_chunk_id = get_shard_p_chunk_id(shard_info.id); p_chunk_id) {
+                gc_mgr_->on_chunk_released(p_chunk_id.value());
+            }
+        }
 
         if (ctx) { ctx->promise_.setValue(ShardManager::Result< ShardInfo >(shard_info)); }
         SLOGD(tid, shard_info.id, "Commit done for sealing shard");
@@ -587,9 +600,9 @@ void HSHomeObject::on_shard_message_commit(int64_t lsn, sisl::blob const& h, hom
         auto hs_pg = get_hs_pg(shard_info.placement_group);
         RELEASE_ASSERT(hs_pg != nullptr, "shardID=0x{:x}, pg={}, shard=0x{:x}, PG not found", shard_info.id,
                        (shard_info.id >> homeobject::shard_width), (shard_info.id & homeobject::shard_mask));
-        const_cast< HS_PG* >(hs_pg)->durable_entities_update(
+        const_cast< HS_PG* >(hs_pg)->durable_entities_update_at(
             // shard_footer will also occupy one blk.
-            [](auto& de) { de.total_occupied_blk_count.fetch_add(1, std::memory_order_relaxed); });
+            lsn, [](auto& de) { de.total_occupied_blk_count.fetch_add(1, std::memory_order_relaxed); });
 
         break;
     }
@@ -656,17 +669,18 @@ void HSHomeObject::on_shard_meta_blk_found(homestore::meta_blk* mblk, sisl::byte
 
 void HSHomeObject::on_shard_meta_blk_recover_completed(bool success) {
     std::unordered_set< homestore::chunk_num_t > excluding_chunks;
-    std::scoped_lock lock_guard(_pg_lock);
+    std::shared_lock lock_guard(_pg_lock);
     for (auto& pair : _pg_map) {
         if (dynamic_cast< HS_PG* >(pair.second.get())->pg_state_.is_state_set(PGStateMask::DISK_DOWN)) {
             LOGW("pg={} is disk down, skip recover chunk state from shards", pair.first);
             continue;
         }
+        std::shared_lock pg_lock_guard(pair.second->mtx_);
         excluding_chunks.clear();
         excluding_chunks.reserve(pair.second->shards_.size());
         for (auto& shard : pair.second->shards_) {
             if (shard->info.state == ShardInfo::State::OPEN) {
-                excluding_chunks.emplace(d_cast< HS_Shard* >(shard.get())->sb_->v_chunk_id);
+                excluding_chunks.emplace(d_cast< HS_Shard* >(shard.get())->v_chunk_id());
             }
         }
         bool res = chunk_selector_->recover_pg_chunks_states(pair.first, excluding_chunks);
@@ -705,22 +719,24 @@ void HSHomeObject::write_migrated_shard_metablks() {
 }
 
 void HSHomeObject::add_new_shard_to_map(std::unique_ptr< HS_Shard > shard) {
-    // TODO: We are taking a global lock for all pgs to create shard. Is it really needed??
-    // We need to have fine grained per PG lock and take only that.
-    std::scoped_lock lock_guard(_pg_lock, _shard_lock);
+    // only the pg of the shard is locked, shards are created on the other pgs in parallel
+    std::shared_lock lock_guard(_pg_lock);
     auto hs_pg = const_cast< HS_PG* >(_get_hs_pg_unlocked(shard->info.placement_group));
     RELEASE_ASSERT(hs_pg, "Missing pg info, pg={}", shard->info.placement_group);
     if (hs_pg->pg_state_.is_state_set(PGStateMask::DISK_DOWN)) {
         LOGW("pg={} is disk down, skip add shard to map, shardID=0x{:x}", shard->info.placement_group, shard->info.id);
         return;
     }
+    std::scoped_lock pg_lock_guard(hs_pg->mtx_, _shard_lock);
     auto p_chunk_id = shard->p_chunk_id();
     auto& shards = hs_pg->shards_;
     auto shard_id = shard->info.id;
     auto iter = shards.emplace(shards.end(), std::move(shard));
+    (*iter)->pg = hs_pg;
     auto [_, happened] = _shard_map.emplace(shard_id, iter);
     RELEASE_ASSERT(happened, "shardID=0x{:x}, pg={}, shard=0x{:x}, duplicated shard info", shard_id,
                    (shard_id >> homeobject::shard_width), (shard_id & homeobject::shard_mask));
+    _publish_shard(*iter);
 
     const auto [it, h] = chunk_to_shards_map_.try_emplace(p_chunk_id, std::set< shard_id_t >());
     if (h) { LOGDEBUG("chunk_id={} is not in chunk_to_shards_map, add it", p_chunk_id); }
@@ -744,21 +760,25 @@ void HSHomeObject::update_shard_in_map(const ShardInfo& shard_info) {
                    shard_info.id, (shard_info.id >> homeobject::shard_width), (shard_info.id & homeobject::shard_mask));
     auto hs_shard = d_cast< HS_Shard* >((*shard_iter->second).get());
     hs_shard->update_info(shard_info);
+    _publish_shard(*shard_iter->second);
 }
 
-const Shard* HSHomeObject::_get_hs_shard(const shard_id_t shard_id) const {
-    std::scoped_lock lock_guard(_shard_lock);
-    auto shard_iter = _shard_map.find(shard_id);
-    if (shard_iter == _shard_map.end()) { return nullptr; }
-    return (*shard_iter->second).get();
+shared< const HSHomeObject::HS_Shard > HSHomeObject::_get_hs_shard(const shard_id_t shard_id) const {
+    auto it = _shard_snapshots.find(shard_id);
+    if (it == _shard_snapshots.cend()) { return nullptr; }
+    return std::static_pointer_cast< const HS_Shard >(it->second.shard);
 }
 
 std::optional< homestore::chunk_num_t > HSHomeObject::get_shard_p_chunk_id(shard_id_t id) const {
-    std::scoped_lock lock_guard(_shard_lock);
-    auto shard_iter = _shard_map.find(id);
-    if (shard_iter == _shard_map.end()) { return std::nullopt; }
-    auto hs_shard = d_cast< HS_Shard* >((*shard_iter->second).get());
-    return std::make_optional< homestore::chunk_num_t >(hs_shard->sb_->p_chunk_id);
+    auto hs_shard = _get_hs_shard(id);
+    if (hs_shard == nullptr) { return std::nullopt; }
+    return std::make_optional< homestore::chunk_num_t >(hs_shard->p_chunk_id());
+}
+
+std::optional< ShardInfo > HSHomeObject::get_shard_info(shard_id_t id) const {
+    auto it = _shard_snapshots.find(id);
+    if (it == _shard_snapshots.cend()) { return std::nullopt; }
+    return it->second.info;
 }
 
 const std::set< shard_id_t > HSHomeObject::get_shards_in_chunk(homestore::chunk_num_t chunk_id) const {
@@ -815,6 +835,7 @@ void HSHomeObject::update_shard_meta_after_gc(const homestore::chunk_num_t move_
         // capacity
 
         hs_shard->update_info(shard_info, move_to_chunk);
+        _publish_shard(*shard_iter->second);
         LOGD("gc task_id={}, update shard={} pchunk from {} to {}", task_id, shard_id, move_from_chunk, move_to_chunk);
         shards_in_move_to_chunk.insert(shard_id);
     }
@@ -823,11 +844,9 @@ void HSHomeObject::update_shard_meta_after_gc(const homestore::chunk_num_t move_
 }
 
 std::optional< homestore::chunk_num_t > HSHomeObject::get_shard_v_chunk_id(const shard_id_t id) const {
-    std::scoped_lock lock_guard(_shard_lock);
-    auto shard_iter = _shard_map.find(id);
-    if (shard_iter == _shard_map.end()) { return std::nullopt; }
-    auto hs_shard = d_cast< HS_Shard* >((*shard_iter->second).get());
-    return std::make_optional< homestore::chunk_num_t >(hs_shard->sb_->v_chunk_id);
+    auto hs_shard = _get_hs_shard(id);
+    if (hs_shard == nullptr) { return std::nullopt; }
+    return std::make_optional< homestore::chunk_num_t >(hs_shard->v_chunk_id());
 }
 
 std::optional< homestore::chunk_num_t > HSHomeObject::resolve_v_chunk_id_from_msg(sisl::blob const& header) {
@@ -887,12 +906,13 @@ bool HSHomeObject::release_chunk_based_on_create_shard_message(sisl::blob const&
 }
 
 void HSHomeObject::destroy_shards(pg_id_t pg_id) {
-    auto lg = std::scoped_lock(_pg_lock, _shard_lock);
+    auto lg = std::shared_lock(_pg_lock);
     auto hs_pg = _get_hs_pg_unlocked(pg_id);
     if (hs_pg == nullptr) {
         LOGW("on shards destroy with unknown pg={}", pg_id);
         return;
     }
+    auto pg_lg = std::scoped_lock(hs_pg->mtx_, _shard_lock);
 
     for (auto& shard : hs_pg->shards_) {
         auto hs_shard = s_cast< HS_Shard* >(shard.get());
@@ -900,14 +920,20 @@ void HSHomeObject::destroy_shards(pg_id_t pg_id) {
         // destroy shard super blk
         hs_shard->sb_.destroy();
         // erase shard in shard map
+        _unpublish_shard(*shard);
         _shard_map.erase(shard->info.id);
     }
     LOGD("Shards in pg={} have all been destroyed", pg_id);
 }
 
 HSHomeObject::HS_Shard::HS_Shard(ShardInfo shard_info, homestore::chunk_num_t p_chunk_id,
-                                 homestore::chunk_num_t v_chunk_id) :
-        Shard(std::move(shard_info)), sb_(_shard_meta_name) {
+                                 homestore::chunk_num_t v_chunk_id, bool blob_filter_ready) :
+        Shard(std::move(shard_info)),
+        sb_(_shard_meta_name),
+        blob_filter_(HS_BACKEND_DYNAMIC_CONFIG(shard_blob_filter_max_kb) * Ki,
+                     HS_BACKEND_DYNAMIC_CONFIG(shard_blob_filter_bits_per_blob), blob_filter_ready),
+        p_chunk_id_(p_chunk_id),
+        v_chunk_id_(v_chunk_id) {
     sb_.create(sizeof(shard_info_superblk));
     sb_->type = DataHeader::data_type_t::SHARD_INFO;
     sb_->info = info;
@@ -917,7 +943,12 @@ HSHomeObject::HS_Shard::HS_Shard(ShardInfo shard_info, homestore::chunk_num_t p_
 }
 
 HSHomeObject::HS_Shard::HS_Shard(homestore::superblk< shard_info_superblk >&& sb) :
-        Shard(sb->info), sb_(std::move(sb)) {}
+        Shard(sb->info),
+        sb_(std::move(sb)),
+        blob_filter_(HS_BACKEND_DYNAMIC_CONFIG(shard_blob_filter_max_kb) * Ki,
+                     HS_BACKEND_DYNAMIC_CONFIG(shard_blob_filter_bits_per_blob), false /* ready */),
+        p_chunk_id_(sb_->p_chunk_id),
+        v_chunk_id_(sb_->v_chunk_id) {}
 
 void HSHomeObject::HS_Shard::update_info(const ShardInfo& shard_info,
                                          std::optional< homestore::chunk_num_t > p_chunk_id) {
@@ -925,6 +956,8 @@ void HSHomeObject::HS_Shard::update_info(const ShardInfo& shard_info,
     info = shard_info;
     sb_->info = info;
     sb_.write();
+    // published after the superblk is persisted, the new chunk is not given out as a hint before
+    if (p_chunk_id != std::nullopt) { p_chunk_id_.store(p_chunk_id.value(), std::memory_order_release); }
 }
 
 } // namespace homeobject
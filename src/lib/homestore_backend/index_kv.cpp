@@ -137,6 +137,81 @@ BlobManager::Result< std::vector< HSHomeObject::BlobInfo > > HSHomeObject::get_s
                                 UINT64_MAX);
 }
 
+void HSHomeObject::rebuild_blob_filters() {
+    // shards created from now on start with a ready filter, every blob put from now on is added to the filter of its
+    // shard, so the scan below only has to cover what the index already has
+    blob_filters_ready_.store(true, std::memory_order_release);
+
+    std::vector< std::pair< pg_id_t, shared< BlobIndexTable > > > pg_index_tables;
+    std::unordered_map< shard_id_t, HS_Shard* > shards;
+    {
+        std::shared_lock lock_guard(_pg_lock);
+        for (auto const& [pg_id, pg] : _pg_map) {
+            auto hs_pg = d_cast< HS_PG* >(pg.get());
+            if (hs_pg->pg_state_.is_state_set(PGStateMask::DISK_DOWN) || hs_pg->index_table_ == nullptr) {
+                LOGW("pg={} is disk down, its shards keep blob filters which are not ready", pg_id);
+                continue;
+            }
+            pg_index_tables.emplace_back(pg_id, hs_pg->index_table_);
+            std::shared_lock pg_lock_guard(pg->mtx_);
+            for (auto const& shard : pg->shards_) {
+                auto hs_shard = d_cast< HS_Shard* >(shard.get());
+                if (!hs_shard->blob_filter_.is_ready()) { shards.emplace(shard->info.id, hs_shard); }
+            }
+        }
+    }
+
+    for (auto const& [pg_id, index_table] : pg_index_tables) {
+        uint64_t blob_count{0};
+        auto start_key =
+            BlobRouteKey{BlobRoute{uint64_t(pg_id) << homeobject::shard_width, std::numeric_limits< uint64_t >::min()}};
+        auto end_key = BlobRouteKey{
+            BlobRoute{uint64_t(pg_id + 1) << homeobject::shard_width, std::numeric_limits< uint64_t >::min()}};
+        HS_Shard* hs_shard{nullptr};
+        homestore::MultiBlkId prev_pbas;
+        homestore::BtreeQueryRequest< BlobRouteKey > query_req{
+            homestore::BtreeKeyRange< BlobRouteKey >{std::move(start_key), true /* inclusive */, std::move(end_key),
+                                                     false /* inclusive */},
+            homestore::BtreeQueryType::SWEEP_NON_INTRUSIVE_PAGINATION_QUERY,
+            std::numeric_limits< uint32_t >::max() /* blob count in a pg will not exceed uint32_t_max*/,
+            [&shards, &hs_shard, &prev_pbas, &blob_count](homestore::BtreeKey const& key,
+                                                          homestore::BtreeValue const& value) mutable -> bool {
+                auto const route = BlobRouteKey{key}.key();
+                auto const pbas = BlobRouteValue{value}.pbas();
+                if (pbas == HSHomeObject::tombstone_pbas) { return false; }
+                // the keys come in shard order
+                if (!hs_shard || hs_shard->info.id != route.shard) {
+                    auto it = shards.find(route.shard);
+                    hs_shard = (it == shards.end()) ? nullptr : it->second;
+                    prev_pbas = homestore::MultiBlkId{};
+                }
+                if (hs_shard) {
+                    hs_shard->blob_filter_.add(route.blob);
+                    ++blob_count;
+                    // live blobs packed into one extent have adjacent entries with the same pbas
+                    if (pbas == prev_pbas) { hs_shard->set_has_packed_blobs(); }
+                    prev_pbas = pbas;
+                }
+                return false;
+            }};
+
+        std::vector< std::pair< BlobRouteKey, BlobRouteValue > > dummy_out;
+        auto const ret = index_table->query(query_req, dummy_out);
+        if (ret != homestore::btree_status_t::success && ret != homestore::btree_status_t::has_more) {
+            // the filters of this pg stay not ready, gets fall back to the index
+            LOGE("Failed to scan index table to rebuild blob filters for pg={}, ret={}", pg_id, ret);
+            std::erase_if(shards,
+                          [pg_id](auto const& entry) { return (entry.first >> homeobject::shard_width) == pg_id; });
+            continue;
+        }
+        LOGI("Rebuilt blob filters of pg={} with {} blobs", pg_id, blob_count);
+    }
+
+    for (auto& [shard_id, hs_shard] : shards) {
+        hs_shard->blob_filter_.set_ready();
+    }
+}
+
 BlobManager::Result< std::vector< HSHomeObject::BlobInfo > >
 HSHomeObject::query_blobs_in_shard(pg_id_t pg_id, uint64_t cur_shard_seq_num, blob_id_t start_blob_id,
                                    uint64_t max_num_in_batch) {
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sisl/logging/logging.h>
+
+namespace homeobject {
+
+// A max d-ary heap whose entries are addressed by a unique id, so that an entry can be erased or get a new key in
+// O(log n) instead of rebuilding the heap. Entries with the same key are ordered by the smaller id first, so the order
+// does not depend on the insertion order. Not thread safe.
+template < typename Id, typename Key, typename Value, size_t D = 4 >
+class IndexedHeap {
+    static_assert(D >= 2, "a heap needs at least 2 children per node");
+
+public:
+    size_t size() const { return m_entries.size(); }
+    bool empty() const { return m_entries.empty(); }
+    bool contains(Id const& id) const { return m_pos.contains(id); }
+
+    Value const& top() const { return m_entries.front().value; }
+    Key const& top_key() const { return m_entries.front().key; }
+    Id const& top_id() const { return m_entries.front().id; }
+
+    // Returns nullptr if there is no entry of the id.
+    Value const* find(Id const& id) const {
+        auto it = m_pos.find(id);
+        return it == m_pos.end() ? nullptr : &m_entries[it->second].value;
+    }
+
+    // Adds the entry, or updates the key and value of the entry with the same id.
+    void push(Id const& id, Key const& key, Value value) {
+        if (auto it = m_pos.find(id); it != m_pos.end()) {
+            m_entries[it->second].value = std::move(value);
+            update(id, key);
+            return;
+        }
+        m_entries.push_back(Entry{id, key, std::move(value)});
+        m_pos.emplace(id, m_entries.size() - 1);
+        sift_up(m_entries.size() - 1);
+    }
+
+    void pop() {
+        DEBUG_ASSERT(!m_entries.empty(), "pop on an empty heap");
+        remove_at(0);
+    }
+
+    // Returns false if there is no entry of the id.
+    bool erase(Id const& id) {
+        auto it = m_pos.find(id);
+        if (it == m_pos.end()) { return false; }
+        remove_at(it->second);
+        return true;
+    }
+
+    // Moves the entry of the id to its place for the new key, both for an increased and a decreased key. Returns
+    // false if there is no entry of the id.
+    bool update(Id const& id, Key const& key) {
+        auto it = m_pos.find(id);
+        if (it == m_pos.end()) { return false; }
+        auto const pos = it->second;
+        m_entries[pos].key = key;
+        sift_down(sift_up(pos));
+        return true;
+    }
+
+    void clear() {
+        m_entries.clear();
+        m_pos.clear();
+    }
+
+private:
+    struct Entry {
+        Id id;
+        Key key;
+        Value value;
+    };
+
+    // true if the entry at lhs should be above the entry at rhs
+    bool before(size_t lhs, size_t rhs) const {
+        auto const& l = m_entries[lhs];
+        auto const& r = m_entries[rhs];
+        return r.key < l.key || (!(l.key < r.key) && l.id < r.id);
+    }
+
+    void swap_entries(size_t lhs, size_t rhs) {
+        std::swap(m_entries[lhs], m_entries[rhs]);
+        m_pos[m_entries[lhs].id] = lhs;
+        m_pos[m_entries[rhs].id] = rhs;
+    }
+
+    size_t sift_up(size_t pos) {
+        while (pos > 0) {
+            auto const parent = (pos - 1) / D;
+            if (!before(pos, parent)) { break; }
+            swap_entries(pos, parent);
+            pos = parent;
+        }
+        return pos;
+    }
+
+    size_t sift_down(size_t pos) {
+        while (true) {
+            auto const first_child = pos * D + 1;
+            if (first_child >= m_entries.size()) { break; }
+            auto best = first_child;
+            auto const last_child = std::min(first_child + D, m_entries.size());
+            for (auto child = first_child + 1; child < last_child; ++child) {
+                if (before(child, best)) { best = child; }
+            }
+            if (!before(best, pos)) { break; }
+            swap_entries(pos, best);
+            pos = best;
+        }
+        return pos;
+    }
+
+    void remove_at(size_t pos) {
+        auto const last = m_entries.size() - 1;
+        if (pos != last) { swap_entries(pos, last); }
+        m_pos.erase(m_entries.back().id);
+        m_entries.pop_back();
+        if (pos < m_entries.size()) { sift_down(sift_up(pos)); }
+    }
+
+    std::vector< Entry > m_entries;
+    std::unordered_map< Id, size_t > m_pos;
+};
+
+} // namespace homeobject
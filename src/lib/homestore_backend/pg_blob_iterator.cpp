@@ -23,6 +23,7 @@ HSHomeObject::PGBlobIterator::PGBlobIterator(HSHomeObject& home_obj, homestore::
 
     if (upto_lsn != 0) {
         // Iterate all shards and its blobs which have lsn <= upto_lsn
+        std::shared_lock lock_guard(pg->mtx_);
         for (auto& shard : pg->shards_) {
             if (shard->info.lsn <= upto_lsn) {
                 auto v_chunk_id = home_obj_.get_shard_v_chunk_id(shard->info.id);
@@ -249,13 +250,28 @@ BlobManager::AsyncResult< blob_read_result > HSHomeObject::PGBlobIterator::load_
                 return folly::makeUnexpected(BlobError(BlobErrorCode::READ_FAILED));
             }
 
-            if (!home_obj_.verify_blob(read_buf.cbytes(), shard_id, 0 /* no blob_id check */)) {
+            auto const record = locate_blob_record(read_buf.cbytes(), read_buf.size(), blob_id);
+            if (!home_obj_.verify_blob(read_buf.cbytes() + record, shard_id, 0 /* no blob_id check */)) {
                 // The metrics for corrupted blob is handled on the follower side.
                 LOGE("Blob verification failed, shardID=0x{:x}, pg={}, shard=0x{:x}, blob_id={}", shard_id,
                      (shard_id >> homeobject::shard_width), (shard_id & homeobject::shard_mask), blob_id);
                 return blob_read_result(blob_id, std::move(read_buf), ResyncBlobState::CORRUPTED);
             }
 
+            // A blob packed with other small blobs is sent on its own, the receiver stores it as a single blob.
+            auto const header = decode_blob_header(read_buf.cbytes() + record);
+            if (header && header->blob_hdr_version == CompactBlobHeader::blob_header_version) {
+                auto const record_size =
+                    sisl::round_up(static_cast< uint64_t >(header->data_offset) + header->blob_size, io_align);
+                auto const record_blks_size = sisl::round_up(record_size, repl_dev_->get_blk_size());
+                if (record_blks_size < read_buf.size()) {
+                    sisl::io_blob_safe record_buf{uint32_cast(record_blks_size), io_align};
+                    std::memset(record_buf.bytes(), 0, record_blks_size);
+                    std::memcpy(record_buf.bytes(), read_buf.cbytes() + record, record_size);
+                    read_buf = std::move(record_buf);
+                }
+            }
+
             LOGD("Blob get success: shardID=0x{:x}, pg={}, shard=0x{:x}, blob_id={}", shard_id,
                  (shard_id >> homeobject::shard_width), (shard_id & homeobject::shard_mask), blob_id);
             return blob_read_result(blob_id, std::move(read_buf), ResyncBlobState::NORMAL);
@@ -10,7 +10,7 @@
 namespace homeobject {
 
 VENUM(ReplicationMessageType, uint16_t, CREATE_PG_MSG = 0, CREATE_SHARD_MSG = 1, SEAL_SHARD_MSG = 2, PUT_BLOB_MSG = 3,
-      DEL_BLOB_MSG = 4, UNKNOWN_MSG = 5);
+      DEL_BLOB_MSG = 4, UNKNOWN_MSG = 5, PUT_BLOB_BATCH_MSG = 6);
 VENUM(SyncMessageType, uint16_t, PG_META = 0, SHARD_META = 1, SHARD_BATCH = 2, LAST_MSG = 3);
 VENUM(ResyncBlobState, uint8_t, NORMAL = 0, DELETED = 1, CORRUPTED = 2);
 
@@ -39,6 +39,10 @@ void ReplicationStateMachine::on_commit(int64_t lsn, const sisl::blob& header, c
         home_object_->on_blob_put_commit(lsn, header, key, pbas[0], ctx);
         break;
     }
+    case ReplicationMessageType::PUT_BLOB_BATCH_MSG: {
+        home_object_->on_blob_batch_put_commit(lsn, header, key, pbas[0], ctx);
+        break;
+    }
     case ReplicationMessageType::DEL_BLOB_MSG:
         home_object_->on_blob_del_commit(lsn, header, key, ctx);
         break;
@@ -126,6 +130,7 @@ void ReplicationStateMachine::on_rollback(int64_t lsn, sisl::blob const& header,
     }
 
     case ReplicationMessageType::PUT_BLOB_MSG:
+    case ReplicationMessageType::PUT_BLOB_BATCH_MSG:
     case ReplicationMessageType::DEL_BLOB_MSG: {
         home_object_->on_blob_message_rollback(lsn, header, key, ctx);
         break;
@@ -193,6 +198,7 @@ void ReplicationStateMachine::on_error(ReplServiceError error, const sisl::blob&
         break;
     }
     case ReplicationMessageType::PUT_BLOB_MSG:
+    case ReplicationMessageType::PUT_BLOB_BATCH_MSG:
     case ReplicationMessageType::DEL_BLOB_MSG: {
         auto result_ctx =
             boost::static_pointer_cast< repl_result_ctx< BlobManager::Result< HSHomeObject::BlobInfo > > >(ctx).get();
@@ -257,7 +263,8 @@ ReplicationStateMachine::get_blk_alloc_hints(sisl::blob const& header, uint32_t
     }
 
     case ReplicationMessageType::PUT_BLOB_MSG:
-        return home_object_->blob_put_get_blk_alloc_hints(header, hs_ctx);
+    case ReplicationMessageType::PUT_BLOB_BATCH_MSG:
+        return home_object_->blob_put_get_blk_alloc_hints(header, data_size, hs_ctx);
 
     default: {
         LOGW("not support msg type for {} in get_blk_alloc_hints", msg_header->msg_type);
@@ -793,6 +800,130 @@ folly::Future< std::error_code > ReplicationStateMachine::on_fetch_data(const in
                 return ec;
             });
     }
+    case ReplicationMessageType::PUT_BLOB_BATCH_MSG: {
+        const auto shard_id = msg_header->shard_id;
+        const auto num_entries = msg_header->payload_size / sizeof(HSHomeObject::BlobBatchEntry);
+        if (header.size() < sizeof(ReplicationMessageHeader) + msg_header->payload_size ||
+            crc32_ieee(init_crc32, header.cbytes() + sizeof(ReplicationMessageHeader), msg_header->payload_size) !=
+                msg_header->payload_crc) {
+            LOGW("blob batch entries are corrupted, lsn={}, header={}", lsn, msg_header->to_string());
+            return folly::makeFuture< std::error_code >(std::make_error_code(std::errc::bad_message));
+        }
+
+        // one extent per group of adjacent entries with the same blk_offset, all their blobs are stored in it.
+        struct batch_extent {
+            uint32_t offset;
+            uint32_t size;
+            std::vector< blob_id_t > blob_ids;
+        };
+        auto const blk_size = repl_dev()->get_blk_size();
+        auto const* entries = r_cast< HSHomeObject::BlobBatchEntry const* >(header.cbytes() +
+                                                                             sizeof(ReplicationMessageHeader));
+        // every extent has to be inside the blocks allocated for the batch
+        auto const entry_out_of_range = [&](HSHomeObject::BlobBatchEntry const& entry) {
+            return entry.blk_count == 0 ||
+                (uint64_t{entry.blk_offset} + entry.blk_count) * blk_size > uint64_t{total_size};
+        };
+        if (num_entries == 0 || std::any_of(entries, entries + num_entries, entry_out_of_range)) {
+            LOGW("blob batch entries are out of the allocated blks, lsn={}, blks={}, header={}", lsn,
+                 local_blk_id.to_string(), msg_header->to_string());
+            return folly::makeFuture< std::error_code >(std::make_error_code(std::errc::bad_message));
+        }
+
+        std::vector< batch_extent > extents;
+        for (size_t i = 0; i < num_entries; ++i) {
+            if (i == 0 || entries[i].blk_offset != entries[i - 1].blk_offset) {
+                extents.push_back(batch_extent{entries[i].blk_offset * blk_size, entries[i].blk_count * blk_size, {}});
+            }
+            extents.back().blob_ids.push_back(entries[i].blob_id);
+        }
+
+        LOGD("fetch data of blob batch with first blob_id={}, shard=0x{:x}, extents={}", msg_header->blob_id,
+             shard_id, extents.size());
+        // like PUT_BLOB_MSG, read according to local_blk_id first and fall back to the index table for the extents
+        // which have been moved by gc meanwhile.
+        return std::move(homestore::data_service().async_read(local_blk_id, given_buffer, total_size))
+            .thenValue([this, lsn, shard_id, given_buffer, extents](auto&& err) -> folly::Future< std::error_code > {
+                if (err) {
+                    LOGE("FetchData fails to read blob batch, lsn={}, shard_id={}, err_value={}, error={}", lsn,
+                         shard_id, err.value(), err.message());
+                    return folly::makeFuture< std::error_code >(std::move(err));
+                }
+
+                pg_id_t pg_id = shard_id >> homeobject::shard_width;
+                std::vector< folly::Future< std::error_code > > reads;
+                for (auto const& extent : extents) {
+                    auto const extent_buf = given_buffer + extent.offset;
+                    auto const first_blob_id = extent.blob_ids.front();
+                    auto const record = HSHomeObject::locate_blob_record(extent_buf, extent.size, first_blob_id);
+                    if (home_object_->verify_blob(extent_buf + record, shard_id, first_blob_id)) { continue; }
+
+                    auto hs_pg = home_object_->get_hs_pg(pg_id);
+                    if (!hs_pg) {
+                        LOGE("pg not found for pg={}, shardID=0x{:x}", pg_id, shard_id);
+                        return folly::makeFuture< std::error_code >(std::make_error_code(std::errc::bad_address));
+                    }
+
+                    // any blob of the extent which is still alive leads to it, gc copies an extent as a whole.
+                    std::optional< homestore::MultiBlkId > pbas;
+                    for (auto const blob_id : extent.blob_ids) {
+                        BlobRouteKey index_key{BlobRoute{shard_id, blob_id}};
+                        BlobRouteValue index_value;
+                        homestore::BtreeSingleGetRequest get_req{&index_key, &index_value};
+                        if (hs_pg->index_table_->get(get_req) == homestore::btree_status_t::success &&
+                            index_value.pbas() != HSHomeObject::tombstone_pbas) {
+                            pbas = index_value.pbas();
+                            break;
+                        }
+                    }
+
+                    if (!pbas) {
+                        LOGD("on_fetch_data: return delete marker for blob_id={}, shardID=0x{:x}, pg={}",
+                             first_blob_id, shard_id, pg_id);
+                        std::memset(extent_buf, 0, extent.size);
+                        std::memcpy(extent_buf, HSHomeObject::delete_marker_blob_data.data(),
+                                    HSHomeObject::delete_marker_blob_data.size());
+                        continue;
+                    }
+
+                    RELEASE_ASSERT(pbas->blk_count() * repl_dev()->get_blk_size() == extent.size,
+                                   "pbas blk size does not match extent size");
+                    LOGD("on_fetch_data: read data with blob_id={}, shardID=0x{:x}, pg={} from pbas={}",
+                         first_blob_id, shard_id, pg_id, pbas->to_string());
+                    reads.emplace_back(homestore::data_service().async_read(*pbas, extent_buf, extent.size));
+                }
+                if (reads.empty()) {
+                    LOGD("blob batch valid, lsn={}, shardID=0x{:x}, pg={}", lsn, shard_id, pg_id);
+                    return folly::makeFuture< std::error_code >(std::error_code{});
+                }
+
+                return folly::collectAllUnsafe(reads).thenValue(
+                    [this, lsn, shard_id, given_buffer, extents](auto&& results) -> std::error_code {
+                        for (auto const& r : results) {
+                            RELEASE_ASSERT(r.hasValue(), "we never throw any exception when reading data");
+                            if (r.value()) {
+                                LOGE("IO error happens when reading data for blob batch, lsn={}, shardID=0x{:x}, "
+                                     "error={}",
+                                     lsn, shard_id, r.value().message());
+                                return r.value();
+                            }
+                        }
+                        for (auto const& extent : extents) {
+                            auto const extent_buf = given_buffer + extent.offset;
+                            auto const first_blob_id = extent.blob_ids.front();
+                            auto const record =
+                                HSHomeObject::locate_blob_record(extent_buf, extent.size, first_blob_id);
+                            if (!home_object_->verify_blob(extent_buf + record, shard_id, first_blob_id,
+                                                           true /* allow_delete_marker */)) {
+                                // the extent might be moved by gc again after we get the pba, let follower retry.
+                                return std::make_error_code(std::errc::resource_unavailable_try_again);
+                            }
+                        }
+                        LOGD("pba matches blob batch data, lsn={}, shardID=0x{:x}", lsn, shard_id);
+                        return std::error_code{};
+                    });
+            });
+    }
     default: {
         LOGW("msg type={}, should not happen in fetch_data rpc", msg_header->msg_type);
         return folly::makeFuture< std::error_code >(std::make_error_code(std::errc::operation_not_supported));
@@ -901,7 +1032,8 @@ void ReplicationStateMachine::on_no_space_left(homestore::repl_lsn_t lsn, sisl::
         }
 
         case ReplicationMessageType::SEAL_SHARD_MSG:
-        case ReplicationMessageType::PUT_BLOB_MSG: {
+        case ReplicationMessageType::PUT_BLOB_MSG:
+        case ReplicationMessageType::PUT_BLOB_BATCH_MSG: {
             auto p_chunkID = home_object_->get_shard_p_chunk_id(msg_header->shard_id);
             if (!p_chunkID.has_value()) {
                 LOGW("shardID=0x{:x}, pg={}, shard=0x{:x}, shard does not exist when handling on_no_space_left, "
@@ -1030,23 +1162,37 @@ void ReplicationStateMachine::on_log_replay_done(const homestore::group_id_t& gr
     const auto pg_id = pg_id_opt.value();
     RELEASE_ASSERT(home_object_->pg_exists(pg_id), "pg={} should exist, but not! fatal error!", pg_id);
 
-    const auto& shards_in_pg = (const_cast< HSHomeObject::HS_PG* >(home_object_->_get_hs_pg_unlocked(pg_id)))->shards_;
+    auto hs_pg = const_cast< HSHomeObject::HS_PG* >(home_object_->_get_hs_pg_unlocked(pg_id));
+    const auto& shards_in_pg = hs_pg->shards_;
     auto chunk_selector = home_object_->chunk_selector();
 
+    // the chunks of the open shards which are being gc are waited for together
+    std::vector< std::pair< shard_id_t, homestore::chunk_num_t > > open_shards;
+    std::vector< folly::SemiFuture< csharedChunk > > selections;
     for (const auto& shard_iter : shards_in_pg) {
         const auto& shard_sb = ((d_cast< HSHomeObject::HS_Shard* >(shard_iter.get()))->sb_).get();
         if (shard_sb->info.is_open()) {
-            const auto pg_id = shard_sb->info.placement_group;
-            const auto vchunk_id = shard_sb->v_chunk_id;
-            auto chunk = chunk_selector->select_specific_chunk(pg_id, vchunk_id);
-            RELEASE_ASSERT(chunk != nullptr, "chunk selection failed with v_chunk_id={} in pg={}", vchunk_id, pg_id);
-            LOGD("vchunk={} is selected for shard={} in pg={} when recovery", vchunk_id, shard_sb->info.id, pg_id);
+            open_shards.emplace_back(shard_sb->info.id, shard_sb->v_chunk_id);
+            selections.emplace_back(chunk_selector->select_specific_chunk_async(pg_id, shard_sb->v_chunk_id));
         }
     }
+    auto chunks = folly::collectAll(std::move(selections)).get();
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const auto& [shard_id, vchunk_id] = open_shards[i];
+        RELEASE_ASSERT(chunks[i].hasValue() && chunks[i].value() != nullptr,
+                       "chunk selection failed with v_chunk_id={} in pg={}", vchunk_id, pg_id);
+        LOGD("vchunk={} is selected for shard={} in pg={} when recovery", vchunk_id, shard_id, pg_id);
+    }
 
-    // Refresh PG statistics after log replay
-    LOGI("Starting statistics refresh for pg={}", pg_id);
-    home_object_->refresh_pg_statistics(pg_id);
+    // The replay has reconciled the durable counters of the last cp with the logs after it. Only a superblk without
+    // counters lsn needs a full scan of the pg to recount them.
+    if (hs_pg->counters_need_refresh_) {
+        LOGI("Starting statistics refresh for pg={}, its superblk has no counters lsn", pg_id);
+        home_object_->refresh_pg_statistics(pg_id);
+        hs_pg->counters_need_refresh_ = false;
+    } else {
+        LOGI("Statistics of pg={} recovered up to lsn={}", pg_id, hs_pg->counters_lsn_.load());
+    }
 }
 
 } // namespace homeobject
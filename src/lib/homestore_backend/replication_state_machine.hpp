@@ -61,6 +61,9 @@ struct ho_repl_ctx : public homestore::repl_req_ctx {
         data_bufs_.emplace_back(std::move(buf));
     }
 
+    // Keeps a buffer which data sgs point into alive until the request is done
+    void keep_data_buf(sisl::io_blob_safe&& buf) { data_bufs_.emplace_back(std::move(buf)); }
+
     sisl::sg_list& data_sgs() { return data_sgs_; }
     std::string data_sgs_string() const {
         fmt::memory_buffer buf;
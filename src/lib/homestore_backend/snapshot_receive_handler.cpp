@@ -53,7 +53,10 @@ int HSHomeObject::SnapshotReceiveHandler::process_pg_snapshot_data(ResyncPGMetaD
     auto hs_pg = ret.value();
 
     // Init a base set of pg blob & shard sequence num. Will catch up later on shard/blob creation if not up-to-date
-    hs_pg->shard_sequence_num_ = pg_meta.shard_seq_num();
+    {
+        std::scoped_lock lock_guard(hs_pg->mtx_);
+        hs_pg->shard_sequence_num_ = pg_meta.shard_seq_num();
+    }
     hs_pg->durable_entities_update(
         [&pg_meta](auto& de) { de.blob_sequence_num.store(pg_meta.blob_seq_num(), std::memory_order_relaxed); });
     hs_pg->pg_state_.set_state(PGStateMask::BASELINE_RESYNC);
@@ -840,6 +840,13 @@ private:
         }
     }
 
+    // The counters of a pg are updated in the commit of a log, right before the repl dev takes the log as committed.
+    void wait_for_counters_lsn(HSHomeObject::HS_PG* hs_pg) {
+        for (int i = 0; i < 100 && hs_pg->counters_lsn_.load() != hs_pg->repl_dev_->get_last_commit_lsn(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
     homeobject::Blob build_blob(blob_id_t blob_id) {
         uint32_t alignment = 512;
         // Create non 512 byte aligned address to create copy.
@@ -864,6 +871,15 @@ private:
         auto blob_size = blob.body.size();
 
         uint64_t actual_written_size{uint32_cast(sisl::round_up(sizeof(HSHomeObject::BlobHeader), io_align))};
+        if (HS_BACKEND_DYNAMIC_CONFIG(blob_header_compact)) {
+            using CompactBlobHeader = HSHomeObject::CompactBlobHeader;
+            actual_written_size = sisl::round_up(
+                CompactBlobHeader::header_size_for(
+                    blob.user_key.size(),
+                    CompactBlobHeader::hash_length(
+                        HSHomeObject::BlobHeader::HashAlgorithm{HS_BACKEND_DYNAMIC_CONFIG(blob_hash_algorithm)})),
+                io_align);
+        }
 
         if (((r_cast< uintptr_t >(blob.body.cbytes()) % io_align) != 0) || ((blob_size % io_align) != 0)) {
             blob_size = sisl::round_up(blob_size, io_align);
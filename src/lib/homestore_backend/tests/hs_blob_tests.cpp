@@ -442,6 +442,713 @@ TEST_F(HomeObjectFixture, DeleteNonExistBlob) {
     del_blob(1, shard_id, 1);
 }
 
+TEST_F(HomeObjectFixture, PutGetBlobWithCompactHeader) {
+    auto set_compact_header = [](bool enable) {
+        HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([enable](auto& s) { s.blob_header_compact = enable; });
+        HS_BACKEND_SETTINGS_FACTORY().save();
+    };
+
+    auto num_shards_per_pg = SISL_OPTIONS["num_shards"].as< uint64_t >();
+    auto num_blobs_per_shard = SISL_OPTIONS["num_blobs"].as< uint64_t >() / num_shards_per_pg;
+    std::map< pg_id_t, std::vector< shard_id_t > > pg_shard_id_vec;
+    std::map< pg_id_t, blob_id_t > pg_blob_id;
+
+    pg_id_t pg_id{1};
+    create_pg(pg_id);
+    pg_blob_id[pg_id] = 0;
+    for (uint64_t j = 0; j < num_shards_per_pg; j++) {
+        auto shard = create_shard(pg_id, 64 * Mi, "shard meta");
+        pg_shard_id_vec[pg_id].emplace_back(shard.id);
+    }
+
+    // blobs written with the compact header
+    set_compact_header(true);
+    put_blobs(pg_shard_id_vec, num_blobs_per_shard, pg_blob_id);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard, true /* use_random_offset */);
+
+    // blobs written with the fixed size header in the same shards, both formats must stay readable
+    set_compact_header(false);
+    std::map< pg_id_t, blob_id_t > v4_start_blob_id = pg_blob_id;
+    put_blobs(pg_shard_id_vec, num_blobs_per_shard, pg_blob_id);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard, true /* use_random_offset */);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard, true /* use_random_offset */,
+                    false /* wait_when_not_exist */, v4_start_blob_id);
+    verify_obj_count(1, num_blobs_per_shard * 2, num_shards_per_pg, false /* deleted */);
+
+    restart();
+
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard, false /* use_random_offset */,
+                    false /* wait_when_not_exist */, v4_start_blob_id);
+    verify_obj_count(1, num_blobs_per_shard * 2, num_shards_per_pg, false /* deleted */);
+}
+
+TEST_F(HomeObjectFixture, PutGetBlobWithHashAlgorithms) {
+    using HashAlgorithm = HSHomeObject::BlobHeader::HashAlgorithm;
+    auto set_header = [](bool compact, HashAlgorithm algorithm) {
+        HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([compact, algorithm](auto& s) {
+            s.blob_header_compact = compact;
+            s.blob_hash_algorithm = static_cast< uint8_t >(algorithm);
+        });
+        HS_BACKEND_SETTINGS_FACTORY().save();
+    };
+
+    auto num_shards_per_pg = SISL_OPTIONS["num_shards"].as< uint64_t >();
+    auto num_blobs_per_shard = SISL_OPTIONS["num_blobs"].as< uint64_t >() / num_shards_per_pg;
+    std::map< pg_id_t, std::vector< shard_id_t > > pg_shard_id_vec;
+    std::map< pg_id_t, blob_id_t > pg_blob_id;
+
+    pg_id_t pg_id{1};
+    create_pg(pg_id);
+    pg_blob_id[pg_id] = 0;
+    for (uint64_t j = 0; j < num_shards_per_pg; j++) {
+        auto shard = create_shard(pg_id, 64 * Mi, "shard meta");
+        pg_shard_id_vec[pg_id].emplace_back(shard.id);
+    }
+
+    // every algorithm with both header formats in the same shards, each blob is verified with its own algorithm
+    std::vector< std::map< pg_id_t, blob_id_t > > start_blob_ids;
+    for (bool compact : {false, true}) {
+        for (auto algorithm : {HashAlgorithm::CRC32, HashAlgorithm::CRC32C, HashAlgorithm::XXH3_64}) {
+            set_header(compact, algorithm);
+            start_blob_ids.push_back(pg_blob_id);
+            put_blobs(pg_shard_id_vec, num_blobs_per_shard, pg_blob_id);
+        }
+    }
+    set_header(false, HashAlgorithm::CRC32);
+
+    auto verify_blobs = [&]() {
+        for (auto const& start_blob_id : start_blob_ids) {
+            verify_get_blob(pg_shard_id_vec, num_blobs_per_shard, false /* use_random_offset */,
+                            false /* wait_when_not_exist */, start_blob_id);
+        }
+        verify_obj_count(1, num_blobs_per_shard * start_blob_ids.size(), num_shards_per_pg, false /* deleted */);
+    };
+    verify_blobs();
+    restart();
+    verify_blobs();
+}
+
+TEST_F(HomeObjectFixture, GetLargeBlobIntoBody) {
+    auto set_compact_header = [](bool enable) {
+        HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([enable](auto& s) { s.blob_header_compact = enable; });
+        HS_BACKEND_SETTINGS_FACTORY().save();
+    };
+
+    // blobs with an extent larger than max_packed_extent_size are read straight into the returned body
+    auto build_large_blob = [](blob_id_t blob_id, uint32_t size, uint32_t key_size) {
+        std::string user_key(key_size, 'k');
+        homeobject::Blob blob{sisl::io_blob_safe(size, homeobject::io_align), user_key, blob_id};
+        BitsGenerator::gen_blob_bits(blob.body, blob_id);
+        return blob;
+    };
+    std::vector< std::pair< uint32_t, uint32_t > > const sizes{
+        {HSHomeObject::max_packed_extent_size + 1, 16}, {256 * Ki, 600}, {Mi - 100, 16}, {Mi, 1000}};
+
+    pg_id_t pg_id{1};
+    create_pg(pg_id);
+    auto shard = create_shard(pg_id, 64 * Mi, "shard meta");
+    blob_id_t next_blob_id{0};
+
+    auto put_large_blobs = [&]() {
+        g_helper->sync();
+        run_on_pg_leader(pg_id, [&]() {
+            for (blob_id_t i = 0; i < sizes.size(); ++i) {
+                auto const [size, key_size] = sizes[i];
+                auto r = _obj_inst->blob_manager()
+                             ->put(shard.id, build_large_blob(next_blob_id + i, size, key_size))
+                             .get();
+                ASSERT_TRUE(!!r) << "failed to put large blob";
+                ASSERT_EQ(r.value(), next_blob_id + i);
+            }
+        });
+        next_blob_id += sizes.size();
+        wait_for_blob(shard.id, next_blob_id - 1);
+    };
+
+    // with either setting, blobs of both formats and of a header larger than io_align are read back
+    auto verify_large_blobs = [&]() {
+        for (blob_id_t blob_id = 0; blob_id < next_blob_id; ++blob_id) {
+            auto const [size, key_size] = sizes[blob_id % sizes.size()];
+            auto expected = build_large_blob(blob_id, size, key_size);
+            for (uint64_t len : {uint64_t{0}, uint64_t{size / 2}}) {
+                auto g = _obj_inst->blob_manager()->get(shard.id, blob_id, 0, len).get();
+                ASSERT_TRUE(!!g) << "get large blob fail, blob_id " << blob_id;
+                auto const expected_len = len == 0 ? size : len;
+                ASSERT_EQ(g.value().body.size(), expected_len);
+                ASSERT_EQ(std::memcmp(g.value().body.cbytes(), expected.body.cbytes(), expected_len), 0);
+                ASSERT_EQ(g.value().user_key, expected.user_key);
+                ASSERT_EQ(g.value().object_off, expected.object_off);
+            }
+        }
+    };
+
+    put_large_blobs();
+    verify_large_blobs();
+    set_compact_header(true);
+    verify_large_blobs();
+    put_large_blobs();
+    verify_large_blobs();
+    set_compact_header(false);
+    verify_large_blobs();
+}
+
+TEST_F(HomeObjectFixture, PutBlobWithFragments) {
+    auto set_compact_header = [](bool enable) {
+        HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([enable](auto& s) { s.blob_header_compact = enable; });
+        HS_BACKEND_SETTINGS_FACTORY().save();
+    };
+
+    pg_id_t pg_id{1};
+    create_pg(pg_id);
+    auto shard = create_shard(pg_id, 64 * Mi, "shard meta");
+
+    // fragments at every kind of alignment: unaligned heads and tails, aligned middles, and out of step ones
+    std::vector< std::pair< uint32_t /* offset in its buffer */, uint32_t /* length */ > > const layouts{
+        {1, 100}, {0, 8 * Ki}, {100, 3 * Ki + 7}, {512, 64 * Ki}, {3, 1}, {0, 513}, {256, 16 * Ki + 300}};
+    std::vector< sisl::io_blob_safe > bufs;
+    bufs.reserve(layouts.size());
+    std::vector< iovec > iovs;
+    uint64_t payload_size{0};
+    for (auto const& [offset, len] : layouts) {
+        bufs.emplace_back(offset + len, homeobject::io_align);
+        BitsGenerator::gen_random_bits(bufs.back());
+        iovs.emplace_back(iovec{.iov_base = bufs.back().bytes() + offset, .iov_len = len});
+        payload_size += len;
+    }
+    sisl::io_blob_safe expected{uint32_cast(payload_size)};
+    uint64_t pos{0};
+    for (auto const& iov : iovs) {
+        std::memcpy(expected.bytes() + pos, iov.iov_base, iov.iov_len);
+        pos += iov.iov_len;
+    }
+
+    // every suffix of the fragment list, so the payload starts at every alignment
+    blob_id_t next_blob_id{0};
+    std::string const user_key{"fragmented blob"};
+    for (bool compact : {false, true}) {
+        set_compact_header(compact);
+        g_helper->sync();
+        run_on_pg_leader(pg_id, [&]() {
+            for (size_t first = 0; first < iovs.size(); ++first) {
+                Blob blob{sisl::io_blob_safe(), user_key, first};
+                blob.body_sgs.iovs.assign(iovs.begin() + first, iovs.end());
+                for (auto const& iov : blob.body_sgs.iovs) {
+                    blob.body_sgs.size += iov.iov_len;
+                }
+                auto r = _obj_inst->blob_manager()->put(shard.id, std::move(blob)).get();
+                ASSERT_TRUE(!!r) << "failed to put fragmented blob";
+                ASSERT_EQ(r.value(), next_blob_id + first);
+            }
+        });
+        next_blob_id += iovs.size();
+        wait_for_blob(shard.id, next_blob_id - 1);
+    }
+    set_compact_header(false);
+
+    auto verify_blobs = [&]() {
+        for (blob_id_t blob_id = 0; blob_id < next_blob_id; ++blob_id) {
+            auto const first = blob_id % iovs.size();
+            uint64_t skipped{0};
+            for (size_t i = 0; i < first; ++i) {
+                skipped += iovs[i].iov_len;
+            }
+            auto g = _obj_inst->blob_manager()->get(shard.id, blob_id).get();
+            ASSERT_TRUE(!!g) << "get fragmented blob fail, blob_id " << blob_id;
+            ASSERT_EQ(g.value().body.size(), payload_size - skipped);
+            ASSERT_EQ(std::memcmp(g.value().body.cbytes(), expected.cbytes() + skipped, payload_size - skipped), 0);
+            ASSERT_EQ(g.value().user_key, user_key);
+            ASSERT_EQ(g.value().object_off, first);
+        }
+    };
+    verify_blobs();
+    restart();
+    verify_blobs();
+}
+
+TEST_F(HomeObjectFixture, GetBlobRangeWithDataCrcs) {
+    auto set_header = [](bool compact, bool data_crc) {
+        HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([compact, data_crc](auto& s) {
+            s.blob_header_compact = compact;
+            s.blob_data_crc = data_crc;
+        });
+        HS_BACKEND_SETTINGS_FACTORY().save();
+    };
+
+    // sizes around the data crc chunk sizes, the largest ones get chunks larger than 4K
+    auto build_blob = [](blob_id_t blob_id, uint32_t size) {
+        homeobject::Blob blob{sisl::io_blob_safe(size, homeobject::io_align), "range key", blob_id};
+        BitsGenerator::gen_blob_bits(blob.body, blob_id);
+        return blob;
+    };
+    std::vector< uint32_t > const sizes{64 * Ki + 3, 2 * Mi, 2 * Mi + 1, 5 * Mi + 123};
+
+    pg_id_t pg_id{1};
+    create_pg(pg_id);
+    auto shard = create_shard(pg_id, 64 * Mi, "shard meta");
+    blob_id_t next_blob_id{0};
+
+    // blobs without data crcs (either header format) are still read, in full
+    for (auto const [compact, data_crc] : std::vector< std::pair< bool, bool > >{{false, true}, {true, false},
+                                                                                  {true, true}}) {
+        set_header(compact, data_crc);
+        g_helper->sync();
+        run_on_pg_leader(pg_id, [&]() {
+            for (blob_id_t i = 0; i < sizes.size(); ++i) {
+                auto r = _obj_inst->blob_manager()->put(shard.id, build_blob(next_blob_id + i, sizes[i])).get();
+                ASSERT_TRUE(!!r) << "failed to put blob";
+                ASSERT_EQ(r.value(), next_blob_id + i);
+            }
+        });
+        next_blob_id += sizes.size();
+        wait_for_blob(shard.id, next_blob_id - 1);
+    }
+
+    auto verify_ranges = [&]() {
+        for (blob_id_t blob_id = 0; blob_id < next_blob_id; ++blob_id) {
+            auto const size = sizes[blob_id % sizes.size()];
+            auto expected = build_blob(blob_id, size);
+            std::vector< std::pair< uint64_t, uint64_t > > const ranges{{0, 1},          {1, 4 * Ki},
+                                                                        {4 * Ki - 1, 2}, {size / 2, 10 * Ki + 5},
+                                                                        {size - 1, 1},   {size - 33 * Ki, 33 * Ki}};
+            for (auto const& [offset, len] : ranges) {
+                auto g = _obj_inst->blob_manager()->get(shard.id, blob_id, offset, len, false /* allow_skip_verify */)
+                             .get();
+                ASSERT_TRUE(!!g) << "get blob range fail, blob_id " << blob_id << " offset " << offset;
+                ASSERT_EQ(g.value().body.size(), len);
+                ASSERT_EQ(std::memcmp(g.value().body.cbytes(), expected.body.cbytes() + offset, len), 0);
+                ASSERT_EQ(g.value().user_key, expected.user_key);
+            }
+        }
+    };
+    verify_ranges();
+    restart();
+    set_header(true, true);
+    verify_ranges();
+    set_header(false, false);
+}
+
+TEST_F(HomeObjectFixture, PutGetDelBlobWithPacking) {
+    auto set_packing = [](uint32_t max_blob_size, uint32_t max_extent_size) {
+        HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([max_blob_size, max_extent_size](auto& s) {
+            s.blob_pack_max_blob_size = max_blob_size;
+            s.blob_pack_max_extent_size = max_extent_size;
+        });
+        HS_BACKEND_SETTINGS_FACTORY().save();
+    };
+    set_packing(16 * Ki, HSHomeObject::max_packed_extent_size);
+
+    auto num_blobs_per_shard = SISL_OPTIONS["num_blobs"].as< uint64_t >();
+    std::map< pg_id_t, std::vector< shard_id_t > > pg_shard_id_vec;
+    std::map< pg_id_t, blob_id_t > pg_blob_id;
+
+    pg_id_t pg_id{1};
+    create_pg(pg_id);
+    pg_blob_id[pg_id] = 0;
+    auto shard = create_shard(pg_id, 64 * Mi, "shard meta");
+    pg_shard_id_vec[pg_id].emplace_back(shard.id);
+
+    // a put waiting for the previous one to complete is packed alone, so the blob ids stay predictable
+    put_blobs(pg_shard_id_vec, num_blobs_per_shard, pg_blob_id);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard, true /* use_random_offset */);
+
+    // a burst of puts without waiting is packed into shared extents. blob ids of packed blobs are contiguous, but the
+    // order of the puts is not kept, so the leader remembers which blob got which id.
+    uint64_t const num_burst_blobs = 64;
+    auto const burst_start_blob_id = pg_blob_id[pg_id];
+    std::map< blob_id_t, blob_id_t > burst_blob_seeds; // blob_id -> the seed build_blob used
+    g_helper->sync();
+    run_on_pg_leader(pg_id, [&]() {
+        std::vector< folly::SemiFuture< BlobManager::Result< blob_id_t > > > futs;
+        for (uint64_t i = 0; i < num_burst_blobs; ++i) {
+            futs.emplace_back(
+                _obj_inst->blob_manager()->put(shard.id, build_blob(burst_start_blob_id + i), generateRandomTraceId()));
+        }
+        for (uint64_t i = 0; i < num_burst_blobs; ++i) {
+            auto r = std::move(futs[i]).get();
+            ASSERT_TRUE(!!r) << "failed to put packed blob";
+            ASSERT_GE(r.value(), burst_start_blob_id);
+            ASSERT_LT(r.value(), burst_start_blob_id + num_burst_blobs);
+            ASSERT_TRUE(burst_blob_seeds.emplace(r.value(), burst_start_blob_id + i).second);
+        }
+    });
+    pg_blob_id[pg_id] = burst_start_blob_id + num_burst_blobs;
+    wait_for_blob(shard.id, pg_blob_id[pg_id] - 1);
+
+    auto verify_burst_blobs = [&](std::set< blob_id_t > const& deleted) {
+        for (auto blob_id = burst_start_blob_id; blob_id < pg_blob_id[pg_id]; ++blob_id) {
+            auto g = _obj_inst->blob_manager()->get(shard.id, blob_id, 0, 0, false /* allow_skip_verify */).get();
+            if (deleted.contains(blob_id)) {
+                ASSERT_FALSE(!!g) << "deleted blob_id " << blob_id << " is still readable";
+                continue;
+            }
+            ASSERT_TRUE(!!g) << "get packed blob fail, blob_id " << blob_id << " replica number "
+                             << g_helper->replica_num();
+            // only the replica which put the blobs knows their content, the others rely on the payload hash
+            auto it = burst_blob_seeds.find(blob_id);
+            if (it == burst_blob_seeds.end()) { continue; }
+            auto blob = build_blob(it->second);
+            auto const& result = g.value();
+            ASSERT_EQ(result.body.size(), blob.body.size());
+            EXPECT_EQ(std::memcmp(result.body.cbytes(), blob.body.cbytes(), blob.body.size()), 0);
+            EXPECT_EQ(result.user_key, blob.user_key);
+            EXPECT_EQ(result.object_off, blob.object_off);
+        }
+    };
+    auto verify_counts = [&](uint64_t const num_deleted) {
+        PGStats stats;
+        _obj_inst->pg_manager()->get_stats(pg_id, stats);
+        ASSERT_EQ(stats.num_active_objects, pg_blob_id[pg_id] - num_deleted);
+        ASSERT_EQ(stats.num_tombstone_objects, num_deleted);
+    };
+    verify_burst_blobs({});
+    verify_counts(0);
+
+    // deleting a blob must not free the extent it shares with blobs which are still alive
+    std::set< blob_id_t > deleted;
+    for (auto blob_id = burst_start_blob_id; blob_id < pg_blob_id[pg_id]; blob_id += 3) {
+        del_blob(pg_id, shard.id, blob_id);
+        deleted.insert(blob_id);
+    }
+    verify_burst_blobs(deleted);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard);
+    verify_counts(deleted.size());
+
+    restart();
+
+    verify_burst_blobs(deleted);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard);
+    verify_counts(deleted.size());
+
+    set_packing(0, 16 * Ki);
+}
+
+TEST_F(HomeObjectFixture, PutBlobBatch) {
+    auto set_packing = [](uint32_t max_blob_size) {
+        HS_BACKEND_SETTINGS_FACTORY().modifiable_settings(
+            [max_blob_size](auto& s) { s.blob_pack_max_blob_size = max_blob_size; });
+        HS_BACKEND_SETTINGS_FACTORY().save();
+    };
+
+    auto num_blobs_per_shard = SISL_OPTIONS["num_blobs"].as< uint64_t >();
+    uint64_t const batch_size = 16;
+    std::map< pg_id_t, std::vector< shard_id_t > > pg_shard_id_vec;
+    std::map< pg_id_t, blob_id_t > pg_blob_id;
+
+    pg_id_t pg_id{1};
+    create_pg(pg_id);
+    pg_blob_id[pg_id] = 0;
+    auto shard = create_shard(pg_id, 64 * Mi, "shard meta");
+    pg_shard_id_vec[pg_id].emplace_back(shard.id);
+
+    // blob ids of a batch are contiguous and in the order of the blobs, so build_blob can predict the content
+    auto put_batches = [&](uint64_t const num_blobs) {
+        g_helper->sync();
+        run_on_pg_leader(pg_id, [&]() {
+            auto empty = _obj_inst->blob_manager()->put_batch(shard.id, std::vector< Blob >{}).get();
+            ASSERT_FALSE(!!empty);
+            ASSERT_EQ(empty.error().getCode(), BlobErrorCode::INVALID_ARG);
+
+            // batches over blob_batch_max_count or blob_batch_max_size are rejected as a whole
+            for (auto const [max_count, max_size] :
+                 std::vector< std::pair< uint32_t, uint64_t > >{{2, 64 * Mi}, {1024, 1}}) {
+                HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([max_count, max_size](auto& s) {
+                    s.blob_batch_max_count = max_count;
+                    s.blob_batch_max_size = max_size;
+                });
+                HS_BACKEND_SETTINGS_FACTORY().save();
+                std::vector< Blob > blobs;
+                for (blob_id_t i = 0; i < 3; ++i) {
+                    blobs.emplace_back(build_blob(i));
+                }
+                auto oversized = _obj_inst->blob_manager()->put_batch(shard.id, std::move(blobs)).get();
+                ASSERT_FALSE(!!oversized);
+                ASSERT_EQ(oversized.error().getCode(), BlobErrorCode::INVALID_ARG);
+            }
+            HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([](auto& s) {
+                s.blob_batch_max_count = 1024;
+                s.blob_batch_max_size = 64 * Mi;
+            });
+            HS_BACKEND_SETTINGS_FACTORY().save();
+
+            for (uint64_t start = 0; start < num_blobs; start += batch_size) {
+                std::vector< Blob > blobs;
+                for (uint64_t i = start; i < std::min(start + batch_size, num_blobs); ++i) {
+                    blobs.emplace_back(build_blob(pg_blob_id[pg_id] + i));
+                }
+                auto const count = blobs.size();
+                auto r = _obj_inst->blob_manager()->put_batch(shard.id, std::move(blobs), generateRandomTraceId()).get();
+                ASSERT_TRUE(!!r) << "failed to put blob batch";
+                ASSERT_EQ(r.value().size(), count);
+                for (uint64_t i = 0; i < count; ++i) {
+                    ASSERT_EQ(r.value()[i], pg_blob_id[pg_id] + start + i);
+                }
+            }
+        });
+        pg_blob_id[pg_id] += num_blobs;
+        wait_for_blob(shard.id, pg_blob_id[pg_id] - 1);
+    };
+
+    // every blob in an extent of its own
+    put_batches(num_blobs_per_shard);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard, true /* use_random_offset */);
+
+    // small blobs of a batch packed together
+    set_packing(8 * Ki);
+    std::map< pg_id_t, blob_id_t > packed_start_blob_id = pg_blob_id;
+    put_batches(num_blobs_per_shard);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard, true /* use_random_offset */, false /* wait_when_not_exist */,
+                    packed_start_blob_id);
+    verify_obj_count(1, 1, num_blobs_per_shard * 2, false /* deleted */);
+
+    restart();
+
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard);
+    verify_get_blob(pg_shard_id_vec, num_blobs_per_shard, false /* use_random_offset */, false /* wait_when_not_exist */,
+                    packed_start_blob_id);
+    verify_obj_count(1, 1, num_blobs_per_shard * 2, false /* deleted */);
+
+    set_packing(0);
+}
+
+TEST_F(HomeObjectFixture, GetBlobBatch) {
+    auto num_blobs_per_shard = SISL_OPTIONS["num_blobs"].as< uint64_t >();
+    std::map< pg_id_t, std::vector< shard_id_t > > pg_shard_id_vec;
+    std::map< pg_id_t, blob_id_t > pg_blob_id;
+
+    pg_id_t pg_id{1};
+    create_pg(pg_id);
+    pg_blob_id[pg_id] = 0;
+    auto shard = create_shard(pg_id, 64 * Mi, "shard meta");
+    pg_shard_id_vec[pg_id].emplace_back(shard.id);
+
+    // blobs with an extent of their own, followed by small blobs packed into shared extents
+    put_blobs(pg_shard_id_vec, num_blobs_per_shard, pg_blob_id);
+    HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([](auto& s) { s.blob_pack_max_blob_size = 8 * Ki; });
+    HS_BACKEND_SETTINGS_FACTORY().save();
+    g_helper->sync();
+    run_on_pg_leader(pg_id, [&]() {
+        std::vector< Blob > blobs;
+        for (uint64_t i = 0; i < num_blobs_per_shard; ++i) {
+            blobs.emplace_back(build_blob(pg_blob_id[pg_id] + i));
+        }
+        auto r = _obj_inst->blob_manager()->put_batch(shard.id, std::move(blobs)).get();
+        ASSERT_TRUE(!!r) << "failed to put blob batch";
+    });
+    pg_blob_id[pg_id] += num_blobs_per_shard;
+    wait_for_blob(shard.id, pg_blob_id[pg_id] - 1);
+    HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([](auto& s) { s.blob_pack_max_blob_size = 0; });
+    HS_BACKEND_SETTINGS_FACTORY().save();
+
+    blob_id_t const deleted_blob_id = 1;
+    del_blob(pg_id, shard.id, deleted_blob_id);
+
+    // request the blobs out of order, with a duplicate, a deleted and a never written blob among them
+    std::vector< blob_id_t > blob_ids;
+    for (blob_id_t i = pg_blob_id[pg_id]; i > 0; --i) {
+        blob_ids.push_back(i - 1);
+    }
+    blob_ids.push_back(0);
+    blob_id_t const unknown_blob_id = pg_blob_id[pg_id] + 100;
+    blob_ids.push_back(unknown_blob_id);
+
+    auto verify_batch = [&]() {
+        auto r = _obj_inst->blob_manager()->get_batch(shard.id, blob_ids).get();
+        ASSERT_TRUE(!!r) << "failed to get blob batch";
+        auto& results = r.value();
+        ASSERT_EQ(results.size(), blob_ids.size());
+        for (size_t i = 0; i < blob_ids.size(); ++i) {
+            if (blob_ids[i] == deleted_blob_id || blob_ids[i] == unknown_blob_id) {
+                ASSERT_FALSE(!!results[i]);
+                ASSERT_EQ(results[i].error().getCode(), BlobErrorCode::UNKNOWN_BLOB);
+                continue;
+            }
+            ASSERT_TRUE(!!results[i]) << "get blob fail in batch, blob_id " << blob_ids[i];
+            auto expected = build_blob(blob_ids[i]);
+            auto const& result = results[i].value();
+            ASSERT_EQ(result.body.size(), expected.body.size());
+            ASSERT_EQ(std::memcmp(result.body.cbytes(), expected.body.cbytes(), result.body.size()), 0);
+            ASSERT_EQ(result.user_key, expected.user_key);
+            ASSERT_EQ(result.object_off, expected.object_off);
+        }
+
+        // sparse requests, whose range is mostly taken by blobs which are not asked for: every third blob, and the
+        // first and the last blob together with one far beyond them, which are resolved by queries of their own
+        std::vector< blob_id_t > sparse_ids;
+        for (blob_id_t i = 0; i < pg_blob_id[pg_id]; i += 3) {
+            if (i != deleted_blob_id) { sparse_ids.push_back(i); }
+        }
+        blob_id_t const far_blob_id = pg_blob_id[pg_id] + 10'000'000;
+        std::vector< blob_id_t > const far_ids{far_blob_id, pg_blob_id[pg_id] - 1, 0};
+        for (auto const& ids : {sparse_ids, far_ids}) {
+            auto sparse = _obj_inst->blob_manager()->get_batch(shard.id, ids).get();
+            ASSERT_TRUE(!!sparse) << "failed to get sparse blob batch";
+            ASSERT_EQ(sparse.value().size(), ids.size());
+            for (size_t i = 0; i < ids.size(); ++i) {
+                if (ids[i] == far_blob_id) {
+                    ASSERT_FALSE(!!sparse.value()[i]);
+                    ASSERT_EQ(sparse.value()[i].error().getCode(), BlobErrorCode::UNKNOWN_BLOB);
+                    continue;
+                }
+                ASSERT_TRUE(!!sparse.value()[i]) << "get blob fail in sparse batch, blob_id " << ids[i];
+                auto expected = build_blob(ids[i]);
+                auto const& result = sparse.value()[i].value();
+                ASSERT_EQ(result.body.size(), expected.body.size());
+                ASSERT_EQ(std::memcmp(result.body.cbytes(), expected.body.cbytes(), result.body.size()), 0);
+            }
+        }
+
+        auto empty = _obj_inst->blob_manager()->get_batch(shard.id, std::vector< blob_id_t >{}).get();
+        ASSERT_FALSE(!!empty);
+        ASSERT_EQ(empty.error().getCode(), BlobErrorCode::INVALID_ARG);
+    };
+
+    verify_batch();
+    restart();
+    verify_batch();
+}
+
+TEST_F(HomeObjectFixture, GetUnknownBlobWithBlobFilter) {
+    auto num_blobs_per_shard = SISL_OPTIONS["num_blobs"].as< uint64_t >();
+    std::map< pg_id_t, std::vector< shard_id_t > > pg_shard_id_vec;
+    std::map< pg_id_t, blob_id_t > pg_blob_id;
+    pg_id_t pg_id{1};
+    create_pg(pg_id);
+    pg_blob_id[pg_id] = 0;
+    auto shard = create_shard(pg_id, 64 * Mi, "shard meta");
+    auto other_shard = create_shard(pg_id, 64 * Mi, "shard meta");
+    pg_shard_id_vec[pg_id].emplace_back(shard.id);
+    put_blobs(pg_shard_id_vec, num_blobs_per_shard, pg_blob_id);
+
+    auto blob_filter = [this](shard_id_t shard_id) -> BlobIdFilter const& {
+        auto hs_shard = _obj_inst->_get_hs_shard(shard_id);
+        RELEASE_ASSERT(hs_shard, "shard {} not found", shard_id);
+        return hs_shard->blob_filter_;
+    };
+    auto verify = [&]() {
+        ASSERT_TRUE(blob_filter(shard.id).is_ready());
+        ASSERT_TRUE(blob_filter(other_shard.id).is_ready());
+        verify_get_blob(pg_shard_id_vec, num_blobs_per_shard);
+        for (blob_id_t blob_id = 0; blob_id < pg_blob_id[pg_id]; ++blob_id) {
+            ASSERT_TRUE(blob_filter(shard.id).maybe_contains(blob_id)) << "blob_id " << blob_id;
+        }
+        // blobs never put into the shard, the filter answers most of them and the index the rest
+        for (auto const [shard_id, first_blob_id] :
+             std::vector< std::pair< shard_id_t, blob_id_t > >{{shard.id, pg_blob_id[pg_id]}, {other_shard.id, 0}}) {
+            for (blob_id_t blob_id = first_blob_id; blob_id < first_blob_id + 100; ++blob_id) {
+                auto g = _obj_inst->blob_manager()->get(shard_id, blob_id).get();
+                ASSERT_FALSE(!!g) << "get unknown blob succeeded, blob_id " << blob_id;
+                ASSERT_EQ(g.error().getCode(), BlobErrorCode::UNKNOWN_BLOB);
+            }
+        }
+    };
+
+    verify();
+    // the filters of the recovered shards are rebuilt from the index
+    restart();
+    verify();
+}
+
+TEST_F(HomeObjectFixture, GetBlobFromReadCache) {
+    // the cache is created at start
+    auto set_cache_size_mb = [](uint64_t size_mb) {
+        HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([size_mb](auto& s) { s.blob_read_cache_size_mb = size_mb; });
+        HS_BACKEND_SETTINGS_FACTORY().save();
+    };
+    set_cache_size_mb(64);
+    restart();
+    auto cache = _obj_inst->blob_read_cache();
+    ASSERT_NE(cache, nullptr);
+    ASSERT_EQ(cache->size_bytes(), 0);
+
+    auto num_blobs_per_shard = SISL_OPTIONS["num_blobs"].as< uint64_t >();
+    std::map< pg_id_t, std::vector< shard_id_t > > pg_shard_id_vec;
+    std::map< pg_id_t, blob_id_t > pg_blob_id;
+    pg_id_t pg_id{1};
+    create_pg(pg_id);
+    pg_blob_id[pg_id] = 0;
+    auto shard = create_shard(pg_id, 64 * Mi, "shard meta");
+    pg_shard_id_vec[pg_id].emplace_back(shard.id);
+    put_blobs(pg_shard_id_vec, num_blobs_per_shard, pg_blob_id);
+
+    // the first get reads the device and fills the cache, the second one is served from it
+    for (int round = 0; round < 2; ++round) {
+        verify_get_blob(pg_shard_id_vec, num_blobs_per_shard);
+    }
+    ASSERT_GT(cache->size_bytes(), 0);
+    ASSERT_LE(cache->size_bytes(), cache->budget_bytes());
+
+    // ranges of a cached blob
+    blob_id_t const blob_id = 0;
+    auto expected = build_blob(blob_id);
+    auto const blob_size = expected.body.size();
+    for (auto const [off, len] : std::vector< std::pair< uint64_t, uint64_t > >{
+             {0, 1}, {1, blob_size - 1}, {blob_size / 2, 0}, {blob_size, 0}}) {
+        auto g = _obj_inst->blob_manager()->get(shard.id, blob_id, off, len).get();
+        ASSERT_TRUE(!!g) << "get range fail, off " << off << " len " << len;
+        auto const expected_len = len ? len : blob_size - off;
+        ASSERT_EQ(g.value().body.size(), expected_len);
+        ASSERT_EQ(std::memcmp(g.value().body.cbytes(), expected.body.cbytes() + off, expected_len), 0);
+        ASSERT_EQ(g.value().user_key, expected.user_key);
+    }
+    auto out_of_range = _obj_inst->blob_manager()->get(shard.id, blob_id, blob_size, 1).get();
+    ASSERT_FALSE(!!out_of_range);
+    ASSERT_EQ(out_of_range.error().getCode(), BlobErrorCode::INVALID_ARG);
+
+    // a deleted blob is not served from the cache
+    del_blob(pg_id, shard.id, blob_id);
+    auto deleted = _obj_inst->blob_manager()->get(shard.id, blob_id).get();
+    ASSERT_FALSE(!!deleted);
+    ASSERT_EQ(deleted.error().getCode(), BlobErrorCode::UNKNOWN_BLOB);
+
+    set_cache_size_mb(0);
+    restart();
+    ASSERT_EQ(_obj_inst->blob_read_cache(), nullptr);
+}
+
+// Put throughput from 1 to max_threads threads, each putting to a pg of its own, which shows how blob puts on
+// different pgs scale. Disabled by default, run with --gtest_also_run_disabled_tests.
+TEST_F(HomeObjectFixture, DISABLED_ConcurrentPutThroughput) {
+    uint32_t const max_threads = 8;
+    auto const num_blobs_per_thread = SISL_OPTIONS["num_blobs"].as< uint64_t >();
+    std::vector< shard_id_t > shards;
+    for (pg_id_t pg_id = 1; pg_id <= max_threads; ++pg_id) {
+        create_pg(pg_id);
+        shards.push_back(create_shard(pg_id, 64 * Mi, "shard meta").id);
+    }
+
+    blob_id_t next_blob_id{0};
+    for (uint32_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        g_helper->sync();
+        std::atomic< uint64_t > num_puts{0};
+        auto const start = std::chrono::steady_clock::now();
+        std::vector< std::thread > threads;
+        for (uint32_t t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                pg_id_t const pg_id = t + 1;
+                run_on_pg_leader(pg_id, [&]() {
+                    for (uint64_t i = 0; i < num_blobs_per_thread; ++i) {
+                        auto r = _obj_inst->blob_manager()->put(shards[t], build_blob(next_blob_id + i)).get();
+                        ASSERT_TRUE(!!r) << "failed to put blob";
+                        num_puts.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto const secs = std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+        if (num_puts > 0) {
+            LOGINFO("threads={} puts={} {:.0f} puts/s", num_threads, num_puts.load(), double(num_puts) / secs);
+        }
+        next_blob_id += num_blobs_per_thread;
+    }
+}
+
 #ifdef _PRERELEASE
 TEST_F(HomeObjectFixture, BasicPutGetBlobWithPushDataDisabled) {
     // disable leader push data. As a result, followers have to fetch data to exercise the fetch_data implementation of
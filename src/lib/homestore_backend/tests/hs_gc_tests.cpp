@@ -413,6 +413,302 @@ TEST_F(HomeObjectFixture, HandlingNoSpaceLeft) {
     verify_shard_blobs(shard_blob_ids_map);
 }
 
+// The garbage index of a chunk follows its deletes and is seeded from homestore after a restart. With
+// gc_trigger_on_garbage, a delete which takes a chunk over the threshold gets it gc-ed before the next scan.
+TEST_F(HomeObjectFixture, GCTriggeredByDeletes) {
+    auto set_gc_settings = [](bool trigger_on_garbage, uint8_t garbage_rate_threshold) {
+        HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([trigger_on_garbage, garbage_rate_threshold](auto& s) {
+            s.gc_trigger_on_garbage = trigger_on_garbage;
+            s.gc_garbage_rate_threshold = garbage_rate_threshold;
+        });
+        HS_BACKEND_SETTINGS_FACTORY().save();
+    };
+    auto chunk_garbage_blks = [this](homestore::chunk_num_t chunk_id) {
+        auto gc_mgr = std::const_pointer_cast< GCManager >(_obj_inst->gc_manager());
+        auto vchunk = _obj_inst->chunk_selector()->get_extend_vchunk(chunk_id);
+        return gc_mgr->get_pdev_gc_actor(vchunk->get_pdev_id())->chunk_garbage().garbage_blks(chunk_id);
+    };
+    // no chunk crosses the threshold until the second phase
+    set_gc_settings(false, 100);
+
+    const auto num_blobs_per_shard = 2 * SISL_OPTIONS["num_blobs"].as< uint64_t >();
+    const pg_id_t pg_id = 1;
+    create_pg(pg_id);
+    std::map< pg_id_t, blob_id_t > pg_blob_id{{pg_id, 0}};
+
+    // both shards are open at once, so that they are in different chunks
+    const auto seeded_shard = create_shard(pg_id, 64 * Mi, "gc seeded shard").id;
+    const auto triggered_shard = create_shard(pg_id, 64 * Mi, "gc triggered shard").id;
+    auto shard_blobs = put_blobs({{pg_id, {seeded_shard, triggered_shard}}}, num_blobs_per_shard, pg_blob_id);
+    ASSERT_EQ(ShardInfo::State::SEALED, seal_shard(seeded_shard).state);
+    ASSERT_EQ(ShardInfo::State::SEALED, seal_shard(triggered_shard).state);
+    const auto seeded_chunk = _obj_inst->get_shard_p_chunk_id(seeded_shard).value();
+    const auto triggered_chunk = _obj_inst->get_shard_p_chunk_id(triggered_shard).value();
+    ASSERT_NE(seeded_chunk, triggered_chunk);
+    ASSERT_EQ(chunk_garbage_blks(seeded_chunk), 0);
+
+    // the blks of the deletes are counted by their commits
+    std::map< shard_id_t, std::set< blob_id_t > > deleted_blobs;
+    uint64_t deleted_blks{0};
+    for (const auto& [blob_id, blk_count] : shard_blobs[seeded_shard]) {
+        if (deleted_blobs[seeded_shard].size() == num_blobs_per_shard / 2) { break; }
+        deleted_blobs[seeded_shard].insert(blob_id);
+        deleted_blks += blk_count;
+    }
+    del_blobs(pg_id, deleted_blobs);
+    ASSERT_EQ(chunk_garbage_blks(seeded_chunk), deleted_blks);
+
+    // nothing is persisted, the index is seeded with the defrag blks of homestore
+    restart();
+    auto vchunk = _obj_inst->chunk_selector()->get_extend_vchunk(seeded_chunk);
+    ASSERT_GE(vchunk->get_defrag_nblks(), deleted_blks);
+    ASSERT_EQ(chunk_garbage_blks(seeded_chunk), vchunk->get_defrag_nblks());
+    ASSERT_EQ(chunk_garbage_blks(triggered_chunk), 0);
+
+    // a single delete takes the chunk without garbage over a threshold of 0
+    set_gc_settings(true, 0);
+    g_helper->sync();
+    const auto start = std::chrono::steady_clock::now();
+    const auto deleted_blob_id = shard_blobs[triggered_shard].begin()->first;
+    del_blobs(pg_id, {{triggered_shard, {deleted_blob_id}}});
+
+    // the shard leaves the chunk well before a scan could have picked it
+    const auto deadline = start + std::chrono::seconds(HS_BACKEND_DYNAMIC_CONFIG(gc_scan_interval_sec)) / 2;
+    while (_obj_inst->get_shard_p_chunk_id(triggered_shard).value() == triggered_chunk) {
+        ASSERT_LT(std::chrono::steady_clock::now(), deadline) << "chunk_id=" << triggered_chunk << " is not gc-ed";
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    std::map< shard_id_t, std::set< blob_id_t > > remaining_blobs;
+    for (const auto& [blob_id, _] : shard_blobs[triggered_shard]) {
+        if (blob_id != deleted_blob_id) { remaining_blobs[triggered_shard].insert(blob_id); }
+    }
+    verify_shard_blobs(remaining_blobs);
+    set_gc_settings(false, 50);
+}
+
+TEST(GCCopyRunTest, PlanCopyRuns) {
+    using actor = GCManager::pdev_gc_actor;
+    auto extent = [](homestore::blk_num_t blk_num, homestore::blk_count_t blk_count, blob_id_t blob_id) {
+        homestore::MultiBlkId pbas;
+        pbas.add(blk_num, blk_count, 1 /* chunk */);
+        return actor::gc_extent{pbas, {blob_id}};
+    };
+
+    // out of order in the index, a 2 blks gap between 4 and 6, and a 10 blks gap between 8 and 18
+    std::vector< actor::gc_extent > extents{extent(18, 2, 4), extent(0, 2, 1), extent(6, 2, 3), extent(2, 2, 2)};
+    auto runs = actor::plan_copy_runs(extents, 16, 2);
+    ASSERT_EQ(runs.size(), 2);
+    for (size_t i = 0; i < extents.size(); ++i) {
+        ASSERT_EQ(extents[i].blob_ids.front(), i + 1) << "extents should be sorted by offset";
+    }
+    ASSERT_EQ(runs[0].blk_num, 0);
+    ASSERT_EQ(runs[0].read_blk_count, 8);
+    ASSERT_EQ(runs[0].live_blk_count, 6);
+    ASSERT_EQ(runs[0].extent_begin, 0);
+    ASSERT_EQ(runs[0].extent_end, 3);
+    ASSERT_EQ(runs[1].blk_num, 18);
+    ASSERT_EQ(runs[1].read_blk_count, 2);
+    ASSERT_EQ(runs[1].extent_begin, 3);
+    ASSERT_EQ(runs[1].extent_end, 4);
+
+    // the io size bounds a run, an extent larger than it still gets its own run
+    runs = actor::plan_copy_runs(extents, 4, 16);
+    ASSERT_EQ(runs.size(), 3);
+    ASSERT_EQ(runs[0].read_blk_count, 4);
+    ASSERT_EQ(runs[1].blk_num, 6);
+    extents.emplace_back(extent(20, 8, 5));
+    runs = actor::plan_copy_runs(extents, 4, 16);
+    ASSERT_EQ(runs.back().blk_num, 20);
+    ASSERT_EQ(runs.back().read_blk_count, 8);
+
+    // 0 copies every extent alone
+    runs = actor::plan_copy_runs(extents, 0, 0);
+    ASSERT_EQ(runs.size(), extents.size());
+}
+
+TEST(GCVictimTest, CostBenefitScore) {
+    // a cold chunk with less garbage is worth more than a hot one, whose live data is likely to be deleted soon
+    const auto hot = GCManager::cost_benefit_score(600, 400, 10);
+    const auto cold = GCManager::cost_benefit_score(300, 700, 3600);
+    ASSERT_DOUBLE_EQ(hot, 7.5);
+    ASSERT_GT(cold, hot);
+
+    // more garbage at the same age is always better
+    ASSERT_GT(GCManager::cost_benefit_score(700, 300, 60), GCManager::cost_benefit_score(600, 400, 60));
+    // nothing to copy is the best, no age the worst
+    ASSERT_TRUE(std::isinf(GCManager::cost_benefit_score(1, 0, 0)));
+    ASSERT_EQ(GCManager::cost_benefit_score(600, 400, 0), 0);
+}
+
+TEST(GCVictimTest, ChunkGarbageIndex) {
+    GCManager::ChunkGarbageIndex index;
+    // 100 blks per chunk, the threshold is 50%
+    ASSERT_FALSE(index.add(1, 30, 100, 50));
+    ASSERT_FALSE(index.add(2, 50, 100, 50)) << "exactly at the threshold is not over it";
+    ASSERT_TRUE(index.add(1, 30, 100, 50)) << "chunk 1 crosses the threshold";
+    ASSERT_FALSE(index.add(1, 10, 100, 50)) << "only the crossing is reported";
+    ASSERT_TRUE(index.add(3, 90, 100, 50));
+    ASSERT_EQ(index.garbage_blks(1), 70);
+    ASSERT_EQ(index.garbage_blks(4), 0);
+    ASSERT_EQ(index.size(), 3);
+
+    // the highest ratio first, the rest is not returned
+    ASSERT_EQ(index.over_threshold(50), (std::vector< chunk_id_t >{3, 1}));
+    ASSERT_EQ(index.over_threshold(50), (std::vector< chunk_id_t >{3, 1})) << "the index is kept";
+    ASSERT_EQ(index.over_threshold(20), (std::vector< chunk_id_t >{3, 1, 2}));
+
+    // a gc-ed chunk is dropped, and crosses again from its new garbage
+    index.set(3, 0, 100);
+    ASSERT_EQ(index.size(), 2);
+    ASSERT_EQ(index.over_threshold(50), (std::vector< chunk_id_t >{1}));
+    index.set(1, 10, 100);
+    ASSERT_TRUE(index.over_threshold(50).empty());
+    ASSERT_TRUE(index.add(1, 41, 100, 50));
+
+    // reconciling with homestore only ever raises the count
+    index.raise(1, 20, 100);
+    ASSERT_EQ(index.garbage_blks(1), 51);
+    index.raise(4, 60, 100);
+    ASSERT_EQ(index.garbage_blks(4), 60);
+    ASSERT_EQ(index.over_threshold(50), (std::vector< chunk_id_t >{4, 1}));
+}
+
+TEST(GCRateLimiterTest, TokenBucket) {
+    using namespace std::chrono;
+    GCManager::RateLimiter limiter;
+    const steady_clock::time_point start{seconds(100)};
+
+    // 1000 tokens per second, a full bucket is only the 1ms burst
+    ASSERT_EQ(limiter.acquire(1000, 1000, start), nanoseconds{0});
+    ASSERT_EQ(limiter.acquire(1000, 1000, start), milliseconds(999));
+    // the tokens are refilled continuously, the waits of the reserved tokens add up
+    ASSERT_EQ(limiter.acquire(1, 1000, start + milliseconds(500)), milliseconds(1499));
+    // a new rate applies to the next acquire at once
+    ASSERT_EQ(limiter.acquire(1000, 2000, start + seconds(2)), nanoseconds{0});
+    ASSERT_EQ(limiter.acquire(1, 2000, start + seconds(2)), milliseconds(500));
+
+    // idle time is only credited up to the burst
+    const auto idle = start + seconds(60);
+    ASSERT_EQ(limiter.acquire(2, 1000, idle), nanoseconds{0});
+    ASSERT_EQ(limiter.acquire(1, 1000, idle), milliseconds(1));
+
+    // 0 is unlimited
+    ASSERT_EQ(limiter.acquire(1000000, 0, idle), nanoseconds{0});
+}
+
+TEST(GCRateControllerTest, Simulation) {
+    const GCManager::RateController::Settings settings{.min_rate = 1024,
+                                                       .max_rate = 131072,
+                                                       .target_latency_us = 10000,
+                                                       .step = 1024,
+                                                       .decrease = 0.5,
+                                                       .low_free_ratio = 0.2};
+    // a simulated pdev whose client p99 latency grows with the gc io rate, the target is hit at 32000 blks/s
+    auto client_latency_us = [](uint64_t gc_rate) { return 2000 + gc_rate / 4; };
+    GCManager::RateController controller{7680};
+
+    // no client io, gc speeds up to the max rate
+    for (int i = 0; i < 200; ++i) {
+        controller.update(settings, 0, 0.8);
+    }
+    ASSERT_EQ(controller.rate(), settings.max_rate);
+
+    // under client load, gc backs off and then stays around the highest rate within the target
+    uint64_t over_target{0};
+    for (int i = 0; i < 1000; ++i) {
+        const auto latency = client_latency_us(controller.rate());
+        const auto rate = controller.update(settings, latency, 0.8);
+        if (i < 100) { continue; }
+        if (latency > settings.target_latency_us) { ++over_target; }
+        ASSERT_GE(rate, 16000);
+        ASSERT_LE(rate, 32000 + settings.step);
+    }
+    ASSERT_LT(over_target, 100);
+
+    // while the pdev runs out of space, the client latency can not push gc below the rising floor
+    ASSERT_EQ(controller.update(settings, 1000000, 0.05), 1024 + (131072 - 1024) * 3 / 4);
+    ASSERT_EQ(controller.update(settings, 1000000, 0.0), settings.max_rate);
+    ASSERT_EQ(controller.update(settings, 1000000, 0.8), settings.max_rate / 2);
+
+    // the latency window reports the p99 bucket and is empty after it is taken
+    GCManager::LatencyWindow window;
+    ASSERT_EQ(window.take_percentile(99.0), 0);
+    for (int i = 0; i < 990; ++i) {
+        window.record(1000);
+    }
+    for (int i = 0; i < 10; ++i) {
+        window.record(50000);
+    }
+    const auto p99 = window.take_percentile(99.0);
+    ASSERT_GE(p99, 1000);
+    ASSERT_LT(p99, 1000 * 5 / 4);
+    window.record(50000);
+    ASSERT_GE(window.take_percentile(99.0), 50000);
+    ASSERT_EQ(window.take_percentile(99.0), 0);
+}
+
+// Throughput of the gc data copy for several gc_copy_queue_depth on the file backed devices of the fixture, disabled
+// by default. Every round fills chunks with sealed shards, deletes every other blob and times the normal gc of them.
+TEST_F(HomeObjectFixture, DISABLED_GCThroughput) {
+    const auto num_shards = SISL_OPTIONS["num_shards"].as< uint64_t >();
+    const auto num_blobs_per_shard = 2 * SISL_OPTIONS["num_blobs"].as< uint64_t >();
+    const pg_id_t pg_id = 1;
+    create_pg(pg_id);
+    std::map< pg_id_t, blob_id_t > pg_blob_id{{pg_id, 0}};
+    auto chunk_selector = _obj_inst->chunk_selector();
+    auto gc_mgr = _obj_inst->gc_manager();
+    const auto blk_size = homestore::data_service().get_blk_size();
+
+    for (uint32_t depth : {1u, 4u, 16u, 64u}) {
+        // the copy is not throttled, so that only the queue depth bounds it
+        HS_BACKEND_SETTINGS_FACTORY().modifiable_settings([depth](auto& s) {
+            s.gc_copy_queue_depth = depth;
+            s.max_read_write_block_count_per_second = 0;
+            s.gc_adaptive_rate = false;
+        });
+        HS_BACKEND_SETTINGS_FACTORY().save();
+
+        std::map< pg_id_t, std::vector< shard_id_t > > pg_shard_ids;
+        for (uint64_t i = 0; i < num_shards; i++) {
+            pg_shard_ids[pg_id].emplace_back(create_shard(pg_id, 64 * Mi, "gc throughput").id);
+        }
+        auto shard_blobs = put_blobs(pg_shard_ids, num_blobs_per_shard, pg_blob_id);
+
+        std::set< homestore::chunk_num_t > chunks;
+        std::map< shard_id_t, std::set< blob_id_t > > deleted_blobs;
+        for (const auto& [shard_id, blob_to_blk_count] : shard_blobs) {
+            ASSERT_EQ(ShardInfo::State::SEALED, seal_shard(shard_id).state);
+            chunks.insert(_obj_inst->get_shard_p_chunk_id(shard_id).value());
+            // the valid blobs are not adjacent, so the runs read through the gaps
+            bool del{true};
+            for (const auto& [blob_id, _] : blob_to_blk_count) {
+                if (del) { deleted_blobs[shard_id].insert(blob_id); }
+                del = !del;
+            }
+        }
+        del_blobs(pg_id, deleted_blobs);
+
+        uint64_t live_blks{0};
+        for (const auto chunk_id : chunks) {
+            auto vchunk = chunk_selector->get_extend_vchunk(chunk_id);
+            live_blks += vchunk->get_used_blks() - vchunk->get_defrag_nblks();
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector< folly::SemiFuture< bool > > futs;
+        for (const auto chunk_id : chunks) {
+            futs.emplace_back(gc_mgr->submit_gc_task(task_priority::normal, chunk_id));
+        }
+        for (auto const& ok : folly::collectAll(futs).get()) {
+            ASSERT_TRUE(ok.hasValue() && ok.value());
+        }
+        const auto secs = std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+        LOGINFO("gc_copy_queue_depth={:>3} chunks={} copied={} MB in {:.3f}s, {:.2f} MB/s", depth, chunks.size(),
+                live_blks * blk_size / Mi, secs, live_blks * blk_size / secs / Mi);
+    }
+}
+
 TEST_F(HomeObjectFixture, BasicEGC) { EmergentGC(false); }
 
 TEST_F(HomeObjectFixture, EGCWithCrashRecovery) { EmergentGC(true); }
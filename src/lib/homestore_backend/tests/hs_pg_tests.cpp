@@ -45,6 +45,15 @@ TEST_F(HomeObjectFixture, PGStatsTest) {
 
     auto stats = _obj_inst->get_stats();
     LOGINFO("HomeObj stats={}", stats.to_string());
+    EXPECT_EQ(stats.num_open_shards, 1);
+
+    // the shard counts are rebuilt from the recovered shards
+    restart();
+    res = _obj_inst->pg_manager()->get_stats(pg_id, pg_stats);
+    EXPECT_EQ(res, true);
+    EXPECT_EQ(pg_stats.total_shards, 2);
+    EXPECT_EQ(pg_stats.open_shards, 1);
+    EXPECT_EQ(_obj_inst->get_stats().num_open_shards, 1);
 }
 
 TEST_F(HomeObjectFixture, PGExceedSpaceTest) {
@@ -486,35 +495,152 @@ TEST_F(HomeObjectFixture, PGRefreshStatisticsTest) {
         << "Active blob count should be " << (num_active_blobs - num_tombstones);
     EXPECT_EQ(pg_stats.num_tombstone_objects, num_tombstones) << "Tombstone blob count should be " << num_tombstones;
     EXPECT_GT(pg_stats.used_bytes, 0) << "Used bytes should be greater than 0";
+    uint64_t const used_bytes_after = pg_stats.used_bytes;
+
+    // more puts and deletes after the refresh, the counters persisted by the cp must not be counted again by the
+    // replay after restart
+    const uint32_t num_more_blobs = 5;
+    const uint32_t num_more_tombstones = 2;
+    put_blobs(pg_shard_id_vec, num_more_blobs, pg_blob_id);
+    for (uint32_t i = num_tombstones; i < num_tombstones + num_more_tombstones; ++i) {
+        del_blob(pg_id, shard_id, i);
+    }
+    res = _obj_inst->pg_manager()->get_stats(pg_id, pg_stats);
+    ASSERT_TRUE(res);
+    EXPECT_EQ(pg_stats.num_active_objects,
+              num_active_blobs + num_more_blobs - num_tombstones - num_more_tombstones);
+    EXPECT_EQ(pg_stats.num_tombstone_objects, num_tombstones + num_more_tombstones);
+    EXPECT_GT(pg_stats.used_bytes, used_bytes_after);
+    uint64_t const used_bytes_before_restart = pg_stats.used_bytes;
+
+    // the counters include every committed log, and the cp persists them along with that lsn
+    wait_for_counters_lsn(hs_pg);
+    trigger_cp(true);
+    auto const persisted_lsn = hs_pg->counters_lsn_.load();
+    EXPECT_EQ(persisted_lsn, hs_pg->repl_dev_->get_last_commit_lsn());
+    EXPECT_EQ(hs_pg->pg_sb_->get_counters_lsn_tail()->lsn, persisted_lsn);
+
+    // Statistics are recovered from the pg superblk and the log replay, without a refresh
+    LOGINFO("Testing statistics recovery after restart");
+    restart();
+
+    // Get PG after restart
+    ASSERT_TRUE(_obj_inst->_pg_map.find(pg_id) != _obj_inst->_pg_map.end());
+    hs_pg = dynamic_cast< HSHomeObject::HS_PG* >(_obj_inst->_pg_map[pg_id].get());
+    ASSERT_NE(hs_pg, nullptr);
+    EXPECT_FALSE(hs_pg->counters_need_refresh_);
+    EXPECT_EQ(hs_pg->recovered_counters_lsn_, persisted_lsn);
+    EXPECT_GE(hs_pg->counters_lsn_.load(), persisted_lsn);
 
-    uint64_t used_bytes_after = pg_stats.used_bytes;
+    // Statistics should be preserved after restart
+    PGStats pg_stats_restart;
+    res = _obj_inst->pg_manager()->get_stats(pg_id, pg_stats_restart);
+    ASSERT_TRUE(res);
+    LOGINFO("Statistics after restart: stats={}", pg_stats_restart.to_string());
+
+    EXPECT_EQ(pg_stats_restart.num_active_objects,
+              num_active_blobs + num_more_blobs - num_tombstones - num_more_tombstones)
+        << "Active blob count should be preserved after restart";
+    EXPECT_EQ(pg_stats_restart.num_tombstone_objects, num_tombstones + num_more_tombstones)
+        << "Tombstone blob count should be preserved after restart";
+    EXPECT_EQ(pg_stats_restart.used_bytes, used_bytes_before_restart) << "Used bytes should be preserved after restart";
 
-    // corrupt stats again to verify refresh after restart
+    // corrupt stats again and drop the counters lsn from the superblk, as written by an older version. The restart
+    // cannot trust the persisted counters then and recounts them after the replay.
     hs_pg->durable_entities_update([](auto& de) {
         de.active_blob_count.store(999, std::memory_order_relaxed);
         de.tombstone_blob_count.store(888, std::memory_order_relaxed);
         de.total_occupied_blk_count.store(777, std::memory_order_relaxed);
     });
-    LOGINFO("Corrupted statistics: active=999, tombstone=888, occupied=777");
+    {
+        std::scoped_lock lg(hs_pg->mtx_);
+        hs_pg->pg_sb_->get_counters_lsn_tail_mutable()->magic = 0;
+    }
+    LOGINFO("Corrupted statistics: active=999, tombstone=888, occupied=777, superblk without counters lsn");
 
-    // Test refresh_pg_statistics after restart (log replay scenario)
     LOGINFO("Testing statistics refresh after restart");
     restart();
 
-    // Get PG after restart
     ASSERT_TRUE(_obj_inst->_pg_map.find(pg_id) != _obj_inst->_pg_map.end());
     hs_pg = dynamic_cast< HSHomeObject::HS_PG* >(_obj_inst->_pg_map[pg_id].get());
     ASSERT_NE(hs_pg, nullptr);
+    EXPECT_FALSE(hs_pg->counters_need_refresh_);
+    EXPECT_EQ(hs_pg->recovered_counters_lsn_, -1);
+    EXPECT_EQ(hs_pg->pg_sb_->get_counters_lsn_tail()->magic,
+              HSHomeObject::pg_info_superblk::counters_lsn_tail::tail_magic);
 
-    // Statistics should be preserved after restart
-    PGStats pg_stats_restart;
     res = _obj_inst->pg_manager()->get_stats(pg_id, pg_stats_restart);
     ASSERT_TRUE(res);
-    LOGINFO("Statistics after restart: stats={}", pg_stats_restart.to_string());
+    LOGINFO("Statistics after refresh on restart: stats={}", pg_stats_restart.to_string());
+    EXPECT_EQ(pg_stats_restart.num_active_objects,
+              num_active_blobs + num_more_blobs - num_tombstones - num_more_tombstones)
+        << "Active blob count should be recounted after restart";
+    EXPECT_EQ(pg_stats_restart.num_tombstone_objects, num_tombstones + num_more_tombstones)
+        << "Tombstone blob count should be recounted after restart";
+    EXPECT_EQ(pg_stats_restart.used_bytes, used_bytes_before_restart) << "Used bytes should be recounted after restart";
+}
 
-    EXPECT_EQ(pg_stats_restart.num_active_objects, num_active_blobs - num_tombstones)
-        << "Active blob count should be preserved after restart";
-    EXPECT_EQ(pg_stats_restart.num_tombstone_objects, num_tombstones)
-        << "Tombstone blob count should be preserved after restart";
-    EXPECT_EQ(pg_stats_restart.used_bytes, used_bytes_after) << "Used bytes should be preserved after restart";
-}
\ No newline at end of file
+#ifdef _PRERELEASE
+TEST_F(HomeObjectFixture, PGStatisticsReplayTest) {
+    g_helper->sync();
+
+    pg_id_t pg_id{1};
+    create_pg(pg_id);
+    auto shard_id = create_shard(pg_id, 64 * Mi, "shard meta").id;
+    std::map< pg_id_t, blob_id_t > pg_blob_id{{pg_id, 0}};
+    std::map< pg_id_t, std::vector< shard_id_t > > pg_shard_id_vec{{pg_id, {shard_id}}};
+
+    const uint32_t num_blobs = 10;
+    const uint32_t num_tombstones = 3;
+    put_blobs(pg_shard_id_vec, num_blobs, pg_blob_id);
+    for (blob_id_t i = 0; i < num_tombstones; ++i) {
+        del_blob(pg_id, shard_id, i);
+    }
+
+    ASSERT_TRUE(_obj_inst->_pg_map.find(pg_id) != _obj_inst->_pg_map.end());
+    auto hs_pg = dynamic_cast< HSHomeObject::HS_PG* >(_obj_inst->_pg_map[pg_id].get());
+    ASSERT_NE(hs_pg, nullptr);
+    wait_for_counters_lsn(hs_pg);
+    trigger_cp(true);
+    auto const persisted_lsn = hs_pg->counters_lsn_.load();
+    ASSERT_EQ(persisted_lsn, hs_pg->repl_dev_->get_last_commit_lsn());
+
+    // The counters of the following puts and deletes stay out of the superblk, as if the node crashed before the cp
+    // which would persist them. The replay has to count them exactly once, on top of the counters up to persisted_lsn.
+    set_basic_flip("pg_skip_counters_cp_flush", std::numeric_limits< int >::max());
+    const uint32_t num_more_blobs = 5;
+    put_blobs(pg_shard_id_vec, num_more_blobs, pg_blob_id);
+    // tombstones of a blob counted before persisted_lsn and of one put after it
+    del_blob(pg_id, shard_id, num_tombstones);
+    del_blob(pg_id, shard_id, num_blobs);
+    const uint32_t num_more_tombstones = 2;
+
+    PGStats pg_stats;
+    ASSERT_TRUE(_obj_inst->pg_manager()->get_stats(pg_id, pg_stats));
+    EXPECT_EQ(pg_stats.num_active_objects, num_blobs + num_more_blobs - num_tombstones - num_more_tombstones);
+    EXPECT_EQ(pg_stats.num_tombstone_objects, num_tombstones + num_more_tombstones);
+    uint64_t const used_bytes_before_restart = pg_stats.used_bytes;
+    wait_for_counters_lsn(hs_pg);
+    EXPECT_GT(hs_pg->counters_lsn_.load(), persisted_lsn);
+
+    restart();
+    remove_flip("pg_skip_counters_cp_flush");
+
+    ASSERT_TRUE(_obj_inst->_pg_map.find(pg_id) != _obj_inst->_pg_map.end());
+    hs_pg = dynamic_cast< HSHomeObject::HS_PG* >(_obj_inst->_pg_map[pg_id].get());
+    ASSERT_NE(hs_pg, nullptr);
+    EXPECT_FALSE(hs_pg->counters_need_refresh_);
+    EXPECT_EQ(hs_pg->recovered_counters_lsn_, persisted_lsn);
+    EXPECT_GT(hs_pg->counters_lsn_.load(), persisted_lsn);
+
+    PGStats pg_stats_restart;
+    ASSERT_TRUE(_obj_inst->pg_manager()->get_stats(pg_id, pg_stats_restart));
+    LOGINFO("Statistics after replay: stats={}", pg_stats_restart.to_string());
+    EXPECT_EQ(pg_stats_restart.num_active_objects, pg_stats.num_active_objects)
+        << "Replayed puts and deletes should be counted exactly once";
+    EXPECT_EQ(pg_stats_restart.num_tombstone_objects, pg_stats.num_tombstone_objects)
+        << "Replayed deletes should be counted exactly once";
+    EXPECT_EQ(pg_stats_restart.used_bytes, used_bytes_before_restart)
+        << "Replayed puts should be counted exactly once";
+}
+#endif
\ No newline at end of file
@@ -61,6 +61,70 @@ TEST_F(HomeObjectFixture, CreateMultiShardsOnMultiPG) {
     }
 }
 
+TEST_F(HomeObjectFixture, CreateShardsOnManyPGsConcurrently) {
+    // every pg creates and seals its shards on its own thread while cp flushes and stats collection run on all the pgs
+    uint64_t const num_pgs = 8;
+    uint64_t const num_shards_per_pg = 2 * SISL_OPTIONS["chunks_per_pg"].as< uint64_t >();
+    for (pg_id_t pg{1}; pg <= num_pgs; pg++) {
+        create_pg(pg);
+    }
+    g_helper->sync();
+
+    std::atomic< bool > done{false};
+    auto reader = std::thread([this, &done]() {
+        while (!done.load()) {
+            _obj_inst->get_stats();
+            for (pg_id_t pg{1}; pg <= num_pgs; pg++) {
+                PGStats stats;
+                _obj_inst->pg_manager()->get_stats(pg, stats);
+            }
+            trigger_cp(true /* wait */);
+        }
+    });
+
+    std::vector< std::thread > writers;
+    for (pg_id_t pg{1}; pg <= num_pgs; pg++) {
+        writers.emplace_back([this, pg, num_shards_per_pg]() {
+            run_on_pg_leader(pg, [&]() {
+                for (uint64_t i = 0; i < num_shards_per_pg; i++) {
+                    auto s = _obj_inst->shard_manager()->create_shard(pg, Mi, "shard meta").get();
+                    ASSERT_TRUE(!!s);
+                    // the chunk of a sealed shard is released, so a pg can create more shards than it has chunks
+                    ASSERT_TRUE(!!_obj_inst->shard_manager()->seal_shard(s.value().id).get());
+                }
+            });
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done = true;
+    reader.join();
+
+    std::set< shard_id_t > shard_ids;
+    for (pg_id_t pg{1}; pg <= num_pgs; pg++) {
+        // followers wait for the shards to be replicated
+        auto is_sealed = [](auto const& info) { return info.state == ShardInfo::State::SEALED; };
+        while (true) {
+            auto e = _obj_inst->shard_manager()->list_shards(pg).get();
+            ASSERT_TRUE(!!e);
+            if (e.value().size() == num_shards_per_pg && std::ranges::all_of(e.value(), is_sealed)) {
+                for (auto const& info : e.value()) {
+                    EXPECT_EQ(info.placement_group, pg);
+                    EXPECT_TRUE(shard_ids.insert(info.id).second);
+                }
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        PGStats stats;
+        ASSERT_TRUE(_obj_inst->pg_manager()->get_stats(pg, stats));
+        EXPECT_EQ(stats.total_shards, num_shards_per_pg);
+        EXPECT_EQ(stats.open_shards, 0u);
+    }
+    g_helper->sync();
+}
+
 TEST_F(HomeObjectFixture, SealShard) {
     pg_id_t pg_id{1};
     create_pg(pg_id);
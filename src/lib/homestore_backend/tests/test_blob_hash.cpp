@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <sisl/options/options.h>
+#include <sisl/logging/logging.h>
+#include <folly/init/Init.h>
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <homestore/crc.h>
+#include <xxhash.h>
+
+#include "homeobject/common.hpp"
+#include "lib/homestore_backend/crc32c.hpp"
+
+SISL_LOGGING_DEF(HOMEOBJECT_LOG_MODS)
+SISL_LOGGING_INIT(HOMEOBJECT_LOG_MODS)
+SISL_OPTIONS_ENABLE(logging)
+
+using homeobject::crc32c;
+using homeobject::crc32c_sw;
+
+static std::vector< uint8_t > random_bytes(size_t size) {
+    std::vector< uint8_t > bytes(size);
+    std::mt19937_64 gen(size);
+    std::uniform_int_distribution< uint32_t > dist(0, 255);
+    for (auto& b : bytes) {
+        b = static_cast< uint8_t >(dist(gen));
+    }
+    return bytes;
+}
+
+TEST(Crc32c, KnownValues) {
+    std::string const check{"123456789"};
+    auto const* check_bytes = reinterpret_cast< uint8_t const* >(check.data());
+    EXPECT_EQ(crc32c(0, check_bytes, check.size()), 0xe3069283u);
+    EXPECT_EQ(crc32c_sw(0, check_bytes, check.size()), 0xe3069283u);
+    EXPECT_EQ(crc32c(0, nullptr, 0), 0u);
+
+    // iSCSI test vector (RFC 3720 B.4): 32 bytes of zeroes
+    std::vector< uint8_t > const zeroes(32, 0);
+    EXPECT_EQ(crc32c(0, zeroes.data(), zeroes.size()), 0x8a9136aau);
+}
+
+TEST(Crc32c, MatchesPortableImplementation) {
+    LOGINFO("crc32c instruction available: {}", homeobject::crc32c_hw_available());
+    auto const bytes = random_bytes(1024 * 1024 + 77);
+    // every alignment of the start, lengths around the interleaved stripes of the hardware implementation
+    for (size_t offset : {0, 1, 3, 7, 8}) {
+        for (size_t len : {0ul, 1ul, 7ul, 8ul, 4095ul, 12288ul, 12289ul, 3 * 12288ul + 5, 1024 * 1024ul}) {
+            auto const* buf = bytes.data() + offset;
+            auto const crc = crc32c(0, buf, len);
+            EXPECT_EQ(crc, crc32c_sw(0, buf, len)) << "offset=" << offset << " len=" << len;
+            auto const split = len / 3;
+            EXPECT_EQ(crc, crc32c(crc32c(0, buf, split), buf + split, len - split))
+                << "offset=" << offset << " len=" << len;
+        }
+    }
+}
+
+TEST(Xxh3, StreamingMatchesOneShot) {
+    auto const bytes = random_bytes(256 * 1024 + 3);
+    XXH3_state_t* state = XXH3_createState();
+    ASSERT_NE(state, nullptr);
+    ASSERT_EQ(XXH3_64bits_reset(state), XXH_OK);
+    size_t const step = 4099;
+    for (size_t pos = 0; pos < bytes.size(); pos += step) {
+        ASSERT_EQ(XXH3_64bits_update(state, bytes.data() + pos, std::min(step, bytes.size() - pos)), XXH_OK);
+    }
+    EXPECT_EQ(XXH3_64bits_digest(state), XXH3_64bits(bytes.data(), bytes.size()));
+    XXH3_freeState(state);
+}
+
+// Throughput of the payload hash algorithms of BlobHeader::HashAlgorithm, disabled by default.
+TEST(BlobHash, DISABLED_Throughput) {
+    using clock = std::chrono::steady_clock;
+    struct algorithm {
+        char const* name;
+        std::function< uint64_t(uint8_t const*, size_t) > hash;
+    };
+    std::vector< algorithm > const algorithms{
+        {"crc32_ieee", [](uint8_t const* buf, size_t len) -> uint64_t { return crc32_ieee(0, buf, len); }},
+        {"crc32c", [](uint8_t const* buf, size_t len) -> uint64_t { return crc32c(0, buf, len); }},
+        {"crc32c_sw", [](uint8_t const* buf, size_t len) -> uint64_t { return crc32c_sw(0, buf, len); }},
+        {"xxh3_64", [](uint8_t const* buf, size_t len) -> uint64_t { return XXH3_64bits(buf, len); }}};
+
+    size_t const bytes_per_run = 256ul * 1024 * 1024;
+    auto const bytes = random_bytes(8 * 1024 * 1024);
+    for (size_t size = 4 * 1024; size <= bytes.size(); size *= 2) {
+        for (auto const& alg : algorithms) {
+            uint64_t sink{0};
+            auto const iterations = std::max< size_t >(bytes_per_run / size, 1);
+            auto const start = clock::now();
+            for (size_t i = 0; i < iterations; ++i) {
+                sink += alg.hash(bytes.data(), size);
+            }
+            auto const secs = std::chrono::duration< double >(clock::now() - start).count();
+            LOGINFO("{:>10} size={:>8} {:>8.2f} GB/s (sink={})", alg.name, size,
+                    double(iterations * size) / secs / 1e9, sink);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int parsed_argc = argc;
+    ::testing::InitGoogleTest(&parsed_argc, argv);
+    SISL_OPTIONS_LOAD(parsed_argc, argv, logging);
+    sisl::logging::SetLogger(std::string(argv[0]));
+    spdlog::set_pattern("[%D %T.%e] [%n] [%^%l%$] [%t] %v");
+    parsed_argc = 1;
+    auto f = ::folly::Init(&parsed_argc, &argv, true);
+    return RUN_ALL_TESTS();
+}
@@ -4,7 +4,10 @@
 #include <sisl/logging/logging.h>
 #include <folly/init/Init.h>
 
+#include <algorithm>
 #include <memory>
+#include <string>
+#include <thread>
 
 #include "homeobject/common.hpp"
 #define protected public
@@ -289,6 +292,42 @@ TEST_F(HeapChunkSelectorTest, test_select_specific_chunk_and_release_chunk) {
     }
 }
 
+TEST_F(HeapChunkSelectorTest, test_select_specific_chunk_waits_for_gc) {
+    const pg_id_t pg_id = 1;
+    const chunk_num_t v_chunk_id = 0;
+    const chunk_num_t p_chunk_id = HCS.get_pg_chunks(pg_id)->at(v_chunk_id);
+    ASSERT_TRUE(HCS.try_mark_chunk_to_gc_state(p_chunk_id));
+
+    // both the blocking and the async selection wait for the gc task
+    std::atomic_bool selected{false};
+    std::thread t([this, &selected] {
+        ASSERT_NE(nullptr, HCS.select_specific_chunk(pg_id, v_chunk_id));
+        selected = true;
+    });
+    auto fut = HCS.select_specific_chunk_async(pg_id, v_chunk_id);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(selected);
+    ASSERT_EQ(HCS.m_gc_waiters.size(), 1);
+
+    // the waiters are woken up as soon as the chunk leaves gc state, not on a polling interval
+    HCS.mark_chunk_out_of_gc_state(p_chunk_id, ChunkState::AVAILABLE, 0);
+    auto chunk = std::move(fut).get(std::chrono::seconds(5));
+    ASSERT_NE(nullptr, chunk);
+    ASSERT_EQ(p_chunk_id, chunk->get_chunk_id());
+    t.join();
+    ASSERT_TRUE(selected);
+    ASSERT_EQ(HCS.m_chunks[p_chunk_id]->m_state, ChunkState::INUSE);
+    ASSERT_TRUE(HCS.m_gc_waiters.empty());
+
+    // a selection waiting on a pg which is destroyed meanwhile finds no chunk
+    ASSERT_TRUE(HCS.release_chunk(pg_id, v_chunk_id));
+    ASSERT_TRUE(HCS.try_mark_chunk_to_gc_state(p_chunk_id));
+    fut = HCS.select_specific_chunk_async(pg_id, v_chunk_id);
+    ASSERT_TRUE(HCS.return_pg_chunks_to_dev_heap(pg_id));
+    ASSERT_TRUE(HCS.m_gc_waiters.empty());
+    ASSERT_EQ(nullptr, std::move(fut).get(std::chrono::seconds(5)));
+}
+
 TEST_F(HeapChunkSelectorTest, test_return_pg_chunks) {
     for (uint16_t pg_id = 1; pg_id < 4; ++pg_id) {
         ASSERT_TRUE(HCS.return_pg_chunks_to_dev_heap(pg_id));
@@ -319,18 +358,15 @@ TEST_F(HeapChunkSelectorTest, test_recovery) {
         std::vector< chunk_num_t > empty_chunk_ids{};
         std::vector< chunk_num_t > chunk_ids_for_twice{1, 2};
         std::vector< chunk_num_t > chunk_ids_not_valid{1, 20};
-        std::vector< chunk_num_t > chunk_ids_not_same_pdev{1, 6};
         for (chunk_num_t j = 0; j < 2; ++j) {
             chunk_ids[j] += (pg_id - 1) * 3;
             chunk_ids_for_twice[j] += (pg_id - 1) * 3;
             chunk_ids_not_valid[j] += (pg_id - 1) * 3;
-            chunk_ids_not_same_pdev[j] += ((pg_id - 1) * 3) % 9;
         }
 
         // test recover chunk map
         ASSERT_FALSE(HCS_recovery.recover_pg_chunks(pg_id, std::move(empty_chunk_ids)));
         ASSERT_FALSE(HCS_recovery.recover_pg_chunks(pg_id, std::move(chunk_ids_not_valid)));
-        ASSERT_FALSE(HCS_recovery.recover_pg_chunks(pg_id, std::move(chunk_ids_not_same_pdev)));
 
         ASSERT_TRUE(HCS_recovery.recover_pg_chunks(pg_id, std::move(chunk_ids)));
         // can't set pg chunks twice
@@ -388,6 +424,193 @@ TEST_F(HeapChunkSelectorTest, test_recovery) {
     }
 }
 
+TEST(IndexedHeapTest, test_update_and_erase) {
+    homeobject::IndexedHeap< uint16_t, uint32_t, std::string > heap;
+    for (uint16_t id = 0; id < 20; ++id) {
+        heap.push(id, id % 10, std::to_string(id));
+    }
+    ASSERT_EQ(heap.size(), 20);
+    // the same key goes to the smaller id first
+    ASSERT_EQ(heap.top_id(), 9);
+    ASSERT_EQ(heap.top(), "9");
+
+    // decrease and increase key
+    ASSERT_TRUE(heap.update(9, 0));
+    ASSERT_EQ(heap.top_id(), 19);
+    ASSERT_TRUE(heap.update(3, 100));
+    ASSERT_EQ(heap.top_id(), 3);
+    ASSERT_FALSE(heap.update(20, 1));
+    // push of an existing id updates it
+    heap.push(3, 1, "three");
+    ASSERT_EQ(heap.size(), 20);
+    ASSERT_TRUE(heap.contains(3));
+    ASSERT_EQ(*heap.find(3), "three");
+    ASSERT_EQ(heap.find(20), nullptr);
+
+    ASSERT_TRUE(heap.erase(19));
+    ASSERT_TRUE(heap.erase(8));
+    ASSERT_FALSE(heap.erase(8));
+    ASSERT_FALSE(heap.contains(8));
+
+    std::vector< uint16_t > order;
+    std::vector< uint32_t > keys;
+    while (!heap.empty()) {
+        order.emplace_back(heap.top_id());
+        keys.emplace_back(heap.top_key());
+        heap.pop();
+    }
+    ASSERT_EQ(order.size(), 18);
+    ASSERT_TRUE(std::is_sorted(keys.rbegin(), keys.rend()));
+    ASSERT_EQ(order.front(), 18);
+    ASSERT_EQ(order.back(), 10);
+    ASSERT_EQ(std::count(order.begin(), order.end(), 3), 1);
+}
+
+TEST_F(HeapChunkSelectorTest, test_available_chunks_updated) {
+    const pg_id_t pg_id = 1;
+    auto pg_chunk_collection = HCS.m_per_pg_chunks[pg_id];
+    auto& pg_chunks = pg_chunk_collection->m_pg_chunks;
+    auto const pdev_id = pg_chunks[0]->get_pdev_id();
+    // the chunks of pg 1 have 3, 2 and 1 available blks
+    ASSERT_EQ(HCS.get_most_available_blk_chunk(9999, pg_id).value(), 0);
+    ASSERT_EQ(pg_chunk_collection->m_available_chunks[pdev_id].size(), 2);
+
+    // the shard on v_chunk 0 used up the chunk, it goes after the others when released
+    pg_chunks[0]->get_internal_chunk()->set_available_blks(0);
+    ASSERT_TRUE(HCS.release_chunk(pg_id, 0));
+    ASSERT_EQ(pg_chunk_collection->m_available_chunks[pdev_id].size(), 3);
+    ASSERT_EQ(HCS.get_most_available_blk_chunk(9999, pg_id).value(), 1);
+    ASSERT_EQ(HCS.get_most_available_blk_chunk(9999, pg_id).value(), 2);
+    ASSERT_EQ(HCS.get_most_available_blk_chunk(9999, pg_id).value(), 0);
+    ASSERT_FALSE(HCS.get_most_available_blk_chunk(9999, pg_id).has_value());
+    ASSERT_TRUE(HCS.release_chunk(pg_id, 1));
+    ASSERT_TRUE(HCS.release_chunk(pg_id, 2));
+
+    // a gc-ed chunk is out of the available chunks during gc and comes back with its new available blks
+    auto const p_chunk_id = pg_chunks[0]->get_chunk_id();
+    ASSERT_TRUE(HCS.try_mark_chunk_to_gc_state(p_chunk_id, true /* force */));
+    ASSERT_FALSE(pg_chunk_collection->m_available_chunks[pdev_id].contains(0));
+    pg_chunks[0]->get_internal_chunk()->set_available_blks(3);
+    HCS.mark_chunk_out_of_gc_state(p_chunk_id, ChunkState::AVAILABLE, 0);
+    ASSERT_EQ(pg_chunk_collection->m_available_chunks[pdev_id].top_id(), 0);
+    ASSERT_EQ(pg_chunk_collection->m_available_chunks[pdev_id].top_key(), 3);
+    ASSERT_EQ(HCS.get_most_available_blk_chunk(9999, pg_id).value(), 0);
+}
+
+TEST_F(HeapChunkSelectorTest, test_concurrent_pgs) {
+    // shards of two pgs are created and sealed while the chunks of the third pg are gc-ed
+    std::vector< std::thread > threads;
+    for (pg_id_t pg_id = 1; pg_id < 3; ++pg_id) {
+        threads.emplace_back([this, pg_id] {
+            for (uint64_t i = 0; i < 1000; ++i) {
+                auto const v_chunk_id = HCS.get_most_available_blk_chunk(i, pg_id);
+                ASSERT_TRUE(v_chunk_id.has_value());
+                ASSERT_NE(HCS.select_specific_chunk(pg_id, v_chunk_id.value()), nullptr);
+                ASSERT_TRUE(HCS.release_chunk(pg_id, v_chunk_id.value()));
+            }
+        });
+    }
+    threads.emplace_back([this] {
+        for (uint64_t i = 0; i < 1000; ++i) {
+            auto const p_chunk_id = HCS.get_pg_vchunk(3, i % 3)->get_chunk_id();
+            ASSERT_TRUE(HCS.try_mark_chunk_to_gc_state(p_chunk_id));
+            HCS.mark_chunk_out_of_gc_state(p_chunk_id, ChunkState::AVAILABLE, i);
+        }
+    });
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (pg_id_t pg_id = 1; pg_id < 4; ++pg_id) {
+        ASSERT_EQ(HCS.m_per_pg_chunks[pg_id]->available_num_chunks, 3);
+    }
+    for (auto const& [_, pdev_heap] : HCS.m_per_dev_heap) {
+        ASSERT_EQ(pdev_heap->num_open_chunks, 0);
+    }
+}
+
+#ifndef NDEBUG
+TEST_F(HeapChunkSelectorTest, test_lock_order_checked) {
+    auto pg_chunk_collection = HCS.m_per_pg_chunks[1];
+    // taking the selector lock while holding the lock of a pg asserts in debug builds
+    ASSERT_DEATH(
+        {
+            HeapChunkSelector::mutex_lock lock(pg_chunk_collection->mtx, HeapChunkSelector::LockLevel::pg);
+            HCS.get_most_available_blk_chunk(0, 1);
+        },
+        "");
+}
+#endif
+
+TEST_F(HeapChunkSelectorTest, test_stripe_pg_chunks) {
+    HeapChunkSelector HCS_stripe;
+    for (chunk_num_t p_chunk_id = 1; p_chunk_id < 10; ++p_chunk_id) {
+        HCS_stripe.add_chunk(std::make_shared< Chunk >((p_chunk_id - 1) / 3 + 1, p_chunk_id, 3, 0));
+    }
+    HCS_stripe.build_pdev_available_chunk_heap();
+    const uint64_t chunk_size = HCS_stripe.get_chunk_size();
+    auto const pg_pdevs = [&HCS_stripe](pg_id_t pg_id) {
+        std::vector< uint32_t > pdevs;
+        for (auto const& chunk : HCS_stripe.m_per_pg_chunks[pg_id]->m_pg_chunks) {
+            pdevs.emplace_back(chunk->get_pdev_id());
+        }
+        return pdevs;
+    };
+
+    // pdevs with as many free chunks take turns, the lowest pdev id first
+    ASSERT_EQ(HCS_stripe.select_chunks_for_pg(1, chunk_size * 3, true).value(), 3);
+    ASSERT_EQ(pg_pdevs(1), (std::vector< uint32_t >{1, 2, 3}));
+    ASSERT_EQ(HCS_stripe.select_chunks_for_pg(2, chunk_size * 4, true).value(), 4);
+    ASSERT_EQ(pg_pdevs(2), (std::vector< uint32_t >{1, 2, 3, 1}));
+    ASSERT_EQ(HCS_stripe.m_per_dev_heap[1]->size(), 0);
+    ASSERT_EQ(HCS_stripe.m_per_dev_heap[2]->size(), 1);
+    ASSERT_EQ(HCS_stripe.m_per_dev_heap[3]->size(), 1);
+    // no pdev has 2 free chunks, but they do in total
+    ASSERT_FALSE(HCS_stripe.select_chunks_for_pg(3, chunk_size * 3, true).has_value());
+    ASSERT_FALSE(HCS_stripe.select_chunks_for_pg(3, chunk_size * 2).has_value());
+    ASSERT_EQ(HCS_stripe.select_chunks_for_pg(3, chunk_size * 2, true).value(), 2);
+    ASSERT_EQ(pg_pdevs(3), (std::vector< uint32_t >{2, 3}));
+
+    // new shards go to the pdev with the fewest open chunks
+    ASSERT_EQ(HCS_stripe.get_most_available_blk_chunk(9999, 1).value(), 0);
+    ASSERT_EQ(HCS_stripe.get_most_available_blk_chunk(9999, 1).value(), 1);
+    ASSERT_EQ(HCS_stripe.m_per_dev_heap[1]->num_open_chunks, 1);
+    ASSERT_EQ(HCS_stripe.m_per_dev_heap[2]->num_open_chunks, 1);
+    ASSERT_EQ(HCS_stripe.m_per_dev_heap[3]->num_open_chunks, 0);
+    ASSERT_EQ(HCS_stripe.get_most_available_blk_chunk(9999, 2).value(), 2);
+    ASSERT_EQ(HCS_stripe.m_per_dev_heap[3]->num_open_chunks, 1);
+    ASSERT_TRUE(HCS_stripe.release_chunk(1, 0));
+    ASSERT_EQ(HCS_stripe.m_per_dev_heap[1]->num_open_chunks, 0);
+    ASSERT_EQ(HCS_stripe.get_most_available_blk_chunk(9999, 2).value(), 0);
+
+    // the chunks go back to their own pdevs
+    ASSERT_TRUE(HCS_stripe.return_pg_chunks_to_dev_heap(1));
+    ASSERT_EQ(HCS_stripe.m_per_dev_heap[1]->size(), 1);
+    ASSERT_EQ(HCS_stripe.m_per_dev_heap[2]->size(), 1);
+    ASSERT_EQ(HCS_stripe.m_per_dev_heap[3]->size(), 1);
+    ASSERT_EQ(HCS_stripe.m_per_dev_heap[2]->num_open_chunks, 0);
+    for (uint32_t pdev_id = 1; pdev_id < 4; ++pdev_id) {
+        auto chunk = HCS_stripe.m_per_dev_heap[pdev_id]->m_heap.top();
+        ASSERT_EQ(chunk->get_pdev_id(), pdev_id);
+        ASSERT_FALSE(chunk->m_pg_id.has_value());
+    }
+
+    // a striped pg is recovered, and its open chunks are counted once the heaps are built
+    HeapChunkSelector HCS_recovery;
+    for (chunk_num_t p_chunk_id = 1; p_chunk_id < 10; ++p_chunk_id) {
+        HCS_recovery.add_chunk(std::make_shared< Chunk >((p_chunk_id - 1) / 3 + 1, p_chunk_id, 3, 0));
+    }
+    ASSERT_TRUE(HCS_recovery.recover_pg_chunks(1, std::vector< chunk_num_t >{1, 4, 7}));
+    ASSERT_TRUE(HCS_recovery.recover_pg_chunks_states(1, std::unordered_set< chunk_num_t >{0, 2}));
+    HCS_recovery.build_pdev_available_chunk_heap();
+    for (uint32_t pdev_id = 1; pdev_id < 4; ++pdev_id) {
+        ASSERT_EQ(HCS_recovery.m_per_dev_heap[pdev_id]->size(), 2);
+        ASSERT_EQ(HCS_recovery.m_per_dev_heap[pdev_id]->num_open_chunks, pdev_id == 2 ? 0 : 1);
+    }
+    ASSERT_EQ(HCS_recovery.get_most_available_blk_chunk(9999, 1).value(), 1);
+    ASSERT_EQ(HCS_recovery.m_per_dev_heap[2]->num_open_chunks, 1);
+}
+
 int main(int argc, char* argv[]) {
     int parsed_argc = argc;
     ::testing::InitGoogleTest(&parsed_argc, argv);
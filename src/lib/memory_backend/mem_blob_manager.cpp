@@ -31,12 +31,41 @@ BlobManager::AsyncResult< blob_id_t > MemoryHomeObject::_put_blob(ShardInfo cons
     }
     WITH_ROUTE(new_blob_id);
 
+    _blob.gather_body();
     auto [_, happened] =
         shard.btree_.try_emplace(route, BlobExt{.state_ = BlobState::ALIVE, .blob_ = new Blob(std::move(_blob))});
     RELEASE_ASSERT(happened, "Generated duplicate BlobRoute!");
     return route.blob;
 }
 
+// Same as _put_blob, but the blob ids of the batch are allocated at once
+BlobManager::AsyncResult< std::vector< blob_id_t > >
+MemoryHomeObject::_put_blob_batch(ShardInfo const& _shard, std::vector< Blob >&& _blobs, trace_id_t tid) {
+    (void)tid;
+    WITH_SHARD
+    blob_id_t first_blob_id;
+    {
+        auto lg = std::shared_lock(_pg_lock);
+        auto iter = _pg_map.find(_shard.placement_group);
+        RELEASE_ASSERT(iter != _pg_map.end(), "PG not found");
+        iter->second->durable_entities_update([&first_blob_id, count = _blobs.size()](auto& de) {
+            first_blob_id = de.blob_sequence_num.fetch_add(count, std::memory_order_relaxed);
+        });
+    }
+
+    std::vector< blob_id_t > blob_ids;
+    blob_ids.reserve(_blobs.size());
+    for (auto& _blob : _blobs) {
+        WITH_ROUTE(first_blob_id + blob_ids.size());
+        _blob.gather_body();
+        auto [_, happened] =
+            shard.btree_.try_emplace(route, BlobExt{.state_ = BlobState::ALIVE, .blob_ = new Blob(std::move(_blob))});
+        RELEASE_ASSERT(happened, "Generated duplicate BlobRoute!");
+        blob_ids.push_back(route.blob);
+    }
+    return blob_ids;
+}
+
 // Lookup BlobExt and duplicate underyling Blob for user; only *safe* because we defer GC.
 BlobManager::AsyncResult< Blob > MemoryHomeObject::_get_blob(ShardInfo const& _shard, blob_id_t _blob, uint64_t off,
                                                              uint64_t len, bool allow_skip_verify, trace_id_t tid) const {
@@ -50,6 +79,24 @@ BlobManager::AsyncResult< Blob > MemoryHomeObject::_get_blob(ShardInfo const& _s
     return folly::makeUnexpected(BlobError(BlobErrorCode::UNKNOWN_BLOB));
 }
 
+BlobManager::AsyncResult< std::vector< BlobManager::Result< Blob > > >
+MemoryHomeObject::_get_blob_batch(ShardInfo const& _shard, std::vector< blob_id_t > const& _blobs,
+                                  trace_id_t tid) const {
+    (void)tid;
+    WITH_SHARD
+    std::vector< BlobManager::Result< Blob > > results;
+    results.reserve(_blobs.size());
+    for (auto const _blob : _blobs) {
+        WITH_ROUTE(_blob)
+        IF_BLOB_ALIVE {
+            results.emplace_back(blob_it->second.blob_->clone());
+            continue;
+        }
+        results.emplace_back(folly::makeUnexpected(BlobError(BlobErrorCode::UNKNOWN_BLOB)));
+    }
+    return results;
+}
+
 // Tombstone BlobExt entry
 BlobManager::NullAsyncResult MemoryHomeObject::_del_blob(ShardInfo const& _shard, blob_id_t _blob, trace_id_t tid) {
     (void)tid;
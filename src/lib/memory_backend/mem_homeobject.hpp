@@ -42,8 +42,12 @@ class MemoryHomeObject : public HomeObjectImpl {
 
     // BlobManager
     BlobManager::AsyncResult< blob_id_t > _put_blob(ShardInfo const&, Blob&&, trace_id_t tid) override;
+    BlobManager::AsyncResult< std::vector< blob_id_t > > _put_blob_batch(ShardInfo const&, std::vector< Blob >&&,
+                                                                         trace_id_t tid) override;
     BlobManager::AsyncResult< Blob > _get_blob(ShardInfo const&, blob_id_t, uint64_t off, uint64_t len,
                                                bool allow_skip_verify, trace_id_t tid) const override;
+    BlobManager::AsyncResult< std::vector< BlobManager::Result< Blob > > >
+    _get_blob_batch(ShardInfo const&, std::vector< blob_id_t > const&, trace_id_t tid) const override;
     BlobManager::NullAsyncResult _del_blob(ShardInfo const&, blob_id_t, trace_id_t tid) override;
     ///
 
@@ -74,6 +78,8 @@ class MemoryHomeObject : public HomeObjectImpl {
     _list_all_replace_member_tasks(trace_id_t trace_id) override;
 
     ShardIndex& _find_index(shard_id_t) const;
+    // Drops the shards of pg from the shard maps, with _pg_lock and _shard_lock held.
+    void remove_pg_shards(PG const& pg);
 
 public:
     MemoryHomeObject(std::weak_ptr< HomeObjectApplication >&& application);
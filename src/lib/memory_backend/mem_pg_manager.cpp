@@ -47,9 +47,8 @@ bool MemoryHomeObject::_get_stats(pg_id_t id, PGStats& stats) const {
     stats.id = pg->pg_info_.id;
     stats.replica_set_uuid = pg->pg_info_.replica_set_uuid;
     stats.num_members = pg->pg_info_.members.size();
-    stats.total_shards = pg->shards_.size();
-    stats.open_shards =
-        std::count_if(pg->shards_.begin(), pg->shards_.end(), [](auto const& s) { return s->is_open(); });
+    stats.total_shards = pg->num_shards_.load(std::memory_order_relaxed);
+    stats.open_shards = pg->num_open_shards_.load(std::memory_order_relaxed);
     for (auto const& m : pg->pg_info_.members) {
         stats.members.emplace_back(peer_info{.id = m.id, .name = m.name});
     }
@@ -66,29 +65,34 @@ void MemoryHomeObject::_get_pg_ids(std::vector< pg_id_t >& pg_ids) const {
 
 HomeObjectStats MemoryHomeObject::_get_stats() const {
     HomeObjectStats stats;
-    uint32_t num_open_shards = 0ul;
-    std::scoped_lock shared_lock(_pg_lock);
-    for (auto const& [_, pg] : _pg_map) {
-        auto mem_pg = pg.get();
-        num_open_shards +=
-            std::count_if(mem_pg->shards_.begin(), mem_pg->shards_.end(), [](auto const& s) { return s->is_open(); });
-    }
-
-    stats.num_open_shards = num_open_shards;
+    stats.num_open_shards = _num_open_shards.load(std::memory_order_relaxed);
     return stats;
 }
 
 void MemoryHomeObject::_destroy_pg(pg_id_t pg_id) {
-    auto lg = std::unique_lock(_pg_lock);
-    _pg_map.erase(pg_id);
+    auto lg = std::scoped_lock(_pg_lock, _shard_lock);
+    if (auto iter = _pg_map.find(pg_id); iter != _pg_map.end()) {
+        remove_pg_shards(*iter->second);
+        _pg_map.erase(iter);
+    }
+}
+
+void MemoryHomeObject::remove_pg_shards(PG const& pg) {
+    for (auto const& shard : pg.shards_) {
+        _unpublish_shard(*shard);
+        _shard_map.erase(shard->info.id);
+    }
 }
 
 PGManager::NullResult MemoryHomeObject::_exit_pg(uuid_t group_id, peer_id_t peer_id, trace_id_t trace_id) {
-    auto lg = std::unique_lock(_pg_lock);
+    auto lg = std::scoped_lock(_pg_lock, _shard_lock);
     auto iter = std::find_if(_pg_map.begin(), _pg_map.end(), [group_id](const auto& entry) {
         return entry.second->pg_info_.replica_set_uuid == group_id;
     });
-    if (iter != _pg_map.end()) { _pg_map.erase(iter); }
+    if (iter != _pg_map.end()) {
+        remove_pg_shards(*iter->second);
+        _pg_map.erase(iter);
+    }
     return folly::Unit();
 }
 
@@ -12,16 +12,20 @@ ShardManager::AsyncResult< ShardInfo > MemoryHomeObject::_create_shard(pg_id_t p
     auto const now = get_current_timestamp();
     auto info = ShardInfo(0ull, pg_owner, ShardInfo::State::OPEN, 0, now, now, size_bytes, size_bytes);
     {
-        auto lg = std::scoped_lock(_pg_lock, _shard_lock);
+        auto pg_lg = std::shared_lock(_pg_lock);
         auto pg_it = _pg_map.find(pg_owner);
         if (_pg_map.end() == pg_it) return folly::makeUnexpected(ShardError(ShardErrorCode::UNKNOWN_PG));
 
+        auto lg = std::scoped_lock(pg_it->second->mtx_);
         auto& s_list = pg_it->second->shards_;
         info.id = make_new_shard_id(pg_owner, s_list.size());
         auto iter = s_list.emplace(s_list.end(), std::make_unique< Shard >(info));
+        (*iter)->pg = pg_it->second.get();
         LOGDEBUG("Creating Shard [{}]: in pg={} of Size [{}b]", info.id & shard_mask, pg_owner, size_bytes);
+        auto shard_lg = std::scoped_lock(_shard_lock);
         auto [_, s_happened] = _shard_map.emplace(info.id, iter);
         RELEASE_ASSERT(s_happened, "Duplicate Shard insertion!");
+        _publish_shard(*iter);
     }
     auto [it, happened] = index_.try_emplace(info.id, std::make_unique< ShardIndex >());
     RELEASE_ASSERT(happened, "Could not create BTree!");
@@ -35,6 +39,7 @@ ShardManager::AsyncResult< ShardInfo > MemoryHomeObject::_seal_shard(ShardInfo c
     RELEASE_ASSERT(_shard_map.end() != shard_it, "Missing ShardIterator!");
     auto& shard_info = (*shard_it->second)->info;
     shard_info.state = ShardInfo::State::SEALED;
+    _publish_shard(*shard_it->second);
     return shard_info;
 }
 
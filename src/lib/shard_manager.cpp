@@ -19,6 +19,9 @@ ShardManager::AsyncResult< InfoList > HomeObjectImpl::list_shards(pg_id_t pgid,
         if (iter == _pg_map.cend()) { return folly::makeUnexpected(ShardError(ShardErrorCode::UNKNOWN_PG)); }
         auto& pg = iter->second;
 
+        std::shared_lock pg_lock_guard(pg->mtx_);
+        // the info of a shard is changed in place when it is sealed
+        std::shared_lock shard_lock_guard(_shard_lock);
         auto info_l = std::list< ShardInfo >();
         for (auto const& shard : pg->shards_) {
             LOGD("found [shard={}], trace_id=[{}]", shard->info.id, tid);
@@ -47,12 +50,12 @@ ShardManager::AsyncResult< ShardInfo > HomeObjectImpl::get_shard(shard_id_t id,
 // This is used as a first call for many operations and initializes the Future.
 //
 folly::Future< ShardManager::Result< ShardInfo > > HomeObjectImpl::_get_shard(shard_id_t id, trace_id_t tid) const {
-    return _defer().thenValue([this, id, tid](auto) -> ShardManager::Result< ShardInfo > {
-        auto lg = std::shared_lock(_shard_lock);
-        if (auto it = _shard_map.find(id); _shard_map.end() != it) return (*it->second)->info;
-        LOGE("Couldn't find shard id in shard map {}, trace_id=[{}]", id, tid);
-        return folly::makeUnexpected(ShardError(ShardErrorCode::UNKNOWN_SHARD));
-    });
+    if (auto it = _shard_snapshots.find(id); _shard_snapshots.cend() != it) {
+        return folly::makeFuture< ShardManager::Result< ShardInfo > >(it->second.info);
+    }
+    LOGE("Couldn't find shard id in shard map {}, trace_id=[{}]", id, tid);
+    return folly::makeFuture< ShardManager::Result< ShardInfo > >(
+        folly::makeUnexpected(ShardError(ShardErrorCode::UNKNOWN_SHARD)));
 }
 
 uint64_t HomeObjectImpl::get_current_timestamp() {
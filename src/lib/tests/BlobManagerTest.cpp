@@ -101,3 +101,95 @@ TEST_F(TestFixture, BasicBlobTests) {
     // Delete is Idempotent
     EXPECT_TRUE(homeobj_->blob_manager()->del(_shard_1.id, _blob_id, tid).get());
 }
+
+TEST_F(TestFixture, PutBatch) {
+    auto tid = homeobject::generateRandomTraceId();
+    // empty batch and empty blobs are rejected
+    auto e_e = homeobj_->blob_manager()->put_batch(_shard_1.id, std::vector< Blob >{}, tid).get();
+    ASSERT_FALSE(!!e_e);
+    EXPECT_EQ(BlobErrorCode::INVALID_ARG, e_e.error().getCode());
+
+    std::vector< Blob > bad_batch;
+    bad_batch.emplace_back(sisl::io_blob_safe(4 * Ki, 512u), "test_blob", 0ul);
+    bad_batch.emplace_back();
+    auto b_e = homeobj_->blob_manager()->put_batch(_shard_1.id, std::move(bad_batch), tid).get();
+    ASSERT_FALSE(!!b_e);
+    EXPECT_EQ(BlobErrorCode::INVALID_ARG, b_e.error().getCode());
+
+    auto const num_blobs = 8u;
+    std::vector< Blob > batch;
+    for (auto i = 0u; num_blobs > i; ++i) {
+        batch.emplace_back(sisl::io_blob_safe((i + 1) * Ki, 512u), fmt::format("test_blob_{}", i), i * Mi);
+    }
+    auto p_e = homeobj_->blob_manager()->put_batch(_shard_1.id, std::move(batch), tid).get();
+    ASSERT_TRUE(!!p_e);
+    auto const& blob_ids = p_e.value();
+    ASSERT_EQ(num_blobs, blob_ids.size());
+    for (auto i = 0u; num_blobs > i; ++i) {
+        if (i > 0) { EXPECT_EQ(blob_ids[i - 1] + 1, blob_ids[i]); }
+        auto g_e = homeobj_->blob_manager()->get(_shard_1.id, blob_ids[i]).get();
+        ASSERT_TRUE(!!g_e);
+        EXPECT_EQ((i + 1) * Ki, g_e.value().body.size());
+        EXPECT_EQ(fmt::format("test_blob_{}", i), g_e.value().user_key);
+        EXPECT_EQ(i * Mi, g_e.value().object_off);
+    }
+
+    // unknown and sealed shards
+    auto u_e = homeobj_->blob_manager()->put_batch(_shard_2.id + 1, std::vector< Blob >{}, tid).get();
+    ASSERT_FALSE(!!u_e);
+    EXPECT_EQ(BlobErrorCode::UNKNOWN_SHARD, u_e.error().getCode());
+
+    EXPECT_TRUE(homeobj_->shard_manager()->seal_shard(_shard_1.id).get());
+    std::vector< Blob > sealed_batch;
+    sealed_batch.emplace_back(sisl::io_blob_safe(4 * Ki, 512u), "test_blob", 0ul);
+    auto s_e = homeobj_->blob_manager()->put_batch(_shard_1.id, std::move(sealed_batch), tid).get();
+    ASSERT_FALSE(!!s_e);
+    EXPECT_EQ(BlobErrorCode::SEALED_SHARD, s_e.error().getCode());
+}
+
+TEST_F(TestFixture, GetBatch) {
+    auto tid = homeobject::generateRandomTraceId();
+    auto e_e = homeobj_->blob_manager()->get_batch(_shard_1.id, std::vector< blob_id_t >{}, tid).get();
+    ASSERT_FALSE(!!e_e);
+    EXPECT_EQ(BlobErrorCode::INVALID_ARG, e_e.error().getCode());
+
+    auto u_e = homeobj_->blob_manager()->get_batch(_shard_2.id + 1, {_blob_id}, tid).get();
+    ASSERT_FALSE(!!u_e);
+    EXPECT_EQ(BlobErrorCode::UNKNOWN_SHARD, u_e.error().getCode());
+
+    // results follow the requested order, an unknown blob fails on its own
+    auto g_e = homeobj_->blob_manager()->get_batch(_shard_1.id, {_blob_id + 1, _blob_id, _blob_id}, tid).get();
+    ASSERT_TRUE(!!g_e);
+    auto const& results = g_e.value();
+    ASSERT_EQ(3u, results.size());
+    ASSERT_FALSE(!!results[0]);
+    EXPECT_EQ(BlobErrorCode::UNKNOWN_BLOB, results[0].error().getCode());
+    for (auto i = 1u; 3u > i; ++i) {
+        ASSERT_TRUE(!!results[i]);
+        EXPECT_EQ(4 * Ki, results[i].value().body.size());
+        EXPECT_STREQ("test_blob", results[i].value().user_key.c_str());
+        EXPECT_EQ(4 * Mi, results[i].value().object_off);
+    }
+}
+
+TEST_F(TestFixture, PutFragments) {
+    auto tid = homeobject::generateRandomTraceId();
+    sisl::io_blob_safe buf(3 * Ki);
+    for (auto i = 0u; buf.size() > i; ++i) {
+        buf.bytes()[i] = static_cast< uint8_t >(i);
+    }
+
+    Blob blob(sisl::io_blob_safe(), "test_blob", 0ul);
+    blob.body_sgs.iovs.push_back(iovec{.iov_base = buf.bytes() + 1, .iov_len = Ki});
+    blob.body_sgs.iovs.push_back(iovec{.iov_base = buf.bytes() + 2 * Ki, .iov_len = Ki - 1});
+    blob.body_sgs.size = 2 * Ki - 1;
+    EXPECT_EQ(2 * Ki - 1, blob.payload_size());
+    auto p_e = homeobj_->blob_manager()->put(_shard_1.id, std::move(blob), tid).get();
+    ASSERT_TRUE(!!p_e);
+
+    auto g_e = homeobj_->blob_manager()->get(_shard_1.id, p_e.value()).get();
+    ASSERT_TRUE(!!g_e);
+    ASSERT_EQ(2 * Ki - 1, g_e.value().body.size());
+    EXPECT_EQ(0, std::memcmp(g_e.value().body.cbytes(), buf.cbytes() + 1, Ki));
+    EXPECT_EQ(0, std::memcmp(g_e.value().body.cbytes() + Ki, buf.cbytes() + 2 * Ki, Ki - 1));
+}
@@ -1,3 +1,8 @@
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
 #include <homeobject/shard_manager.hpp>
 #include "lib/tests/fixture_app.hpp"
 
@@ -72,3 +77,114 @@ TEST_F(TestFixture, SealShard) {
         });
     }
 }
+
+TEST_F(TestFixture, GetShardWhileCreatingAndSealing) {
+    // lookups run on the calling threads while shards are created and sealed
+    std::atomic< bool > done{false};
+    std::vector< std::thread > readers;
+    for (auto i = 0; 4 > i; ++i) {
+        readers.emplace_back([this, &done]() {
+            while (!done.load()) {
+                auto e = homeobj_->shard_manager()->get_shard(_shard_2.id).get();
+                ASSERT_TRUE(!!e);
+                EXPECT_EQ(e.value().id, _shard_2.id);
+                EXPECT_EQ(e.value().placement_group, _shard_2.placement_group);
+            }
+        });
+    }
+
+    std::vector< ShardInfo > shards;
+    for (auto i = 0; 16 > i; ++i) {
+        auto e = homeobj_->shard_manager()->create_shard(_pg_id, Mi, "shard meta").get();
+        ASSERT_TRUE(!!e);
+        shards.push_back(e.value());
+    }
+    for (auto const& shard : shards) {
+        ASSERT_TRUE(!!homeobj_->shard_manager()->seal_shard(shard.id).get());
+    }
+    ASSERT_TRUE(!!homeobj_->shard_manager()->seal_shard(_shard_2.id).get());
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    for (auto const& shard : shards) {
+        auto e = homeobj_->shard_manager()->get_shard(shard.id).get();
+        ASSERT_TRUE(!!e);
+        EXPECT_EQ(e.value().state, ShardInfo::State::SEALED);
+    }
+    auto e = homeobj_->shard_manager()->get_shard(_shard_2.id).get();
+    ASSERT_TRUE(!!e);
+    EXPECT_EQ(e.value().state, ShardInfo::State::SEALED);
+}
+
+TEST_F(TestFixture, CreateShardsOnManyPGsConcurrently) {
+    // each pg creates its shards on its own thread while the stats and shards of all the pgs are read
+    auto const num_pgs = 16;
+    uint64_t const num_shards = 64;
+    std::vector< homeobject::pg_id_t > pgs;
+    for (auto i = 1; num_pgs >= i; ++i) {
+        auto info = homeobject::PGInfo(_pg_id + i);
+        info.members.insert(homeobject::PGMember{_peer1, "peer1", 1});
+        ASSERT_TRUE(homeobj_->pg_manager()->create_pg(std::move(info)).get());
+        pgs.push_back(_pg_id + i);
+    }
+
+    std::atomic< bool > done{false};
+    auto reader = std::thread([this, &pgs, &done]() {
+        while (!done.load()) {
+            homeobj_->get_stats();
+            for (auto const pg : pgs) {
+                ASSERT_TRUE(!!homeobj_->shard_manager()->list_shards(pg).get());
+            }
+        }
+    });
+
+    std::vector< std::thread > writers;
+    for (auto const pg : pgs) {
+        writers.emplace_back([this, pg]() {
+            for (uint64_t i = 0; num_shards > i; ++i) {
+                ASSERT_TRUE(!!homeobj_->shard_manager()->create_shard(pg, Mi, "shard meta").get());
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done = true;
+    reader.join();
+
+    std::set< shard_id_t > shard_ids;
+    for (auto const pg : pgs) {
+        auto e = homeobj_->shard_manager()->list_shards(pg).get();
+        ASSERT_TRUE(!!e);
+        ASSERT_EQ(e.value().size(), num_shards);
+        for (auto const& info : e.value()) {
+            EXPECT_EQ(info.placement_group, pg);
+            EXPECT_TRUE(shard_ids.insert(info.id).second);
+        }
+        homeobject::PGStats stats;
+        ASSERT_TRUE(homeobj_->pg_manager()->get_stats(pg, stats));
+        EXPECT_EQ(stats.total_shards, num_shards);
+        EXPECT_EQ(stats.open_shards, num_shards);
+    }
+}
+
+TEST_F(TestFixture, ShardCountsInStats) {
+    homeobject::PGStats stats;
+    ASSERT_TRUE(homeobj_->pg_manager()->get_stats(_pg_id, stats));
+    EXPECT_EQ(stats.total_shards, 2);
+    EXPECT_EQ(stats.open_shards, 2);
+    EXPECT_EQ(homeobj_->get_stats().num_open_shards, 2);
+
+    ASSERT_TRUE(!!homeobj_->shard_manager()->seal_shard(_shard_1.id).get());
+    // sealing a sealed shard changes nothing
+    ASSERT_TRUE(!!homeobj_->shard_manager()->seal_shard(_shard_1.id).get());
+    ASSERT_TRUE(homeobj_->pg_manager()->get_stats(_pg_id, stats));
+    EXPECT_EQ(stats.total_shards, 2);
+    EXPECT_EQ(stats.open_shards, 1);
+    EXPECT_EQ(homeobj_->get_stats().num_open_shards, 1);
+
+    homeobj_->pg_manager()->destroy_pg(_pg_id);
+    EXPECT_EQ(homeobj_->get_stats().num_open_shards, 0);
+}